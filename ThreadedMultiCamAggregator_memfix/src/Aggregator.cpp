@@ -7,197 +7,293 @@
 //
 
 #include "Aggregator.hpp"
-
-using namespace ofxCv;
+#include "Profiler.hpp"
 
 Aggregator::Aggregator(){
-    
+
+}
+
+Aggregator::~Aggregator(){
+
     closeAllChannels();
-    
+
     waitForThread(true, 4000);
-    
+
 }
 
 void Aggregator::closeAllChannels(){
-    
-    settingsIn.close();
-    rawPixIn.close();
-    threshPixOut.close();
-    contoursOut.close();
-    
+
+    frameIn.close();
+    resultOut.close();
+
 }
 
 
 void Aggregator::emptyAllChannels(){
-    
-    //close thread channels
-    settingsIn.empty();
-    rawPixIn.empty();
-    threshPixOut.empty();
-    contoursOut.empty();
-    
+
+    //throw away anything still waiting in the channels
+    Frame f;
+    while( frameIn.tryReceive(f) ){}
+
+    shared_ptr<const Result> r;
+    while( resultOut.tryReceive(r) ){}
+
 }
 
-void Aggregator::setup(int singleW, int singleH){
+void Aggregator::setup(int singleW, int singleH, shared_ptr<OscSender> oscSender, shared_ptr<PreviewStreamer> previewStreamer){
 
-    camWidth = singleW;
-    camHeight = singleH;
-    
     frameNum = 0;
-    
+
     camFrameRate = 0;
+    lastFrameRate = 0;
     lastFrameTime = 0;
-    
-    needsAutoReset = true;
+
     isThreadCrashed = false;
+    bWaitingForResult = false;
     firstAfterCrash = true;
-    
+
     firstRestart = true;
-    
+
     lastRestartTime = 0;
-    
-    processedPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    threshPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    backgroundPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    foregroundPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    
+
+    //start with an empty black snapshot so there's
+    //always something to draw
+    shared_ptr<Result> blank = make_shared<Result>();
+    blank -> frameNum = 0;
+    blank -> generation = nextImageGeneration();
+    blank -> activeZone = -1;
+    blank -> predictedZone = -1;
+    blank -> captureLatency = 0;
+    blank -> processingTime = 0;
+    blank -> backgroundMemory = 0;
+    blank -> masterPix.allocate(singleW, singleH, OF_IMAGE_GRAYSCALE);
+    blank -> masterPix.setColor(0);
+    blank -> processedPix = blank -> masterPix;
+    blank -> threshPix = blank -> masterPix;
+    blank -> backgroundPix = blank -> masterPix;
+    blank -> foregroundPix = blank -> masterPix;
+
+    result = blank;
+    bFrameNew = false;
+
+    bResetGraph = false;
+
+    //detection messages and preview frames are handed to their
+    //own threads from here
+    graph.setup(oscSender, previewStreamer);
+
     startThread();
-    
+
     //Pretend we just got a frame so the thread doesn't stop
     //thinking it crashed since ofGetElapsedTimeMillis starts
     //long before the window opens (assets take a long time to load)
     lastFrameTime = ofGetElapsedTimeMillis();
-    
+
 }
 
 
 
 void Aggregator::update(){
-    
-    //attempt to receive data from thread
-//    ofPixels p;
-//    if(rawPixOut.tryReceive(p)){
-//        rawPix = p;
-//    }
-//    
-//    ofPixels t;
-//    if(threshPixOut.tryReceive(t)){
-//        threshPix = t;
-//        
-//        float thisFrameRate = 1.0/( (ofGetElapsedTimeMillis() - lastFrameTime) / 1000.0 );
-//        
-//        //average this framerate with the last one to smooth out numbers
-//        //and get a better reading.
-//        camFrameRate = (thisFrameRate + lastFrameRate)/2;
-//        lastFrameRate = thisFrameRate;
-//        
-//        //
-//        lastFrameTime = ofGetElapsedTimeMillis();
-//        
-//    }
-//    
-//    ofxCv::ContourFinder c;
-//    if(contoursOut.tryReceive(c)){
-//        contours = c;
-//        
-//        bNewContours = true;
-//    }
-//    
-//    ofPixels fg;
-//    if(foregroundPixOut.tryReceive(fg)){
-//        foregroundPix = fg;
-//    }
-    
-    
-    
-    
+
+    bFrameNew = false;
+    newConsoleLines.clear();
+
+    //attempt to receive data from thread. Keep
+    //only the newest snapshot but all the log lines
+    shared_ptr<const Result> r;
+    while( resultOut.tryReceive(r) ){
+
+        result = r;
+        bFrameNew = true;
+        bWaitingForResult = false;
+
+        if( !r -> consoleLine.empty() ){
+            newConsoleLines.push_back(r -> consoleLine);
+        }
+
+    }
+
+    if( bFrameNew ){
+
+        float thisFrameRate = 1.0/( (ofGetElapsedTimeMillis() - lastFrameTime) / 1000.0 );
+
+        //average this framerate with the last one to smooth out numbers
+        //and get a better reading.
+        camFrameRate = (thisFrameRate + lastFrameRate)/2;
+        lastFrameRate = thisFrameRate;
+
+        lastFrameTime = ofGetElapsedTimeMillis();
+
+    }
+
+
+
+
     //---------------------------------------------------------------
     //---------------THREAD MANAGEMENT AND RESTARTING----------------
     //---------------------------------------------------------------
-    
-    if(ofGetElapsedTimeMillis() - lastFrameTime > 6000){
+
+    //only a crash if we're waiting on a frame. No cameras
+    //means no frames sent in, which is not the thread's fault
+    if( bWaitingForResult && ofGetElapsedTimeMillis() - lastFrameTime > 6000 ){
         isThreadCrashed = true;
-        
+
         if(firstAfterCrash){
             cout << "Stopping Aggregator Thread" << endl;
-            stopThread();
+            waitForThread(true, 4000);
             emptyAllChannels();
-            background.reset();
+            bResetGraph = true;
             firstAfterCrash = false;
         }
-        
+
     } else {
         isThreadCrashed = false;
         firstAfterCrash = true;
     }
-    
-    
+
+
     //only try to restart the thread every 4 seconds
     if(isThreadCrashed && ofGetElapsedTimeMillis() - lastRestartTime > 4000){
-        
+
         cout << "Attempting to start Aggregator thread..." << endl;
         startThread();
-        
+
         lastRestartTime = ofGetElapsedTimeMillis();
         firstRestart = true;
-        
+
     }
-    
+
     //if it has been 2 seconds since last restart AND we're still crashed
     //then stop and prepare for the next restart
     //make sure to wait longer since we have waitForThread(4000)
     if(isThreadCrashed && ofGetElapsedTimeMillis() - lastRestartTime > 3000 && firstRestart){
-        
+
         cout << "Stopping Aggregator Thread" << endl;
-        stopThread();
-        
+        waitForThread(true, 4000);
+
         emptyAllChannels();
-        closeAllChannels();
-        
-        background.reset();
-        
+
+        bResetGraph = true;
+
         firstRestart = false;
-        
+
     }
-    
-    
+
+
+}
+
+
+void Aggregator::analyze(Frame & frame){
+
+    //restart the crash timer when we start waiting
+    if( !bWaitingForResult ){
+        lastFrameTime = ofGetElapsedTimeMillis();
+        bWaitingForResult = true;
+    }
+
+    frameIn.send(std::move(frame));
+
 }
-    
-        
-void Aggregator::analyze(ofPixels *pix, vector<int> settings){
-    
-    //send settings into thread
-    rawPixIn.send( (*pix) );
-    
-    //send in gui settings (pre-packaged from ofApp)
-    settingsIn.send(settings);
-    
+
+shared_ptr<const Aggregator::Result> Aggregator::getResult() const{
+    return result;
 }
 
+bool Aggregator::isFrameNew() const{
+    return bFrameNew;
+}
 
 
-void Aggregator::threadedFunction(){
-    
-    while(isThreadRunning()){
-        
-        vector<int> settings_thread;
-        ofPixels rawPix_thread;
-        
-        if(rawPixIn.receive(rawPix_thread) && settingsIn.receive(settings_thread)){
-        
-        
-            
-            
-            
-            
-        
-        
-        
+
+void Aggregator::fitMask(Frame & frame){
+
+    if( !frame.mask ) return;
+
+    int w = frame.layout.masterWidth;
+    int h = frame.layout.masterHeight;
+
+    if( frame.mask -> getWidth() == w && frame.mask -> getHeight() == h ) return;
+
+    //the mask shared with the app is never changed, resize a copy
+    if( frame.mask != maskSource || fittedMask -> getWidth() != w || fittedMask -> getHeight() != h ){
+
+        shared_ptr<BinaryMask> m = make_shared<BinaryMask>(*frame.mask);
+        m -> resize(w, h);
+
+        maskSource = frame.mask;
+        fittedMask = m;
+    }
+
+    frame.mask = fittedMask;
+
+}
+
+void Aggregator::process(Frame & frame, Result & r){
+
+    uint64_t startTime = ofGetElapsedTimeMicros();
+
+    r.frameNum = frameNum++;
+    r.generation = nextImageGeneration();
+    r.backgroundMemory = 0;
+
+    fitMask(frame);
+
+    //rebuild the graph if the stage list changed
+    if( !frame.settings.stageOrder.empty() && frame.settings.stageOrder != graph.getOrder() ){
+        graph.build(frame.settings.stageOrder);
+    }
+
+    graph.process(frame, r);
+
+    //switched off stages leave their outputs empty,
+    //give the drawing code black frames instead
+    ofPixels *outputs[] = { &r.masterPix, &r.processedPix, &r.threshPix, &r.backgroundPix, &r.foregroundPix };
+
+    for(int i = 0; i < 5; i++){
+        if( !outputs[i] -> isAllocated() ){
+            outputs[i] -> allocate(frame.layout.masterWidth, frame.layout.masterHeight, OF_IMAGE_GRAYSCALE);
+            outputs[i] -> setColor(ofColor(0));
         }
-        
     }
-    
+
+    uint64_t elapsed = ofGetElapsedTimeMicros() - startTime;
+
+    PROFILE_RECORD(Profiler::PIPELINE, elapsed);
+
+    r.processingTime = elapsed/1000.0f;
+
 }
 
 
 
+void Aggregator::threadedFunction(){
+
+    while(isThreadRunning()){
+
+        //the graph is only ever touched from here, even if
+        //the old thread never actually exited
+        if( bResetGraph.exchange(false) ){
+            graph.reset();
+        }
+
+        Frame frame;
+
+        //time out every now and then so stopThread() can actually stop us
+        if( frameIn.tryReceive(frame, 100) ){
+
+            //if we've fallen behind, skip straight to the newest frame
+            Frame newer;
+            while( frameIn.tryReceive(newer) ){
+                frame = std::move(newer);
+            }
+
+            shared_ptr<Result> r = make_shared<Result>();
+            process(frame, *r);
+
+            resultOut.send( shared_ptr<const Result>(r) );
+
+        }
+
+    }
+
+}
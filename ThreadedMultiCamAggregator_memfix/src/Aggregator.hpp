@@ -15,70 +15,119 @@
 
 #include "ofMain.h"
 #include "ofxCv.h"
+#include "ofxOsc.h"
+#include "PipelineData.hpp"
+#include "StageGraph.hpp"
+#include "OscSender.hpp"
+#include "PreviewStreamer.hpp"
 
 #pragma once
 
 
+/*
+ * Aggregator:
+ *  Owns the whole detection pipeline on its own thread.
+ *
+ *  INPUT:
+ *      -Processed camera tiles (output of each Feed)
+ *      -Stitching layout, mask, zones and gui settings. A mask
+ *       from before a layout change is cropped/padded to the
+ *       new composite here, not on the GL thread
+ *
+ *  THREAD:
+ *      -runs the StageGraph: composite, mask, background/threshold,
+ *       erode, dilate, blob labeling, tracking, prediction, contours
+ *       (drawing only), zone test, zone occupancy and the OSC
+ *       messages by default, in the order given by
+ *       settings.stageOrder
+ *
+ *  OUTPUT:
+ *      -Immutable Result snapshot the GL thread only draws
+ *      -OSC batches handed to the OscSender, never sent from here
+ *      -preview frames handed to the PreviewStreamer, same deal
+ */
+
 class Aggregator: public ofThread{
-    
+
 public:
-    
+
     Aggregator();
-    void setup(int singleW, int singleH);
+    ~Aggregator();
+
+    void setup(int singleW, int singleH, shared_ptr<OscSender> oscSender, shared_ptr<PreviewStreamer> previewStreamer);
     void update();
-    void analyze(ofPixels *pix, vector<int> settings);
-    
-    int camWidth;
-    int camHeight;
-    
-    unsigned long long lastFrameTime;
-    float lastFrameRate; //for smoothing
+
+    //pipeline data lives in PipelineData.hpp so the
+    //stages can share it without including the Aggregator
+    typedef PipelineSettings Settings;
+    typedef PipelineLayout Layout;
+    typedef PipelineFrame Frame;
+    typedef PipelineResult Result;
+
+    void analyze(Frame & frame);
+
+    //latest finished snapshot. Never null after setup()
+    shared_ptr<const Result> getResult() const;
+
+    //new snapshot since the last update()?
+    bool isFrameNew() const;
+
+    //console lines from every result received in the last update()
+    vector<string> newConsoleLines;
+
     float camFrameRate;
-    
-    //pointers to pixel objects in ofApp
-    //we will update them when we get
-    //new data from thread
-    ofPixels processedPix;
-    ofPixels threshPix;
-    ofPixels backgroundPix;
-    ofPixels foregroundPix;
-    
+
+
 private:
-    
-    
-    unsigned long long frameNum;
-    
+
+    unsigned long long lastFrameTime;
+    float lastFrameRate; //for smoothing
+
+    shared_ptr<const Result> result;
+    bool bFrameNew;
+
     //thread management
     void closeAllChannels();
     void emptyAllChannels();
     bool isThreadCrashed;
-    
+    bool bWaitingForResult;
+
+    //set by the watchdog, the thread resets the
+    //graph itself before its next frame
+    std::atomic<bool> bResetGraph;
+
     //into thread
-    ofThreadChannel<vector<int>> settingsIn;
-    ofThreadChannel<ofPixels> rawPixIn;
-    
+    ofThreadChannel<Frame> frameIn;
+
     //Thread output
-    ofThreadChannel<ofPixels> threshPixOut;
-    ofThreadChannel<ofPixels> backgroundPixOut;
-    ofThreadChannel<ofPixels> foregroundPixOut;
-    ofThreadChannel<ofxCv::ContourFinder> contoursOut;
-    
-    //this member exists outside of the thread
-    //so contours maintain their permanence (IDs)
-    //but DO NOT use this anywhere outside of thread
-    ofxCv::ContourFinder contours_thread;
-    ofxCv::RunningBackground background;
-    
-    //for restarting the background learning
-    bool needsAutoReset;
-    
+    ofThreadChannel< shared_ptr<const Result> > resultOut;
+
+
+    //--------------------------------------
+    //Everything below is --ONLY-- touched from
+    //within the thread (or while it is stopped)
+    //--------------------------------------
+
+    void process(Frame & frame, Result & r);
+
+    //frame.mask cropped/padded to the composite, made again
+    //only when the mask or the composite size changes
+    void fitMask(Frame & frame);
+    shared_ptr<const BinaryMask> maskSource;
+    shared_ptr<const BinaryMask> fittedMask;
+
+    unsigned long long frameNum;
+
+    //stages keep state across frames (background,
+    //contour IDs) but DO NOT touch outside of thread
+    StageGraph graph;
+
     //for restarting the thread
     unsigned long long lastRestartTime;
     bool firstAfterCrash;
     bool firstRestart;
-    
-    
+
+
     void threadedFunction();
-    
-};
 
+};
@@ -0,0 +1,262 @@
+//
+//  AppSettings.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "AppSettings.hpp"
+
+
+const int AppSettings::NUM_ZONES = 3;
+const int AppSettings::NUM_ZONE_POINTS = 4;
+
+//ofxPanel saves every control under its name with
+//these characters swapped for '_'
+static string getXmlName(string name){
+
+    const string swapped = " <>{}[],()/\\.";
+
+    for(int i = 0; i < name.size(); i++){
+        if( swapped.find(name[i]) != string::npos ) name[i] = '_';
+    }
+
+    return name;
+
+}
+
+void AppSettings::setup(int camWidth, int camHeight){
+
+    //----------settings----------
+    settingsGroup.setName("settings");
+
+    settingsGroup.add( blurAmt.set("Blur", 1, 0, 40) );
+    settingsGroup.add( contrastExp.set("Contrast Exponent", 1.0, 1.0, 12.0) );
+    settingsGroup.add( contrastPhase.set("Contrast Phase", 0.0, 0.0, 0.8) );
+    settingsGroup.add( threshold.set("Threshold", 0, 0, 255) );
+    settingsGroup.add( numErosions.set("Number of erosions", 0, 0, 10) );
+    settingsGroup.add( numDilations.set("Number of dilations", 0, 0, 10) );
+
+    settingsGroup.add( useBgDiff.set("Use BG Diff", false) );
+    settingsGroup.add( useMultiModalBg.set("Multi-modal BG", false) );
+    settingsGroup.add( usePerCameraBg.set("Per-camera BG", true) );
+    settingsGroup.add( learningTime.set("Frames to learn BG", 100, 0, 80) );
+    settingsGroup.add( selectiveLearning.set("Selective learning", true) );
+    settingsGroup.add( bgSaveInterval.set("BG save interval (s)", 60.0f, 0.0f, 600.0f) );
+
+    settingsGroup.add( useParallelBands.set("Use Parallel Bands", false) );
+    settingsGroup.add( numBands.set("Number of bands", 4, 1, 8) );
+
+    settingsGroup.add( minBlobArea.set("Min Blob Area", 0, 0, 1000) );
+    settingsGroup.add( maxBlobArea.set("Max Blob Area", 1000, 0, 20000) );
+    settingsGroup.add( persistence.set("Track persistence (frames)", 15, 0, 120) );
+    settingsGroup.add( maxDistance.set("Track max distance", 64, 1, 400) );
+
+    settingsGroup.add( sendOSC.set("Send OSC Data", false) );
+    settingsGroup.add( waitBeforeOSC.set("Wait after startup", 7.0, 5.0, 30) );
+    settingsGroup.add( sysNotOKTime.set("Time for NOT OK Flag", 4.0, 1.0, 20) );
+    settingsGroup.add( maxOSCSendRate.set("Zones interval (s)", 0.5f, 0.0f, 2.0f) );
+    settingsGroup.add( statusSendRate.set("Status interval (s)", 0.5f, 0.0f, 2.0f) );
+    settingsGroup.add( usePrediction.set("Predict positions", false) );
+    settingsGroup.add( predictionHorizon.set("Prediction horizon (ms)", 0, 0, 500) );
+    settingsGroup.add( deltaOSC.set("Change-only OSC", false) );
+    settingsGroup.add( heartbeatInterval.set("Heartbeat interval (s)", 1.0f, 0.1f, 10.0f) );
+    settingsGroup.add( updateDistance.set("Update distance (px)", 5.0f, 0.0f, 50.0f) );
+    settingsGroup.add( occupancyStep.set("Occupancy step", 0.05f, 0.01f, 0.5f) );
+    settingsGroup.add( useTimeTags.set("OSC time tags", false) );
+    settingsGroup.add( sendBlobs.set("Per-blob OSC", false) );
+    settingsGroup.add( publishShared.set("Publish shared memory", false) );
+    settingsGroup.add( streamPreview.set("Stream preview", false) );
+    settingsGroup.add( previewScale.set("Preview scale (1/x)", 4, 1, 8) );
+    settingsGroup.add( previewFps.set("Preview max fps", 5.0f, 0.5f, 30.0f) );
+    settingsGroup.add( previewBudget.set("Preview CPU budget pct", 5.0f, 1.0f, 50.0f) );
+    settingsGroup.add( floorScale.set("Floor scale (cm/px)", 1.0f, 0.1f, 10.0f) );
+
+
+    //----------maskingGui----------
+    maskGroup.setName("maskingGui");
+
+    maskGroup.add( useMask.set("Use Mask", true) );
+
+
+    //----------pixelStatsGui----------
+    pixelStatsGroup.setName("pixelStatsGui");
+
+    pixelStatsGroup.add( stdDevToggle.set("Use Std Dev Blackout", false) );
+    pixelStatsGroup.add( avgPixThresh.set("Avg Pixel Thresh", 100, 0, 255) );
+
+    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+        pixelStatsGroup.add( stdDevThresh[i].set("Cam " + ofToString(i) + " Thresh", 300, 0, 1000) );
+    }
+
+
+    //----------stitchingGui----------
+    stitchingGroup.setName("stitchingGui");
+
+    ofVec2f start(0, 0);
+    ofVec2f end(camWidth*3, camHeight * 1.5);
+
+    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+        stitchingGroup.add( camPositions[i].set("Cam " + ofToString(i) + " Position", ofVec2f(0, 0), start, end) );
+        stitchingGroup.add( camRotations[i].set("Cam " + ofToString(i) + " Rotation", 0, 0, 3) );
+        stitchingGroup.add( camMirrors[i].set("Cam " + ofToString(i) + " Mirror", false) );
+    }
+
+
+    //----------controlPoints----------
+    zoneGroup.setName("controlPoints");
+
+    //much bigger than the composite to leave room
+    //for different stitching layouts
+    end.set(camWidth*4, camHeight*4);
+
+    const string zoneNames[] = { "Danger Z.", "Active Z-1", "Active Z-2" };
+
+    zonePoints.resize(NUM_ZONES);
+
+    for(int i = 0; i < NUM_ZONES; i++){
+
+        zonePoints[i].resize(NUM_ZONE_POINTS);
+
+        for(int j = 0; j < NUM_ZONE_POINTS; j++){
+            zoneGroup.add( zonePoints[i][j].set(zoneNames[i] + " Pt " + ofToString(j), start, start, end) );
+        }
+    }
+
+}
+
+void AppSettings::loadFromFiles(){
+
+    loadGroup(settingsGroup);
+    loadGroup(maskGroup);
+    loadGroup(pixelStatsGroup);
+    loadGroup(stitchingGroup);
+    loadGroup(zoneGroup);
+
+}
+
+void AppSettings::loadGroup(ofParameterGroup & group){
+
+    string fileName = group.getName() + ".xml";
+
+    ofXml xml;
+
+    if( !xml.load(fileName) ){
+        cout << "[AppSettings] " << fileName << " not found, using defaults" << endl;
+        return;
+    }
+
+    //same text the panel wrote, vec2s are "x, y"
+    for(int i = 0; i < group.size(); i++){
+
+        ofAbstractParameter &p = group.get(i);
+        string name = getXmlName( p.getName() );
+
+        if( xml.exists(name) ){
+            p.fromString( xml.getValue(name) );
+        }
+    }
+
+}
+
+Feed::Settings AppSettings::getFeedSettings(int cam) const{
+
+    Feed::Settings s;
+
+    s.blurAmt = blurAmt;
+    s.contrastExp = contrastExp;
+    s.contrastPhase = contrastPhase;
+    s.stdDevThresh = stdDevThresh[cam];
+    s.avgPixThresh = avgPixThresh;
+    s.stdDevToggle = stdDevToggle;
+    s.useBgDiff = useBgDiff;
+    s.usePerCameraBg = usePerCameraBg;
+    s.threshold = threshold;
+    s.learningTime = learningTime;
+    s.selectiveLearning = selectiveLearning;
+    s.useMultiModalBg = useMultiModalBg;
+    s.resetBackground = false;
+
+    return s;
+
+}
+
+Aggregator::Settings AppSettings::getPipelineSettings() const{
+
+    Aggregator::Settings s;
+
+    s.useMask = useMask;
+    s.threshold = threshold;
+    s.useBgDiff = useBgDiff;
+    s.learningTime = learningTime;
+    s.selectiveLearning = selectiveLearning;
+    s.useMultiModalBg = useMultiModalBg;
+    s.usePerCameraBg = usePerCameraBg;
+    s.resetBackground = false;
+    s.bgSaveInterval = bgSaveInterval;
+    s.numErosions = numErosions;
+    s.numDilations = numDilations;
+    s.useParallelBands = useParallelBands;
+    s.numBands = numBands;
+    s.minBlobArea = minBlobArea;
+    s.maxBlobArea = maxBlobArea;
+    s.persistence = persistence;
+    s.maxDistance = maxDistance;
+    s.traceContours = false;
+    s.sendOSC = sendOSC;
+    s.waitBeforeOSC = waitBeforeOSC;
+    s.maxOSCSendRate = maxOSCSendRate;
+    s.usePrediction = usePrediction;
+    s.predictionHorizon = predictionHorizon / 1000.0f;
+    s.deltaOSC = deltaOSC;
+    s.heartbeatInterval = heartbeatInterval;
+    s.updateDistance = updateDistance;
+    s.occupancyStep = occupancyStep;
+    s.useTimeTags = useTimeTags;
+    s.sendBlobs = sendBlobs;
+    s.floorScale = floorScale;
+    s.publishShared = publishShared;
+    s.streamPreview = streamPreview;
+    s.previewScale = previewScale;
+    s.previewFps = previewFps;
+    s.previewBudget = previewBudget / 100.0f;
+
+    return s;
+
+}
+
+vector<ofVec2f> AppSettings::getCamPositions() const{
+
+    vector<ofVec2f> positions;
+
+    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+        positions.push_back( camPositions[i] );
+    }
+
+    return positions;
+
+}
+
+vector<int> AppSettings::getCamRotations() const{
+
+    vector<int> rotations;
+
+    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+        rotations.push_back( camRotations[i] );
+    }
+
+    return rotations;
+
+}
+
+vector< vector<ofVec2f> > AppSettings::getZonePoints() const{
+
+    vector< vector<ofVec2f> > points( zonePoints.size() );
+
+    for(int i = 0; i < zonePoints.size(); i++){
+        for(int j = 0; j < zonePoints[i].size(); j++){
+            points[i].push_back( zonePoints[i][j] );
+        }
+    }
+
+    return points;
+
+}
@@ -0,0 +1,131 @@
+//
+//  AppSettings.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef AppSettings_hpp
+#define AppSettings_hpp
+
+#include <stdio.h>
+
+#endif /* AppSettings_hpp */
+
+#include "ofMain.h"
+#include "Feed.hpp"
+#include "Aggregator.hpp"
+
+#pragma once
+
+
+/*
+ * AppSettings:
+ *  Every setting the pipeline runs on, with the names,
+ *  defaults and ranges ofApp's panels show. The one place
+ *  both runtimes take them from:
+ *
+ *      -ofApp sets its sliders up on these parameters, so
+ *       moving a slider changes them and its panels save
+ *       them under the same names as always
+ *      -HeadlessApp has no panels and calls loadFromFiles()
+ *       to read what they saved
+ *
+ *  getFeedSettings()/getPipelineSettings() turn them into
+ *  what Feed and the Aggregator take. Buttons and whatever
+ *  depends on the current view (resetBackground,
+ *  traceContours, stageOrder) are left to the app.
+ */
+
+class AppSettings{
+
+public:
+
+    static const int NUM_ZONES;
+    static const int NUM_ZONE_POINTS;
+
+    void setup(int camWidth, int camHeight);
+
+    //the xml files ofApp's panels save, for when there's no
+    //gui. Anything missing keeps its default
+    void loadFromFiles();
+
+    Feed::Settings getFeedSettings(int cam) const;
+    Aggregator::Settings getPipelineSettings() const;
+
+    vector<ofVec2f> getCamPositions() const;
+    vector<int> getCamRotations() const;
+    vector< vector<ofVec2f> > getZonePoints() const;
+
+
+    //-----settings.xml-----
+    ofParameter<int> blurAmt;
+    ofParameter<float> contrastExp;
+    ofParameter<float> contrastPhase;
+    ofParameter<int> threshold;
+    ofParameter<int> numErosions;
+    ofParameter<int> numDilations;
+
+    ofParameter<bool> useBgDiff;
+    ofParameter<bool> useMultiModalBg;
+    ofParameter<bool> usePerCameraBg;
+    ofParameter<int> learningTime;
+    ofParameter<bool> selectiveLearning;
+    ofParameter<float> bgSaveInterval;
+
+    ofParameter<bool> useParallelBands;
+    ofParameter<int> numBands;
+
+    ofParameter<int> minBlobArea;
+    ofParameter<int> maxBlobArea;
+    ofParameter<int> persistence;
+    ofParameter<int> maxDistance;
+
+    ofParameter<bool> sendOSC;
+    ofParameter<float> waitBeforeOSC;
+    ofParameter<float> sysNotOKTime;
+    ofParameter<float> maxOSCSendRate;
+    ofParameter<float> statusSendRate;
+    ofParameter<bool> usePrediction;
+    ofParameter<float> predictionHorizon;   //ms
+    ofParameter<bool> deltaOSC;
+    ofParameter<float> heartbeatInterval;
+    ofParameter<float> updateDistance;
+    ofParameter<float> occupancyStep;
+    ofParameter<bool> useTimeTags;
+    ofParameter<bool> sendBlobs;
+    ofParameter<bool> publishShared;
+    ofParameter<bool> streamPreview;
+    ofParameter<int> previewScale;
+    ofParameter<float> previewFps;
+    ofParameter<float> previewBudget;       //% of one core
+    ofParameter<float> floorScale;
+
+    //-----maskingGui.xml-----
+    ofParameter<bool> useMask;
+
+    //-----pixelStatsGui.xml-----
+    ofParameter<bool> stdDevToggle;
+    ofParameter<int> avgPixThresh;
+    ofParameter<int> stdDevThresh[TOTAL_NUM_CAMS];
+
+    //-----stitchingGui.xml-----
+    ofParameter<ofVec2f> camPositions[TOTAL_NUM_CAMS];
+    ofParameter<int> camRotations[TOTAL_NUM_CAMS];
+    ofParameter<bool> camMirrors[TOTAL_NUM_CAMS];
+
+    //-----controlPoints.xml-----
+    //danger zone, then the active zones
+    vector< vector< ofParameter<ofVec2f> > > zonePoints;
+
+
+private:
+
+    //one per xml file, named like the panel that saves it
+    ofParameterGroup settingsGroup;
+    ofParameterGroup maskGroup;
+    ofParameterGroup pixelStatsGroup;
+    ofParameterGroup stitchingGroup;
+    ofParameterGroup zoneGroup;
+
+    static void loadGroup(ofParameterGroup & group);
+
+};
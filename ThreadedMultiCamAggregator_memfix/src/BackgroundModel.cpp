@@ -0,0 +1,19 @@
+//
+//  BackgroundModel.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BackgroundModel.hpp"
+#include "FixedPointBackground.hpp"
+#include "MultiModalBackground.hpp"
+
+
+shared_ptr<BackgroundModel> BackgroundModel::create(Type type){
+
+    if( type == MULTI_MODAL ){
+        return make_shared<MultiModalBackground>();
+    }
+
+    return make_shared<FixedPointBackground>();
+
+}
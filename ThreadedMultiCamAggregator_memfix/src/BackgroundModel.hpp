@@ -0,0 +1,64 @@
+//
+//  BackgroundModel.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BackgroundModel_hpp
+#define BackgroundModel_hpp
+
+#include <stdio.h>
+
+#endif /* BackgroundModel_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * BackgroundModel:
+ *  Common interface for the per-pixel background engines so
+ *  the band workers can swap them at runtime. Every update
+ *  does BRIGHTER difference + threshold + learning in one go.
+ *
+ *  One instance per band, only used from that band's thread.
+ */
+
+class BackgroundModel{
+
+public:
+
+    enum Type{
+        RUNNING_AVERAGE = 0,    //FixedPointBackground
+        MULTI_MODAL = 1         //MultiModalBackground
+    };
+
+    virtual ~BackgroundModel(){}
+
+    virtual Type getType() const = 0;
+    virtual string getName() const = 0;
+
+    //frames until a change is taken into the background
+    virtual void setLearningTime(float frames) = 0;
+    virtual void setThresholdValue(int t) = 0;
+
+    //don't (or more slowly) learn pixels flagged as foreground
+    virtual void setSelectiveLearning(bool b) = 0;
+
+    //next update() starts over from the incoming frame
+    virtual void reset() = 0;
+
+    //start from a known background instead (warm start).
+    //Sets the model's size to the size of bg
+    virtual void setBackground(const ofPixels & bg) = 0;
+
+    //src and freezeMask are grayscale. Outputs get (re)allocated
+    //to the size of src, foreground/background can be null
+    virtual void update(const ofPixels & src, ofPixels & thresh, ofPixels * foreground = NULL, ofPixels * background = NULL, const ofPixels * freezeMask = NULL) = 0;
+
+    //bytes held by the model itself
+    virtual size_t getMemoryUsage() const = 0;
+
+    static shared_ptr<BackgroundModel> create(Type type);
+
+};
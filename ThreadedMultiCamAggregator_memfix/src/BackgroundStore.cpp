@@ -0,0 +1,236 @@
+//
+//  BackgroundStore.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BackgroundStore.hpp"
+
+
+BackgroundStore::BackgroundStore(){
+
+    folder = "background";
+
+}
+
+BackgroundStore::~BackgroundStore(){
+
+    saveIn.close();
+
+    waitForThread(true, 4000);
+
+}
+
+void BackgroundStore::setup(string _folder){
+
+    folder = _folder;
+
+    ofDirectory::createDirectory(folder, true, true);
+
+    startThread();
+
+}
+
+void BackgroundStore::save(const ofPixels & background, const PipelineLayout & layout){
+
+    Snapshot snap;
+    snap.background = background;
+    snap.layout = layout;
+
+    saveIn.send(std::move(snap));
+
+}
+
+bool BackgroundStore::load(ofPixels & background, PipelineLayout & layout){
+
+    string imgPath = folder + "/background.png";
+    string layoutPath = folder + "/layout.txt";
+
+    if( !ofFile::doesFileExist(imgPath) || !ofFile::doesFileExist(layoutPath) ){
+        return false;
+    }
+
+    ofBuffer buffer = ofBufferFromFile(layoutPath);
+
+    //tileW tileH, masterW masterH, then x y rotation per camera
+    vector<string> lines;
+
+    for (ofBuffer::Line it = buffer.getLines().begin(), end = buffer.getLines().end(); it != end; ++it) {
+        string line = ofTrim(*it);
+        if( !line.empty() ) lines.push_back(line);
+    }
+
+    if( lines.size() < 2 ) return false;
+
+    PipelineLayout l;
+
+    vector<string> tile = ofSplitString(lines[0], " ", true, true);
+    vector<string> master = ofSplitString(lines[1], " ", true, true);
+
+    if( tile.size() < 2 || master.size() < 2 ) return false;
+
+    l.tileWidth = ofToInt(tile[0]);
+    l.tileHeight = ofToInt(tile[1]);
+    l.masterWidth = ofToInt(master[0]);
+    l.masterHeight = ofToInt(master[1]);
+
+    for(int i = 2; i < lines.size(); i++){
+
+        vector<string> cam = ofSplitString(lines[i], " ", true, true);
+        if( cam.size() < 3 ) return false;
+
+        l.positions.push_back( ofVec2f( ofToFloat(cam[0]), ofToFloat(cam[1]) ) );
+        l.rotations.push_back( ofToInt(cam[2]) );
+    }
+
+    ofPixels pix;
+
+    if( !ofLoadImage(pix, imgPath) ) return false;
+
+    pix.setImageType(OF_IMAGE_GRAYSCALE);
+
+    if( pix.getWidth() != l.masterWidth || pix.getHeight() != l.masterHeight ){
+        cout << "Saved background doesn't match its layout, ignoring it" << endl;
+        return false;
+    }
+
+    background = pix;
+    layout = l;
+
+    cout << "Loaded saved background: " << l.masterWidth << ", " << l.masterHeight << endl;
+
+    return true;
+
+}
+
+void BackgroundStore::write(const Snapshot & snap){
+
+    const PipelineLayout &l = snap.layout;
+
+    string layoutText = "";
+    layoutText += ofToString(l.tileWidth) + " " + ofToString(l.tileHeight) + "\n";
+    layoutText += ofToString(l.masterWidth) + " " + ofToString(l.masterHeight) + "\n";
+
+    for(int i = 0; i < l.positions.size(); i++){
+        layoutText += ofToString(l.positions[i].x) + " " + ofToString(l.positions[i].y) + " " + ofToString(l.rotations[i]) + "\n";
+    }
+
+    ofBuffer buffer;
+    buffer.append(layoutText);
+
+    //write beside the old files, then swap them in
+    ofSaveImage(snap.background, folder + "/background_tmp.png");
+    ofBufferToFile(folder + "/layout_tmp.txt", buffer);
+
+    ofFile::moveFromTo(folder + "/background_tmp.png", folder + "/background.png", true, true);
+    ofFile::moveFromTo(folder + "/layout_tmp.txt", folder + "/layout.txt", true, true);
+
+}
+
+void BackgroundStore::threadedFunction(){
+
+    while(isThreadRunning()){
+
+        Snapshot snap;
+
+        if( saveIn.tryReceive(snap, 100) ){
+
+            //only the newest one matters
+            Snapshot newer;
+            while( saveIn.tryReceive(newer) ){
+                snap = std::move(newer);
+            }
+
+            write(snap);
+
+        }
+
+    }
+
+}
+
+
+
+bool BackgroundStore::extractTile(const ofPixels & background, const PipelineLayout & layout, int cam, ofPixels & tile){
+
+    if( cam < 0 || cam >= layout.positions.size() ) return false;
+
+    int rot = ((layout.rotations[cam] % 4) + 4) % 4;
+
+    int regionW = rot % 2 == 0 ? layout.tileWidth : layout.tileHeight;
+    int regionH = rot % 2 == 0 ? layout.tileHeight : layout.tileWidth;
+
+    int x = layout.positions[cam].x;
+    int y = layout.positions[cam].y;
+
+    if( x < 0 || y < 0 || x + regionW > background.getWidth() || y + regionH > background.getHeight() ) return false;
+
+    background.cropTo(tile, x, y, regionW, regionH);
+
+    if( rot != 0 ) tile.rotate90(4 - rot);
+
+    return true;
+
+}
+
+bool BackgroundStore::isSameLayout(const PipelineLayout & a, const PipelineLayout & b){
+
+    return a.masterWidth == b.masterWidth && a.masterHeight == b.masterHeight
+        && a.tileWidth == b.tileWidth && a.tileHeight == b.tileHeight
+        && a.positions == b.positions && a.rotations == b.rotations;
+
+}
+
+void BackgroundStore::remap(const ofPixels & oldBackground, const PipelineLayout & oldLayout, const PipelineLayout & newLayout, ofPixels & out){
+
+    int numCams = std::min(oldLayout.positions.size(), newLayout.positions.size());
+
+    //tiles have to be the same size for the regions to mean anything
+    if( oldLayout.tileWidth != newLayout.tileWidth || oldLayout.tileHeight != newLayout.tileHeight ) return;
+
+    int oldW = oldBackground.getWidth();
+    int oldH = oldBackground.getHeight();
+    int outW = out.getWidth();
+    int outH = out.getHeight();
+
+    for(int i = 0; i < numCams; i++){
+
+        int oldRot = ((oldLayout.rotations[i] % 4) + 4) % 4;
+        int newRot = ((newLayout.rotations[i] % 4) + 4) % 4;
+
+        //size of the camera's region in the old composite
+        int regionW = oldRot % 2 == 0 ? oldLayout.tileWidth : oldLayout.tileHeight;
+        int regionH = oldRot % 2 == 0 ? oldLayout.tileHeight : oldLayout.tileWidth;
+
+        int oldX = oldLayout.positions[i].x;
+        int oldY = oldLayout.positions[i].y;
+
+        //can't un-rotate a region we only have part of
+        if( oldX < 0 || oldY < 0 || oldX + regionW > oldW || oldY + regionH > oldH ) continue;
+
+        ofPixels region;
+        oldBackground.cropTo(region, oldX, oldY, regionW, regionH);
+
+        int turns = (newRot - oldRot + 4) % 4;
+        if( turns != 0 ) region.rotate90(turns);
+
+        //paste with clipping against the new composite
+        int newX = newLayout.positions[i].x;
+        int newY = newLayout.positions[i].y;
+
+        int x0 = std::max(0, newX);
+        int x1 = std::min(outW, newX + (int)region.getWidth());
+
+        if( x1 <= x0 ) continue;
+
+        for(int y = std::max(0, newY); y < std::min(outH, newY + (int)region.getHeight()); y++){
+
+            const uint8_t *src = region.getData() + (y - newY) * region.getWidth() + (x0 - newX);
+            uint8_t *dst = out.getData() + y * outW + x0;
+
+            memcpy(dst, src, x1 - x0);
+
+        }
+
+    }
+
+}
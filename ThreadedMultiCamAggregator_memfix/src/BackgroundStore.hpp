@@ -0,0 +1,77 @@
+//
+//  BackgroundStore.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BackgroundStore_hpp
+#define BackgroundStore_hpp
+
+#include <stdio.h>
+
+#endif /* BackgroundStore_hpp */
+
+#include "ofMain.h"
+#include "PipelineData.hpp"
+
+#pragma once
+
+
+/*
+ * BackgroundStore:
+ *  Keeps the learned background on disk so restarts don't
+ *  have to learn it again.
+ *
+ *  Writes happen on this thread so the pipeline never waits on
+ *  the disk: save() just hands over a copy. Each save writes
+ *
+ *      background/background.png   -composite space background
+ *      background/layout.txt       -the layout it was learned in
+ *
+ *  to temp files first and then moves them into place, so a
+ *  crash mid-write leaves the previous save intact.
+ *
+ *  remap() moves every camera's region from the layout the
+ *  background was learned in to a new layout.
+ */
+
+class BackgroundStore: public ofThread{
+
+public:
+
+    BackgroundStore();
+    ~BackgroundStore();
+
+    void setup(string folder = "background");
+
+    //non-blocking, only the newest pending save is written
+    void save(const ofPixels & background, const PipelineLayout & layout);
+
+    //blocking, call once at startup
+    bool load(ofPixels & background, PipelineLayout & layout);
+
+    //out should already hold something sensible for pixels
+    //no camera covered before (the current frame, for instance)
+    static void remap(const ofPixels & oldBackground, const PipelineLayout & oldLayout, const PipelineLayout & newLayout, ofPixels & out);
+
+    //one camera's region, turned back into its own tile
+    //orientation. False if the camera wasn't fully inside
+    static bool extractTile(const ofPixels & background, const PipelineLayout & layout, int cam, ofPixels & tile);
+
+    static bool isSameLayout(const PipelineLayout & a, const PipelineLayout & b);
+
+
+private:
+
+    struct Snapshot{
+        ofPixels background;
+        PipelineLayout layout;
+    };
+
+    ofThreadChannel<Snapshot> saveIn;
+
+    string folder;
+
+    void write(const Snapshot & snap);
+    void threadedFunction();
+
+};
@@ -0,0 +1,191 @@
+//
+//  BandPool.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BandPool.hpp"
+
+
+const int BandPool::MAX_HALO;
+
+
+BandPool::BandPool(){
+
+    numBands = 0;
+    modelBytes = 0;
+    lastWidth = 0;
+    lastHeight = 0;
+    bNeedsReset = true;
+
+}
+
+void BandPool::setup(int n){
+
+    numBands = std::max(1, n);
+
+    //shared_ptr destructor closes the channels and joins the thread
+    workers.clear();
+
+    if( numBands > 1 ){
+
+        for(int i = 0; i < numBands; i++){
+            workers.push_back( make_shared<PostCompositeThreadCV>() );
+            workers.back() -> setup();
+        }
+
+    }
+
+    bNeedsReset = true;
+
+    cout << "Band pool running with " << numBands << " band(s)" << endl;
+
+}
+
+int BandPool::getNumBands() const{
+    return numBands;
+}
+
+size_t BandPool::getModelMemory() const{
+    return modelBytes;
+}
+
+void BandPool::reset(){
+    bNeedsReset = true;
+}
+
+void BandPool::seed(const ofPixels & background){
+    pendingSeed = background;
+}
+
+void BandPool::process(const ofPixels & src, PostCompositeThreadCV::Settings settings, ofPixels & threshPix, ofPixels & foregroundPix, ofPixels & backgroundPix, IntegralImage * integral){
+
+    int w = src.getWidth();
+    int h = src.getHeight();
+
+    settings.buildIntegral = integral != NULL;
+
+    if( w != lastWidth || h != lastHeight ){
+        lastWidth = w;
+        lastHeight = h;
+        bNeedsReset = true;
+    }
+
+    //a reset from the gui always wins over a warm start
+    bool bSeed = !settings.resetBackground && pendingSeed.getWidth() == w && pendingSeed.getHeight() == h;
+
+    settings.resetBackground = (settings.resetBackground || bNeedsReset) && !bSeed;
+    bNeedsReset = false;
+
+    //only ever used once
+    ofPixels seedPix;
+    seedPix.swap(pendingSeed);
+
+
+    //not enough rows to bother, or running serially
+    if( numBands <= 1 || h < numBands ){
+
+        PostCompositeThreadCV::Band band;
+        band.pix = src;
+        band.haloTop = 0;
+        band.haloBottom = 0;
+        band.settings = settings;
+
+        if( bSeed ) band.seed = seedPix;
+
+        PostCompositeThreadCV::Result result;
+        PostCompositeThreadCV::process(band, serialBackground, result);
+
+        threshPix = result.threshPix;
+        foregroundPix = result.foregroundPix;
+        backgroundPix = result.backgroundPix;
+
+        if( integral ){
+            vector<IntegralImage> single(1);
+            std::swap(single[0], result.integral);
+            integral -> setFromBands(single);
+        }
+
+        modelBytes = result.modelBytes;
+
+        return;
+    }
+
+
+    //each 3x3 pass reaches one row further into the neighbors.
+    //Only settings past what the gui allows change the band size
+    int halo = std::max(MAX_HALO, settings.numErosions + settings.numDilations);
+    int bandHeight = (h + numBands - 1)/numBands;
+
+    //rounding up can leave the last worker(s) with no rows
+    int usedBands = (h + bandHeight - 1)/bandHeight;
+
+    vector<int> startRows(usedBands);
+
+    for(int i = 0; i < usedBands; i++){
+
+        int start = i * bandHeight;
+        int end = std::min(start + bandHeight, h);
+
+        int top = std::max(0, start - halo);
+        int bottom = std::min(h, end + halo);
+
+        PostCompositeThreadCV::Band band;
+        src.cropTo(band.pix, 0, top, w, bottom - top);
+        band.haloTop = start - top;
+        band.haloBottom = bottom - end;
+        band.settings = settings;
+
+        if( bSeed ) seedPix.cropTo(band.seed, 0, top, w, bottom - top);
+
+        startRows[i] = start;
+
+        workers[i] -> analyze(band);
+    }
+
+
+    //gather the bands back into the full size objects
+    if( threshPix.getWidth() != w || threshPix.getHeight() != h ) threshPix.allocate(w, h, OF_IMAGE_GRAYSCALE);
+    if( foregroundPix.getWidth() != w || foregroundPix.getHeight() != h ) foregroundPix.allocate(w, h, OF_IMAGE_GRAYSCALE);
+    if( backgroundPix.getWidth() != w || backgroundPix.getHeight() != h ) backgroundPix.allocate(w, h, OF_IMAGE_GRAYSCALE);
+
+    modelBytes = 0;
+
+    vector<IntegralImage> bandIntegrals(usedBands);
+    bool bAllBands = true;
+
+    for(int i = 0; i < usedBands; i++){
+
+        PostCompositeThreadCV::Result result;
+
+        if( workers[i] -> waitForResult(result) ){
+            pasteRows(result.threshPix, threshPix, startRows[i]);
+            pasteRows(result.foregroundPix, foregroundPix, startRows[i]);
+            pasteRows(result.backgroundPix, backgroundPix, startRows[i]);
+            std::swap(bandIntegrals[i], result.integral);
+            modelBytes += result.modelBytes;
+        } else {
+            bAllBands = false;
+        }
+
+    }
+
+    //the bands' tables become one, a missing band means no table
+    if( integral ){
+        if( bAllBands ){
+            integral -> setFromBands(bandIntegrals);
+        } else {
+            integral -> clear();
+        }
+    }
+
+}
+
+void BandPool::pasteRows(const ofPixels & band, ofPixels & dst, int startRow){
+
+    if( !band.isAllocated() ) return;
+
+    int rows = std::min( (int)band.getHeight(), (int)dst.getHeight() - startRow );
+
+    memcpy(dst.getData() + startRow * dst.getWidth(), band.getData(), rows * dst.getWidth());
+
+}
@@ -0,0 +1,82 @@
+//
+//  BandPool.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BandPool_hpp
+#define BandPool_hpp
+
+#include <stdio.h>
+
+#endif /* BandPool_hpp */
+
+#include "ofMain.h"
+#include "PostCompositeThreadCV.hpp"
+#pragma once
+
+
+/*
+ * BandPool:
+ *  Splits the masked composite into horizontal bands and
+ *  runs background/threshold/erode/dilate on each band in
+ *  its own PostCompositeThreadCV, then stitches the bands
+ *  back together.
+ *
+ *  Every band gets MAX_HALO halo rows on each side since each
+ *  3x3 pass only looks one row away, so the stitched result
+ *  matches running on the whole image for up to MAX_HALO
+ *  erosions + dilations. The halo doesn't follow the sliders
+ *  so changing them doesn't resize the bands and throw away
+ *  the learned background.
+ *
+ *  With one band everything runs on the calling thread.
+ */
+
+class BandPool{
+
+public:
+
+    //10 erosions + 10 dilations, the most the gui allows
+    static const int MAX_HALO = 20;
+
+    BandPool();
+
+    void setup(int numBands);
+    int getNumBands() const;
+
+    //forces the next frame to relearn the background
+    void reset();
+
+    //next process() starts the background from this instead,
+    //if it is the same size as the frame. Used once, then dropped
+    void seed(const ofPixels & background);
+
+    //integral (if not NULL) gets the summed-area table of
+    //threshPix/foregroundPix, built by the bands
+    void process(const ofPixels & src, PostCompositeThreadCV::Settings settings, ofPixels & threshPix, ofPixels & foregroundPix, ofPixels & backgroundPix, IntegralImage * integral = NULL);
+
+    //background model state across all bands after the last process()
+    size_t getModelMemory() const;
+
+
+private:
+
+    int numBands;
+    size_t modelBytes;
+
+    //workers can't be copied so keep pointers
+    vector< shared_ptr<PostCompositeThreadCV> > workers;
+
+    //used when there is only one band
+    shared_ptr<BackgroundModel> serialBackground;
+
+    ofPixels pendingSeed;
+
+    //band rows change if the composite changes size,
+    //so the per band backgrounds need to start over
+    int lastWidth, lastHeight;
+    bool bNeedsReset;
+
+    void pasteRows(const ofPixels & band, ofPixels & dst, int startRow);
+
+};
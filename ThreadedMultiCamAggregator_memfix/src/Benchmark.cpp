@@ -0,0 +1,1012 @@
+//
+//  Benchmark.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "Benchmark.hpp"
+#include "SyntheticSource.hpp"
+#include "BandPool.hpp"
+#include "BackgroundModel.hpp"
+#include "BinaryImage.hpp"
+#include "BlobLabeler.hpp"
+#include "BlobTracker.hpp"
+#include "ZoneMap.hpp"
+#include "IntegralImage.hpp"
+#include "PipelineStage.hpp"
+#include "ofxCv.h"
+
+
+void Benchmark::runAll(int compositeW, int compositeH){
+
+    ofBuffer csv;
+
+    cout << "----------BENCHMARK START----------" << endl;
+
+    bandScaling(compositeW, compositeH, csv);
+    backgroundModels(compositeW, compositeH, csv);
+    morphology(compositeW, compositeH, csv);
+    labeling(compositeW, compositeH, csv);
+    tracking(compositeW, compositeH, csv);
+    prediction(compositeW, compositeH, csv);
+    zoneLookup(compositeW, compositeH, csv);
+    occupancy(compositeW, compositeH, csv);
+    oscEncoding(compositeW, compositeH, csv);
+
+    cout << "----------BENCHMARK DONE----------" << endl;
+
+    ofBufferToFile("benchmark_" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S") + ".csv", csv);
+
+}
+
+void Benchmark::log(const string & line, ofBuffer & csv){
+
+    cout << line << endl;
+    csv.append(line + "\n");
+
+}
+
+void Benchmark::getScaledSize(int compositeW, int compositeH, int scale, int & w, int & h){
+
+    w = compositeW * (scale >= 2 ? 2 : 1);
+    h = compositeH * (scale >= 4 ? 2 : 1);
+
+}
+
+void Benchmark::bandScaling(int compositeW, int compositeH, ofBuffer & csv){
+
+    int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    //same settings as the installation uses
+    PostCompositeThreadCV::Settings settings;
+    settings.threshold = 26;
+    settings.useBgDiff = true;
+    settings.learningTime = 12;
+    settings.selectiveLearning = true;
+    settings.resetBackground = false;
+    settings.backgroundModel = BackgroundModel::RUNNING_AVERAGE;
+    settings.numErosions = 1;
+    settings.numDilations = 3;
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    log("bandScaling,width,height,bands,msPerFrame,speedup", csv);
+
+    //7 camera composite, then 2x and 4x the area
+    for(int scale = 1; scale <= 4; scale *= 2){
+
+        int w, h;
+        getScaledSize(compositeW, compositeH, scale, w, h);
+
+        SyntheticSource source;
+        source.setup(w, h, 10 * scale);
+
+        float serialMs = 0;
+
+        for(int bands = 1; bands <= maxThreads; bands++){
+
+            BandPool pool;
+            pool.setup(bands);
+
+            ofPixels thresh, fg, bg;
+
+            for(int i = 0; i < warmupFrames; i++){
+                source.update();
+                pool.process(source.getPixels(), settings, thresh, fg, bg);
+            }
+
+            //only time the pool, not the fake frame generation
+            uint64_t elapsed = 0;
+
+            for(int i = 0; i < timedFrames; i++){
+                source.update();
+
+                uint64_t start = ofGetElapsedTimeMicros();
+                pool.process(source.getPixels(), settings, thresh, fg, bg);
+                elapsed += ofGetElapsedTimeMicros() - start;
+            }
+
+            float ms = elapsed/1000.0f/timedFrames;
+
+            if( bands == 1 ) serialMs = ms;
+
+            log("bandScaling," + ofToString(w) + "," + ofToString(h) + "," + ofToString(bands) + "," + ofToString(ms, 3) + "," + ofToString(serialMs/ms, 2), csv);
+
+        }
+
+    }
+
+}
+
+
+void Benchmark::backgroundModels(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    log("backgroundModels,width,height,model,msPerFrame,mpixPerSec,stateBytes", csv);
+
+    for(int scale = 1; scale <= 4; scale *= 2){
+
+        int w, h;
+        getScaledSize(compositeW, compositeH, scale, w, h);
+
+        float mpix = w * h / 1000000.0f;
+
+        SyntheticSource source;
+        source.setup(w, h, 10 * scale);
+
+        //----------what the pipeline used before----------
+        {
+            ofxCv::RunningBackground bg;
+            bg.setDifferenceMode(ofxCv::RunningBackground::BRIGHTER);
+            bg.setLearningTime(12);
+            bg.setThresholdValue(26);
+
+            ofPixels thresh, fg, bgPix;
+            thresh.allocate(w, h, OF_IMAGE_GRAYSCALE);
+
+            uint64_t elapsed = 0;
+
+            for(int i = 0; i < warmupFrames + timedFrames; i++){
+                source.update();
+
+                uint64_t start = ofGetElapsedTimeMicros();
+                bg.update(source.getPixels(), thresh);
+                ofxCv::toOf( bg.getBackground(), bgPix );
+                ofxCv::toOf( bg.getForeground(), fg );
+                if( i >= warmupFrames ) elapsed += ofGetElapsedTimeMicros() - start;
+            }
+
+            float ms = elapsed/1000.0f/timedFrames;
+
+            //float accumulator + 8 bit background and foreground
+            size_t bytes = (size_t)w * h * (sizeof(float) + 2);
+
+            log("backgroundModels," + ofToString(w) + "," + ofToString(h) + ",RunningBackground," + ofToString(ms, 3) + "," + ofToString(mpix/(ms/1000.0f), 1) + "," + ofToString(bytes), csv);
+        }
+
+        //----------native models, fused----------
+        for(int type = BackgroundModel::RUNNING_AVERAGE; type <= BackgroundModel::MULTI_MODAL; type++){
+
+            shared_ptr<BackgroundModel> bg = BackgroundModel::create( (BackgroundModel::Type)type );
+            bg -> setLearningTime(12);
+            bg -> setThresholdValue(26);
+            bg -> setSelectiveLearning(true);
+
+            ofPixels thresh, fg, bgPix;
+
+            uint64_t elapsed = 0;
+
+            for(int i = 0; i < warmupFrames + timedFrames; i++){
+                source.update();
+
+                uint64_t start = ofGetElapsedTimeMicros();
+                bg -> update(source.getPixels(), thresh, &fg, &bgPix);
+                if( i >= warmupFrames ) elapsed += ofGetElapsedTimeMicros() - start;
+            }
+
+            float ms = elapsed/1000.0f/timedFrames;
+
+            log("backgroundModels," + ofToString(w) + "," + ofToString(h) + "," + bg -> getName() + "," + ofToString(ms, 3) + "," + ofToString(mpix/(ms/1000.0f), 1) + "," + ofToString(bg -> getMemoryUsage()), csv);
+        }
+
+        //----------multi-modal across every core----------
+        {
+            int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+            PostCompositeThreadCV::Settings settings;
+            settings.threshold = 26;
+            settings.useBgDiff = true;
+            settings.learningTime = 12;
+            settings.selectiveLearning = true;
+            settings.resetBackground = false;
+            settings.backgroundModel = BackgroundModel::MULTI_MODAL;
+            settings.numErosions = 0;
+            settings.numDilations = 0;
+
+            BandPool pool;
+            pool.setup(maxThreads);
+
+            ofPixels thresh, fg, bgPix;
+
+            uint64_t elapsed = 0;
+
+            for(int i = 0; i < warmupFrames + timedFrames; i++){
+                source.update();
+
+                uint64_t start = ofGetElapsedTimeMicros();
+                pool.process(source.getPixels(), settings, thresh, fg, bgPix);
+                if( i >= warmupFrames ) elapsed += ofGetElapsedTimeMicros() - start;
+            }
+
+            float ms = elapsed/1000.0f/timedFrames;
+
+            log("backgroundModels," + ofToString(w) + "," + ofToString(h) + ",Multi-modal x" + ofToString(maxThreads) + " bands," + ofToString(ms, 3) + "," + ofToString(mpix/(ms/1000.0f), 1) + "," + ofToString(pool.getModelMemory()), csv);
+        }
+
+    }
+
+}
+
+
+void Benchmark::morphology(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    int w = compositeW;
+    int h = compositeH;
+
+    SyntheticSource source;
+    source.setup(w, h, 10);
+
+    log("morphology,width,height,iterations,ofxCvMs,bitsMs,speedup,mismatchedPixels", csv);
+
+    for(int n = 1; n <= 8; n *= 2){
+
+        uint64_t cvElapsed = 0;
+        uint64_t bitsElapsed = 0;
+        int mismatched = 0;
+
+        BinaryImage bits;
+
+        for(int i = 0; i < warmupFrames + timedFrames; i++){
+            source.update();
+
+            //----------ofxCv, one 3x3 pass per iteration----------
+            ofPixels cvPix;
+
+            uint64_t start = ofGetElapsedTimeMicros();
+            ofxCv::threshold(source.getPixels(), cvPix, 26);
+            for(int k = 0; k < n; k++) ofxCv::erode(cvPix);
+            for(int k = 0; k < n; k++) ofxCv::dilate(cvPix);
+            if( i >= warmupFrames ) cvElapsed += ofGetElapsedTimeMicros() - start;
+
+            //----------packed bits, including pack and unpack----------
+            ofPixels bitsPix;
+
+            start = ofGetElapsedTimeMicros();
+            bits.setFromThreshold(source.getPixels(), 26);
+            bits.erode(n);
+            bits.dilate(n);
+            bits.toPixels(bitsPix);
+            if( i >= warmupFrames ) bitsElapsed += ofGetElapsedTimeMicros() - start;
+
+            //has to be the exact same image
+            if( i == warmupFrames + timedFrames - 1 ){
+                const uint8_t *a = cvPix.getData();
+                const uint8_t *b = bitsPix.getData();
+                for(int p = 0; p < w * h; p++){
+                    if( a[p] != b[p] ) mismatched++;
+                }
+            }
+        }
+
+        float cvMs = cvElapsed/1000.0f/timedFrames;
+        float bitsMs = bitsElapsed/1000.0f/timedFrames;
+
+        log("morphology," + ofToString(w) + "," + ofToString(h) + "," + ofToString(n) + "," + ofToString(cvMs, 3) + "," + ofToString(bitsMs, 3) + "," + ofToString(cvMs/std::max(bitsMs, 0.001f), 2) + "," + ofToString(mismatched), csv);
+    }
+
+}
+
+
+static bool sameBlobs(const BlobLabeler & a, const BlobLabeler & b){
+
+    const vector<Blob> &x = a.getBlobs();
+    const vector<Blob> &y = b.getBlobs();
+
+    if( x.size() != y.size() || a.getRuns().size() != b.getRuns().size() ) return false;
+
+    for(int i = 0; i < x.size(); i++){
+        if( x[i].area != y[i].area || x[i].bbox != y[i].bbox || x[i].centroid != y[i].centroid ) return false;
+        if( x[i].intensitySum != y[i].intensitySum || x[i].intensityMax != y[i].intensityMax ) return false;
+        if( x[i].firstRun != y[i].firstRun || x[i].numRuns != y[i].numRuns ) return false;
+    }
+
+    return true;
+
+}
+
+void Benchmark::labeling(int compositeW, int compositeH, ofBuffer & csv){
+
+    int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    log("labeling,width,height,bands,msPerFrame,speedup,blobs,identical", csv);
+
+    //7 camera composite, then 2x and 4x the area
+    for(int scale = 1; scale <= 4; scale *= 2){
+
+        int w, h;
+        getScaledSize(compositeW, compositeH, scale, w, h);
+
+        SyntheticSource source;
+        source.setup(w, h, 10 * scale);
+
+        float serialMs = 0;
+
+        for(int bands = 1; bands <= maxThreads; bands++){
+
+            BlobLabeler labeler;
+            labeler.setup(bands);
+
+            BlobLabeler serial;
+
+            BinaryImage bits;
+
+            uint64_t elapsed = 0;
+            bool bIdentical = true;
+            int numBlobs = 0;
+
+            for(int i = 0; i < warmupFrames + timedFrames; i++){
+                source.update();
+                bits.setFromThreshold(source.getPixels(), 26);
+
+                //only time the labeling, not the packing
+                uint64_t start = ofGetElapsedTimeMicros();
+                labeler.label(bits, &source.getPixels(), 10, 1000000);
+                if( i >= warmupFrames ) elapsed += ofGetElapsedTimeMicros() - start;
+
+                serial.label(bits, &source.getPixels(), 10, 1000000);
+                bIdentical = bIdentical && sameBlobs(labeler, serial);
+
+                numBlobs = labeler.getBlobs().size();
+            }
+
+            float ms = elapsed/1000.0f/timedFrames;
+
+            if( bands == 1 ) serialMs = ms;
+
+            log("labeling," + ofToString(w) + "," + ofToString(h) + "," + ofToString(bands) + "," + ofToString(ms, 3) + "," + ofToString(serialMs/ms, 2) + "," + ofToString(numBlobs) + "," + (bIdentical ? "yes" : "NO"), csv);
+
+        }
+
+    }
+
+}
+
+
+void Benchmark::tracking(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 300;
+
+    //4x the composite area so hundreds of blobs still mostly stay apart
+    int w = compositeW * 2;
+    int h = compositeH * 2;
+
+    log("tracking,width,height,syntheticBlobs,detectedBlobs,tracks,msPerFrame,maxMs,idSwitchesPerFrame", csv);
+
+    int counts[] = { 10, 50, 100, 200, 400 };
+
+    for(int c = 0; c < 5; c++){
+
+        SyntheticSource source;
+        source.setup(w, h, counts[c]);
+
+        BinaryImage bits;
+        BlobLabeler labeler;
+
+        BlobTracker tracker;
+        tracker.setPersistence(15);
+        tracker.setMaximumDistance(32);
+
+        //which track each synthetic blob was on last frame
+        vector<int> lastId(counts[c], -1);
+
+        uint64_t elapsed = 0;
+        uint64_t worst = 0;
+        int switches = 0;
+
+        for(int i = 0; i < warmupFrames + timedFrames; i++){
+            source.update();
+
+            bits.setFromThreshold(source.getPixels(), 100);
+            labeler.label(bits, NULL, 10, 1000000);
+
+            uint64_t start = ofGetElapsedTimeMicros();
+            tracker.update(labeler.getBlobs(), 1/30.0f);
+            uint64_t took = ofGetElapsedTimeMicros() - start;
+
+            const vector<Track> &tracks = tracker.getTracks();
+
+            //the closest seen track to each synthetic blob
+            for(int b = 0; b < source.blobs.size(); b++){
+
+                int id = -1;
+                float best = source.blobs[b].radius * source.blobs[b].radius;
+
+                for(int t = 0; t < tracks.size(); t++){
+                    if( tracks[t].blobIndex == -1 ) continue;
+                    float d2 = tracks[t].pos.squareDistance(source.blobs[b].pos);
+                    if( d2 < best ){
+                        best = d2;
+                        id = tracks[t].id;
+                    }
+                }
+
+                if( i >= warmupFrames && id != -1 && lastId[b] != -1 && id != lastId[b] ) switches++;
+                if( id != -1 ) lastId[b] = id;
+            }
+
+            if( i >= warmupFrames ){
+                elapsed += took;
+                worst = std::max(worst, took);
+            }
+        }
+
+        float ms = elapsed/1000.0f/timedFrames;
+
+        log("tracking," + ofToString(w) + "," + ofToString(h) + "," + ofToString(counts[c]) + "," + ofToString(labeler.getBlobs().size()) + "," + ofToString(tracker.getTracks().size()) + "," + ofToString(ms, 3) + "," + ofToString(worst/1000.0f, 3) + "," + ofToString(switches/(float)timedFrames, 3), csv);
+
+    }
+
+}
+
+//true if any pixel SyntheticSource draws for the blob is in a zone
+static bool isInZone(const ZoneMap & zones, const SyntheticSource::Blob & b){
+
+    int r = b.radius;
+
+    for(int y = (int)b.pos.y - r; y <= (int)b.pos.y + r; y++){
+        for(int x = (int)b.pos.x - r; x <= (int)b.pos.x + r; x++){
+
+            float dx = x - b.pos.x;
+            float dy = y - b.pos.y;
+
+            if( dx*dx + dy*dy <= b.radius * b.radius && zones.getZone(x, y) != -1 ){
+                return true;
+            }
+        }
+    }
+
+    return false;
+
+}
+
+void Benchmark::prediction(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 900;
+    const float fps = 30;
+    const int numBlobs = 20;
+
+    //frames between a blob being somewhere and the receiver
+    //hearing about it
+    int latencies[] = { 0, 1, 3, 6 };
+
+    //a rectangle in the middle third, rasterized like ofApp does
+    vector< vector<ofVec2f> > polygons(1);
+    polygons[0].push_back( ofVec2f(compositeW/3.0f, compositeH/3.0f) );
+    polygons[0].push_back( ofVec2f(compositeW*2/3.0f, compositeH/3.0f) );
+    polygons[0].push_back( ofVec2f(compositeW*2/3.0f, compositeH*2/3.0f) );
+    polygons[0].push_back( ofVec2f(compositeW/3.0f, compositeH*2/3.0f) );
+
+    shared_ptr<ZoneMap> zoneMap = make_shared<ZoneMap>();
+    zoneMap -> build(polygons, compositeW, compositeH);
+
+    log("prediction,latencyMs,entries,measuredDelayMs,predictedDelayMs,measuredMissed,predictedMissed,predictedFalseAlarms", csv);
+
+    for(int l = 0; l < 4; l++){
+
+        int latency = latencies[l];
+
+        //same seed every run so each latency sees the same walk
+        ofSeedRandom(1234);
+
+        SyntheticSource source;
+        source.setup(compositeW, compositeH, numBlobs);
+
+        BinaryImage bits;
+
+        //the stages the Aggregator runs, fresh for every latency
+        BlobStage blobStage;
+        TrackStage trackStage;
+        PredictStage predictStage;
+
+        PipelineFrame frame;
+        frame.zoneMap = zoneMap;
+        frame.settings.useParallelBands = false;
+        frame.settings.numBands = 1;
+        frame.settings.minBlobArea = 10;
+        frame.settings.maxBlobArea = 1000000;
+        frame.settings.persistence = 15;
+        frame.settings.maxDistance = 32;
+        frame.settings.usePrediction = true;
+        frame.settings.predictionHorizon = latency / fps;
+
+        //capture times are kept ahead of the clock so tracking sees
+        //exactly 1/fps between frames and prediction leads by the
+        //horizon alone, however fast this loop runs
+        uint64_t firstCapture = ofGetElapsedTimeMicros() + 3600 * 1000000ULL;
+
+        //what the pipeline decided for each blob, oldest first,
+        //and handed to the receiver `latency` frames later
+        deque< vector<bool> > measuredQueue, predictedQueue;
+
+        vector<bool> wasInside(numBlobs, false);
+        vector<int> entryFrame(numBlobs, -1);
+        vector<bool> measuredPending(numBlobs, false), predictedPending(numBlobs, false);
+
+        //frame the prediction first said "inside" while the blob wasn't
+        vector<int> earlyFrame(numBlobs, -1);
+
+        int entries = 0;
+        int measuredCount = 0, predictedCount = 0;
+        float measuredDelay = 0, predictedDelay = 0;
+        int measuredMissed = 0, predictedMissed = 0;
+        int falseAlarms = 0;
+
+        for(int i = 0; i < warmupFrames + timedFrames; i++){
+
+            source.update();
+
+            bits.setFromThreshold(source.getPixels(), 100);
+
+            PipelineResult r;
+            bits.toPixels(r.threshPix);
+            r.foregroundPix = source.getPixels();
+
+            frame.captureTime = firstCapture + (uint64_t)(i * 1000000 / fps);
+
+            blobStage.process(frame, r);
+            trackStage.process(frame, r);
+            predictStage.process(frame, r);
+
+            const vector<Track> &tracks = r.tracks;
+
+            vector<bool> measured(numBlobs, false), predicted(numBlobs, false);
+
+            for(int b = 0; b < numBlobs; b++){
+
+                //the closest seen track to each synthetic blob
+                int best = -1;
+                float bestDist = source.blobs[b].radius * source.blobs[b].radius;
+
+                for(int t = 0; t < tracks.size(); t++){
+                    if( tracks[t].blobIndex == -1 ) continue;
+                    float d2 = tracks[t].pos.squareDistance(source.blobs[b].pos);
+                    if( d2 < bestDist ){
+                        bestDist = d2;
+                        best = t;
+                    }
+                }
+
+                if( best == -1 ) continue;
+
+                const Track &t = tracks[best];
+
+                //the zone labeling gave the blob, and the one PredictStage
+                //finds for it moved to its predicted position
+                measured[b] = r.blobs[t.blobIndex].zone != -1;
+                predicted[b] = ZoneStage::blobZone(*zoneMap, r.blobs[t.blobIndex], r.blobRuns, t.predictedPos - t.pos) != -1;
+            }
+
+            measuredQueue.push_back(measured);
+            predictedQueue.push_back(predicted);
+
+            if( measuredQueue.size() <= latency ) continue;
+
+            //what the receiver hears this frame
+            vector<bool> heardMeasured = measuredQueue.front();
+            vector<bool> heardPredicted = predictedQueue.front();
+            measuredQueue.pop_front();
+            predictedQueue.pop_front();
+
+            bool bTimed = i >= warmupFrames;
+
+            for(int b = 0; b < numBlobs; b++){
+
+                //any of the blob's pixels, same as the stages
+                bool inside = isInZone(*zoneMap, source.blobs[b]);
+
+                //----------GROUND TRUTH----------
+                if( inside && !wasInside[b] ){
+
+                    entryFrame[b] = i;
+                    measuredPending[b] = true;
+                    predictedPending[b] = true;
+
+                    if( bTimed ) entries++;
+
+                    //prediction already called it
+                    if( earlyFrame[b] != -1 ){
+                        if( bTimed ){
+                            predictedDelay += (earlyFrame[b] - i) * 1000 / fps;
+                            predictedCount++;
+                        }
+                        predictedPending[b] = false;
+                        earlyFrame[b] = -1;
+                    }
+                }
+
+                //left again before it was reported
+                if( !inside && wasInside[b] ){
+                    if( bTimed && measuredPending[b] ) measuredMissed++;
+                    if( bTimed && predictedPending[b] ) predictedMissed++;
+                    measuredPending[b] = false;
+                    predictedPending[b] = false;
+                }
+
+                wasInside[b] = inside;
+
+                //----------REPORTED----------
+                if( measuredPending[b] && heardMeasured[b] ){
+                    if( bTimed ){
+                        measuredDelay += (i - entryFrame[b]) * 1000 / fps;
+                        measuredCount++;
+                    }
+                    measuredPending[b] = false;
+                }
+
+                if( predictedPending[b] && heardPredicted[b] ){
+                    if( bTimed ){
+                        predictedDelay += (i - entryFrame[b]) * 1000 / fps;
+                        predictedCount++;
+                    }
+                    predictedPending[b] = false;
+                }
+
+                if( !inside && heardPredicted[b] && earlyFrame[b] == -1 ){
+                    earlyFrame[b] = i;
+                }
+
+                //called early but the blob never showed up
+                if( earlyFrame[b] != -1 && i - earlyFrame[b] > 2 * latency + 2 ){
+                    if( bTimed ) falseAlarms++;
+                    earlyFrame[b] = -1;
+                }
+
+            }
+
+        }
+
+        float measuredMs = measuredCount > 0 ? measuredDelay / measuredCount : 0;
+        float predictedMs = predictedCount > 0 ? predictedDelay / predictedCount : 0;
+
+        log("prediction," + ofToString(latency * 1000 / fps, 0) + "," + ofToString(entries) + "," + ofToString(measuredMs, 1) + "," + ofToString(predictedMs, 1) + "," + ofToString(measuredMissed) + "," + ofToString(predictedMissed) + "," + ofToString(falseAlarms), csv);
+
+    }
+
+}
+
+void Benchmark::zoneLookup(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    log("zoneLookup,zones,verticesPerZone,blobs,buildMs,polylineMs,mapMs,speedup", csv);
+
+    SyntheticSource source;
+    source.setup(compositeW, compositeH, 50);
+
+    BinaryImage bits;
+    BlobLabeler labeler;
+
+    int zoneCounts[] = { 3, 16, 64 };
+    int vertexCounts[] = { 4, 32, 256 };
+
+    for(int zc = 0; zc < 3; zc++){
+        for(int vc = 0; vc < 3; vc++){
+
+            int numZones = zoneCounts[zc];
+            int numVertices = vertexCounts[vc];
+
+            //wobbly rings around the middle, innermost first
+            vector< vector<ofVec2f> > polygons(numZones);
+            vector<ofPolyline> polylines(numZones);
+            vector<ofRectangle> boxes(numZones);
+
+            ofVec2f center(compositeW/2.0f, compositeH/2.0f);
+
+            for(int z = 0; z < numZones; z++){
+
+                float radius = std::min(compositeW, compositeH) * 0.48f * (z + 1) / numZones;
+
+                for(int v = 0; v < numVertices; v++){
+
+                    float angle = TWO_PI * v / numVertices;
+                    float r = radius * (1 + 0.1f * sinf(angle * 5 + z));
+
+                    ofVec2f p = center + ofVec2f(cosf(angle), sinf(angle)) * r;
+                    polygons[z].push_back(p);
+                    polylines[z].addVertex(p.x, p.y);
+                }
+
+                polylines[z].close();
+                boxes[z] = polylines[z].getBoundingBox();
+            }
+
+            uint64_t start = ofGetElapsedTimeMicros();
+            ZoneMap zoneMap;
+            zoneMap.build(polygons, compositeW, compositeH);
+            float buildMs = (ofGetElapsedTimeMicros() - start)/1000.0f;
+
+            uint64_t polylineTime = 0;
+            uint64_t mapTime = 0;
+            int numBlobs = 0;
+
+            for(int i = 0; i < warmupFrames + timedFrames; i++){
+
+                source.update();
+                bits.setFromThreshold(source.getPixels(), 100);
+                labeler.label(bits, NULL, 10, 1000000);
+
+                const vector<Blob> &blobs = labeler.getBlobs();
+                const vector<BlobRun> &runs = labeler.getRuns();
+
+                numBlobs = blobs.size();
+
+                vector<int> polylineZone(blobs.size(), -1);
+                vector<int> mapZone(blobs.size(), -1);
+
+                //----------POLYLINE----------
+                //per blob, zones inside out until a run end is inside one
+                start = ofGetElapsedTimeMicros();
+
+                for(int b = 0; b < blobs.size(); b++){
+
+                    const Blob &blob = blobs[b];
+
+                    for(int z = 0; z < numZones && polylineZone[b] == -1; z++){
+
+                        if( !blob.bbox.intersects(boxes[z]) ) continue;
+
+                        for(int k = blob.firstRun; k < blob.firstRun + blob.numRuns; k++){
+                            if( polylines[z].inside(runs[k].x0, runs[k].y) || polylines[z].inside(runs[k].x1 - 1, runs[k].y) ){
+                                polylineZone[b] = z;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                uint64_t polylineTook = ofGetElapsedTimeMicros() - start;
+
+                //----------MAP----------
+                //the same lookups the labeler does per run
+                start = ofGetElapsedTimeMicros();
+
+                for(int b = 0; b < blobs.size(); b++){
+
+                    const Blob &blob = blobs[b];
+
+                    for(int k = blob.firstRun; k < blob.firstRun + blob.numRuns; k++){
+                        int z = zoneMap.getZone(runs[k].y, runs[k].x0, runs[k].x1);
+                        if( z != -1 && (mapZone[b] == -1 || z < mapZone[b]) ) mapZone[b] = z;
+                    }
+                }
+
+                uint64_t mapTook = ofGetElapsedTimeMicros() - start;
+
+                if( i >= warmupFrames ){
+                    polylineTime += polylineTook;
+                    mapTime += mapTook;
+                }
+            }
+
+            float polylineMs = polylineTime/1000.0f/timedFrames;
+            float mapMs = mapTime/1000.0f/timedFrames;
+
+            log("zoneLookup," + ofToString(numZones) + "," + ofToString(numVertices) + "," + ofToString(numBlobs) + "," + ofToString(buildMs, 3) + "," + ofToString(polylineMs, 3) + "," + ofToString(mapMs, 3) + "," + ofToString(mapMs > 0 ? polylineMs/mapMs : 0, 1), csv);
+
+        }
+    }
+
+}
+
+void Benchmark::occupancy(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 100;
+
+    log("occupancy,zone,shape,area,buildMs,tableMs,pixelMs,identical", csv);
+
+    SyntheticSource source;
+    source.setup(compositeW, compositeH, 50);
+
+    //a big rectangle and two wobbly rings, like the real zones
+    vector< vector<ofVec2f> > polygons(3);
+
+    polygons[0].push_back( ofVec2f(compositeW * 0.1f, compositeH * 0.1f) );
+    polygons[0].push_back( ofVec2f(compositeW * 0.6f, compositeH * 0.1f) );
+    polygons[0].push_back( ofVec2f(compositeW * 0.6f, compositeH * 0.9f) );
+    polygons[0].push_back( ofVec2f(compositeW * 0.1f, compositeH * 0.9f) );
+
+    ofVec2f center(compositeW * 0.6f, compositeH/2.0f);
+
+    for(int z = 1; z < 3; z++){
+        for(int v = 0; v < 32; v++){
+            float angle = TWO_PI * v / 32;
+            float r = std::min(compositeW, compositeH) * 0.2f * z * (1 + 0.1f * sinf(angle * 5));
+            polygons[z].push_back( center + ofVec2f(cosf(angle), sinf(angle)) * r );
+        }
+    }
+
+    ZoneMap zoneMap;
+    zoneMap.build(polygons, compositeW, compositeH);
+
+    IntegralImage integral;
+
+    uint64_t buildTime = 0;
+    vector<uint64_t> tableTime(3, 0), pixelTime(3, 0);
+    vector<bool> bIdentical(3, true);
+
+    for(int i = 0; i < warmupFrames + timedFrames; i++){
+
+        source.update();
+
+        const ofPixels &pix = source.getPixels();
+
+        uint64_t start = ofGetElapsedTimeMicros();
+        integral.setFromThreshold(pix, 100, &pix);
+        uint64_t took = ofGetElapsedTimeMicros() - start;
+
+        if( i >= warmupFrames ) buildTime += took;
+
+        for(int z = 0; z < 3; z++){
+
+            const vector<ZoneMap::Span> &spans = zoneMap.getSpans(z);
+            const vector<int> &rowStart = zoneMap.getRowStarts(z);
+
+            //----------TABLE----------
+            start = ofGetElapsedTimeMicros();
+
+            uint64_t tableCount = 0, tableSum = 0;
+            int x0, y0, x1, y1;
+
+            if( zoneMap.getRectangle(z, x0, y0, x1, y1) ){
+                tableCount = integral.getCount(x0, y0, x1, y1);
+                tableSum = integral.getIntensity(x0, y0, x1, y1);
+            } else {
+                for(int y = 0; y < compositeH; y++){
+                    for(int k = rowStart[y]; k < rowStart[y + 1]; k++){
+                        tableCount += integral.getCount(spans[k].start, y, spans[k].end, y + 1);
+                        tableSum += integral.getIntensity(spans[k].start, y, spans[k].end, y + 1);
+                    }
+                }
+            }
+
+            took = ofGetElapsedTimeMicros() - start;
+            if( i >= warmupFrames ) tableTime[z] += took;
+
+            //----------PIXELS----------
+            start = ofGetElapsedTimeMicros();
+
+            uint64_t pixelCount = 0, pixelSum = 0;
+
+            for(int y = 0; y < compositeH; y++){
+                for(int k = rowStart[y]; k < rowStart[y + 1]; k++){
+                    const unsigned char *p = pix.getData() + y * compositeW;
+                    for(int x = spans[k].start; x < spans[k].end; x++){
+                        if( p[x] > 100 ){
+                            pixelCount++;
+                            pixelSum += p[x];
+                        }
+                    }
+                }
+            }
+
+            took = ofGetElapsedTimeMicros() - start;
+            if( i >= warmupFrames ) pixelTime[z] += took;
+
+            if( tableCount != pixelCount || tableSum != pixelSum ) bIdentical[z] = false;
+
+        }
+
+    }
+
+    for(int z = 0; z < 3; z++){
+
+        int x0, y0, x1, y1;
+        string shape = zoneMap.getRectangle(z, x0, y0, x1, y1) ? "rectangle" : "polygon";
+
+        log("occupancy," + ofToString(z) + "," + shape + "," + ofToString(zoneMap.getZoneArea(z)) + "," + ofToString(buildTime/1000.0f/timedFrames, 3) + "," + ofToString(tableTime[z]/1000.0f/timedFrames, 4) + "," + ofToString(pixelTime[z]/1000.0f/timedFrames, 3) + "," + (bIdentical[z] ? "yes" : "NO"), csv);
+
+    }
+
+}
+
+void Benchmark::oscEncoding(int compositeW, int compositeH, ofBuffer & csv){
+
+    const int warmupFrames = 10;
+    const int timedFrames = 200;
+
+    log("oscEncoding,blobs,packets,bytes,writerMs,messagesMs", csv);
+
+    int counts[] = {10, 100, 300, 1000};
+
+    OscWriter writer;
+    writer.setup(OscStage::MAX_PACKET_SIZE);
+
+    OscSender::Batch batch;
+    vector<ofxOscMessage> messages;
+
+    for(int c = 0; c < 4; c++){
+
+        //blobs scattered over the composite, all tracked
+        PipelineResult r;
+        r.frameNum = 0;
+
+        ofSeedRandom(c);
+
+        for(int i = 0; i < counts[c]; i++){
+
+            Blob b;
+            b.area = ofRandom(100, 2000);
+            b.centroid.set( ofRandom(compositeW), ofRandom(compositeH) );
+            b.zone = ofRandom(-1, 4);
+            b.camera = ofRandom(0, 4);
+            r.blobs.push_back(b);
+
+            Track t;
+            t.id = i;
+            t.pos = b.centroid;
+            t.vel.set( ofRandom(-50, 50), ofRandom(-50, 50) );
+            t.blobIndex = i;
+            r.tracks.push_back(t);
+
+        }
+
+        uint64_t writerTime = 0, messagesTime = 0;
+        size_t bytes = 0, packets = 0;
+
+        for(int i = 0; i < warmupFrames + timedFrames; i++){
+
+            r.frameNum = i;
+
+            //----------WRITER----------
+            batch.data.clear();
+            batch.packetSizes.clear();
+
+            uint64_t start = ofGetElapsedTimeMicros();
+            OscStage::encodeBlobs(r, 1.0f, OscWriter::IMMEDIATELY, writer, batch);
+            uint64_t took = ofGetElapsedTimeMicros() - start;
+
+            if( i >= warmupFrames ) writerTime += took;
+
+            bytes = batch.data.size();
+            packets = batch.packetSizes.size();
+
+            //----------MESSAGES----------
+            start = ofGetElapsedTimeMicros();
+
+            messages.clear();
+
+            for(int j = 0; j < r.tracks.size(); j++){
+
+                const Track &t = r.tracks[j];
+                const Blob &b = r.blobs[t.blobIndex];
+
+                ofxOscMessage m;
+
+                m.setAddress("/blob");
+                m.addIntArg( t.id );
+                m.addFloatArg( b.centroid.x );
+                m.addFloatArg( b.centroid.y );
+                m.addFloatArg( b.centroid.x );
+                m.addFloatArg( b.centroid.y );
+                m.addIntArg( b.area );
+                m.addIntArg( b.zone );
+                m.addFloatArg( t.vel.x );
+                m.addFloatArg( t.vel.y );
+                m.addIntArg( b.camera );
+
+                messages.push_back(m);
+            }
+
+            took = ofGetElapsedTimeMicros() - start;
+
+            if( i >= warmupFrames ) messagesTime += took;
+
+        }
+
+        log("oscEncoding," + ofToString(counts[c]) + "," + ofToString(packets) + "," + ofToString(bytes) + "," + ofToString(writerTime/1000.0f/timedFrames, 4) + "," + ofToString(messagesTime/1000.0f/timedFrames, 4), csv);
+
+    }
+
+}
@@ -0,0 +1,85 @@
+//
+//  Benchmark.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <stdio.h>
+
+#endif /* Benchmark_hpp */
+
+#include "ofMain.h"
+#pragma once
+
+
+/*
+ * Benchmark:
+ *  Offline timing runs on synthetic composites. Triggered
+ *  from ofApp with the 'b' key, results go to the console
+ *  and to a csv in the data folder. Blocks while running.
+ */
+
+class Benchmark{
+
+public:
+
+    //runs everything below
+    static void runAll(int compositeW, int compositeH);
+
+    //post-composite band pool, 1 to N bands on the
+    //real composite size and on 2x and 4x larger ones
+    static void bandScaling(int compositeW, int compositeH, ofBuffer & csv);
+
+    //RunningBackground vs the native models, single thread,
+    //including getting foreground/background out as ofPixels.
+    //Also multi-modal band-parallel on every core
+    static void backgroundModels(int compositeW, int compositeH, ofBuffer & csv);
+
+    //threshold + N erosions + N dilations, ofxCv vs BinaryImage.
+    //Also counts pixels where the two disagree (should be 0)
+    static void morphology(int compositeW, int compositeH, ofBuffer & csv);
+
+    //BlobLabeler with 1 to N bands on the real composite
+    //size and on 2x and 4x larger ones. Also checks every
+    //banded result against the serial one
+    static void labeling(int compositeW, int compositeH, ofBuffer & csv);
+
+    //BlobTracker cost per frame (mean and worst) for tens to
+    //hundreds of synthetic blobs, plus how often the track on
+    //a synthetic blob changed ID
+    static void tracking(int compositeW, int compositeH, ofBuffer & csv);
+
+    //how late zone entries are reported with the pipeline a few
+    //frames behind the scene, through the real BlobStage,
+    //TrackStage and PredictStage over a ZoneMap, with and
+    //without prediction. Also counts predicted entries that
+    //never happened
+    static void prediction(int compositeW, int compositeH, ofBuffer & csv);
+
+    //innermost zone per blob, point-in-polygon on the run ends
+    //vs the rasterized ZoneMap, for a few to many zones with
+    //more and more vertices. Also how long the map takes to build
+    static void zoneLookup(int compositeW, int compositeH, ofBuffer & csv);
+
+    //per zone occupied area and mean intensity from the
+    //summed-area table vs adding up every zone pixel, for a
+    //rectangle and for polygons. Also checks they agree
+    static void occupancy(int compositeW, int compositeH, ofBuffer & csv);
+
+    //per-blob OSC for more and more tracked blobs, encoded by
+    //OscStage into preallocated packets vs one ofxOscMessage
+    //per blob like the other OSC messages
+    static void oscEncoding(int compositeW, int compositeH, ofBuffer & csv);
+
+
+private:
+
+    static void log(const string & line, ofBuffer & csv);
+
+    //composite with scale (1, 2 or 4) times the area:
+    //W x H, 2W x H, 2W x 2H
+    static void getScaledSize(int compositeW, int compositeH, int scale, int & w, int & h);
+
+};
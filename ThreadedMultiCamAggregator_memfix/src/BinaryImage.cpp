@@ -0,0 +1,322 @@
+//
+//  BinaryImage.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BinaryImage.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+//dst |= src moved s pixels to the right (towards higher x)
+static void orShiftedRight(const uint64_t * src, uint64_t * dst, int n, int s){
+
+    int wordOffset = s / 64;
+    int bitOffset = s % 64;
+
+    for(int w = n - 1; w >= wordOffset; w--){
+
+        uint64_t v = src[w - wordOffset] << bitOffset;
+
+        if( bitOffset && w - wordOffset - 1 >= 0 ){
+            v |= src[w - wordOffset - 1] >> (64 - bitOffset);
+        }
+
+        dst[w] |= v;
+    }
+
+}
+
+//dst |= src moved s pixels to the left (towards lower x)
+static void orShiftedLeft(const uint64_t * src, uint64_t * dst, int n, int s){
+
+    int wordOffset = s / 64;
+    int bitOffset = s % 64;
+
+    for(int w = 0; w + wordOffset < n; w++){
+
+        uint64_t v = src[w + wordOffset] >> bitOffset;
+
+        if( bitOffset && w + wordOffset + 1 < n ){
+            v |= src[w + wordOffset + 1] << (64 - bitOffset);
+        }
+
+        dst[w] |= v;
+    }
+
+}
+
+//8 bits -> 8 bytes of 0/255, bit 0 first in memory
+struct ExpandTable{
+
+    uint64_t entries[256];
+
+    ExpandTable(){
+        for(int i = 0; i < 256; i++){
+            uint8_t bytes[8];
+            for(int b = 0; b < 8; b++){
+                bytes[b] = (i >> b) & 1 ? 255 : 0;
+            }
+            memcpy(&entries[i], bytes, 8);
+        }
+    }
+
+};
+
+//built once, on first use. Band threads call toPixels() at the
+//same time so this relies on the thread safe local static
+static const uint64_t * expandTable(){
+
+    static const ExpandTable table;
+
+    return table.entries;
+
+}
+
+
+
+BinaryImage::BinaryImage(){
+
+    width = 0;
+    height = 0;
+    wordsPerRow = 0;
+    lastWordMask = ~0ULL;
+
+}
+
+void BinaryImage::allocate(int w, int h){
+
+    width = w;
+    height = h;
+    wordsPerRow = (w + 63) / 64;
+
+    int leftover = w % 64;
+    lastWordMask = leftover == 0 ? ~0ULL : (1ULL << leftover) - 1;
+
+    bits.assign(wordsPerRow * height, 0);
+
+}
+
+bool BinaryImage::isAllocated() const{
+    return !bits.empty();
+}
+
+int BinaryImage::getWidth() const{
+    return width;
+}
+
+int BinaryImage::getHeight() const{
+    return height;
+}
+
+int BinaryImage::getWordsPerRow() const{
+    return wordsPerRow;
+}
+
+const uint64_t * BinaryImage::getRow(int y) const{
+    return bits.data() + y * wordsPerRow;
+}
+
+uint64_t * BinaryImage::getRow(int y){
+    return bits.data() + y * wordsPerRow;
+}
+
+bool BinaryImage::get(int x, int y) const{
+
+    if( x < 0 || y < 0 || x >= width || y >= height ) return false;
+
+    return (getRow(y)[x / 64] >> (x % 64)) & 1;
+
+}
+
+
+
+void BinaryImage::setFromThreshold(const ofPixels & pix, int threshold){
+
+    int w = pix.getWidth();
+    int h = pix.getHeight();
+    int step = pix.getNumChannels();
+
+    if( w != width || h != height ){
+        allocate(w, h);
+    }
+
+    threshold = ofClamp(threshold, 0, 255);
+
+    for(int y = 0; y < h; y++){
+
+        const uint8_t *src = pix.getData() + y * w * step;
+        uint64_t *row = getRow(y);
+
+        int x = 0;
+
+#ifdef __SSE2__
+        //grayscale: 16 pixels per compare, 4 compares per word
+        if( step == 1 ){
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i t = _mm_set1_epi8( (char)threshold );
+
+            for(; x + 64 <= w; x += 64){
+
+                uint64_t word = 0;
+
+                for(int i = 0; i < 4; i++){
+                    __m128i p = _mm_loadu_si128( (const __m128i*)(src + x + i * 16) );
+
+                    //bit set where p <= threshold, so flip it
+                    uint64_t notSet = (uint64_t)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_subs_epu8(p, t), zero ) );
+                    word |= (~notSet & 0xFFFF) << (i * 16);
+                }
+
+                row[x / 64] = word;
+            }
+
+        }
+#endif
+
+        for(; x < w; x += 64){
+
+            uint64_t word = 0;
+            int end = std::min(64, w - x);
+
+            for(int i = 0; i < end; i++){
+                word |= (uint64_t)(src[(x + i) * step] > threshold) << i;
+            }
+
+            row[x / 64] = word;
+        }
+
+    }
+
+}
+
+void BinaryImage::toPixels(ofPixels & pix) const{
+
+    if( pix.getWidth() != width || pix.getHeight() != height || pix.getNumChannels() != 1 ){
+        pix.allocate(width, height, OF_IMAGE_GRAYSCALE);
+    }
+
+    const uint64_t *table = expandTable();
+
+    for(int y = 0; y < height; y++){
+
+        const uint64_t *row = getRow(y);
+        uint8_t *dst = pix.getData() + y * width;
+
+        for(int x = 0; x < width; x += 8){
+
+            uint64_t bytes = table[ (row[x / 64] >> (x % 64)) & 0xFF ];
+
+            memcpy(dst + x, &bytes, std::min(8, width - x));
+        }
+
+    }
+
+}
+
+
+
+void BinaryImage::clearPadding(){
+
+    if( lastWordMask == ~0ULL ) return;
+
+    for(int y = 0; y < height; y++){
+        getRow(y)[wordsPerRow - 1] &= lastWordMask;
+    }
+
+}
+
+void BinaryImage::invert(){
+
+    for(int i = 0; i < bits.size(); i++){
+        bits[i] = ~bits[i];
+    }
+
+    clearPadding();
+
+}
+
+void BinaryImage::dilateRows(int r){
+
+    scratchA.resize(wordsPerRow);
+
+    for(int y = 0; y < height; y++){
+
+        uint64_t *row = getRow(y);
+
+        //reach grows by doubling: 1, 3, 7, 15... up to r
+        int reach = 0;
+
+        while( reach < r ){
+
+            int step = std::min(reach + 1, r - reach);
+
+            memcpy(scratchA.data(), row, wordsPerRow * sizeof(uint64_t));
+
+            orShiftedRight(scratchA.data(), row, wordsPerRow, step);
+            orShiftedLeft(scratchA.data(), row, wordsPerRow, step);
+
+            reach += step;
+        }
+
+    }
+
+    clearPadding();
+
+}
+
+void BinaryImage::dilateColumns(int r){
+
+    int reach = 0;
+
+    while( reach < r ){
+
+        int step = std::min(reach + 1, r - reach);
+
+        scratchB = bits;
+
+        for(int y = 0; y < height; y++){
+
+            uint64_t *row = getRow(y);
+
+            if( y - step >= 0 ){
+                const uint64_t *above = scratchB.data() + (y - step) * wordsPerRow;
+                for(int w = 0; w < wordsPerRow; w++) row[w] |= above[w];
+            }
+
+            if( y + step < height ){
+                const uint64_t *below = scratchB.data() + (y + step) * wordsPerRow;
+                for(int w = 0; w < wordsPerRow; w++) row[w] |= below[w];
+            }
+
+        }
+
+        reach += step;
+    }
+
+}
+
+void BinaryImage::dilate(int n){
+
+    if( n <= 0 || bits.empty() ) return;
+
+    dilateRows(n);
+    dilateColumns(n);
+
+}
+
+void BinaryImage::erode(int n){
+
+    if( n <= 0 || bits.empty() ) return;
+
+    //erosion is dilation of the background. Flipping first
+    //makes the outside act as set, like OpenCV's border
+    invert();
+    dilateRows(n);
+    dilateColumns(n);
+    invert();
+
+}
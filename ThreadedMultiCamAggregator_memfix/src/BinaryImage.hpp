@@ -0,0 +1,82 @@
+//
+//  BinaryImage.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BinaryImage_hpp
+#define BinaryImage_hpp
+
+#include <stdio.h>
+
+#endif /* BinaryImage_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * BinaryImage:
+ *  Thresholded image packed 64 pixels per word (same layout
+ *  as BinaryMask, bit 0 is the leftmost pixel) with erode and
+ *  dilate done by shifting and OR-ing whole words.
+ *
+ *  N iterations of the 3x3 square that ofxCv::erode/dilate use
+ *  are the same as one (2N+1)x(2N+1) square, which splits into
+ *  a horizontal and a vertical pass. Each pass grows its reach
+ *  by doubling, so it costs log2(N) steps instead of N.
+ *
+ *  Borders behave like OpenCV's defaults: outside the image
+ *  counts as set when eroding and as clear when dilating.
+ */
+
+class BinaryImage{
+
+public:
+
+    BinaryImage();
+
+    void allocate(int w, int h);
+
+    //bit set where the first channel is > threshold.
+    //Use 0 to pack an existing 0/255 image
+    void setFromThreshold(const ofPixels & pix, int threshold);
+
+    //0/255 grayscale
+    void toPixels(ofPixels & pix) const;
+
+    //same as calling ofxCv::erode/dilate n times
+    void erode(int n);
+    void dilate(int n);
+
+    bool get(int x, int y) const;
+    bool isAllocated() const;
+
+    int getWidth() const;
+    int getHeight() const;
+    int getWordsPerRow() const;
+
+    const uint64_t * getRow(int y) const;
+    uint64_t * getRow(int y);
+
+
+private:
+
+    void dilateRows(int r);
+    void dilateColumns(int r);
+    void invert();
+
+    //clears the bits past the right edge so shifts can't drag them in
+    void clearPadding();
+
+    int width, height;
+    int wordsPerRow;
+    uint64_t lastWordMask;
+
+    vector<uint64_t> bits;
+
+    //scratch space so repeated calls don't allocate
+    vector<uint64_t> scratchA;
+    vector<uint64_t> scratchB;
+
+};
@@ -0,0 +1,190 @@
+//
+//  BinaryMask.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BinaryMask.hpp"
+
+
+BinaryMask::BinaryMask(){
+
+    width = 0;
+    height = 0;
+    wordsPerRow = 0;
+
+}
+
+void BinaryMask::setFromPixels(const ofPixels &pix){
+
+    width = pix.getWidth();
+    height = pix.getHeight();
+    wordsPerRow = (width + 63)/64;
+
+    bits.assign(wordsPerRow * height, 0);
+
+    int channels = pix.getNumChannels();
+    const unsigned char *data = pix.getData();
+
+    for(int y = 0; y < height; y++){
+
+        uint64_t *row = &bits[y * wordsPerRow];
+        const unsigned char *src = data + y * width * channels;
+
+        for(int x = 0; x < width; x++){
+            if( src[x * channels] > 0 ){
+                row[x >> 6] |= (uint64_t)1 << (x & 63);
+            }
+        }
+    }
+
+    buildRuns();
+
+}
+
+void BinaryMask::resize(int w, int h){
+
+    if( w == width && h == height ) return;
+
+    int newWordsPerRow = (w + 63)/64;
+    vector<uint64_t> newBits(newWordsPerRow * h, 0);
+
+    int copyRows = std::min(h, height);
+    int copyWidth = std::min(w, width);
+    int copyWords = (copyWidth + 63)/64;
+
+    for(int y = 0; y < copyRows; y++){
+
+        uint64_t *dst = &newBits[y * newWordsPerRow];
+        const uint64_t *src = &bits[y * wordsPerRow];
+
+        for(int i = 0; i < copyWords; i++){
+            dst[i] = src[i];
+        }
+
+        //clear anything past the old/new width in the last word
+        if( copyWidth & 63 ){
+            dst[copyWords - 1] &= ((uint64_t)1 << (copyWidth & 63)) - 1;
+        }
+    }
+
+    width = w;
+    height = h;
+    wordsPerRow = newWordsPerRow;
+    bits.swap(newBits);
+
+    buildRuns();
+
+}
+
+void BinaryMask::buildRuns(){
+
+    runs.clear();
+    rowRunStart.assign(height + 1, 0);
+
+    for(int y = 0; y < height; y++){
+
+        rowRunStart[y] = runs.size();
+
+        const uint64_t *row = &bits[y * wordsPerRow];
+        int x = 0;
+
+        while( x < width ){
+
+            //skip whole masked/unmasked words when we can
+            uint64_t word = row[x >> 6];
+            bool masked = (word >> (x & 63)) & 1;
+
+            int start = x;
+
+            while( x < width ){
+
+                word = row[x >> 6];
+
+                if( (x & 63) == 0 && x + 64 <= width ){
+                    if( !masked && word == 0 ){ x += 64; continue; }
+                    if( masked && word == ~(uint64_t)0 ){ x += 64; continue; }
+                }
+
+                if( (bool)((word >> (x & 63)) & 1) != masked ) break;
+                x++;
+            }
+
+            if( !masked ){
+                runs.push_back({ start, x });
+            }
+        }
+    }
+
+    rowRunStart[height] = runs.size();
+
+}
+
+void BinaryMask::apply(const ofPixels &src, ofPixels &dst) const{
+
+    //mask doesn't match, nothing to mask
+    if( src.getWidth() != width || src.getHeight() != height || src.getNumChannels() != 1 ){
+        dst = src;
+        return;
+    }
+
+    if( dst.getWidth() != src.getWidth() || dst.getHeight() != src.getHeight() || dst.getNumChannels() != 1 ){
+        dst.allocate(width, height, OF_IMAGE_GRAYSCALE);
+    }
+
+    const unsigned char *s = src.getData();
+    unsigned char *d = dst.getData();
+
+    for(int y = 0; y < height; y++){
+
+        const unsigned char *srcRow = s + y * width;
+        unsigned char *dstRow = d + y * width;
+
+        int x = 0;
+
+        for(int r = rowRunStart[y]; r < rowRunStart[y + 1]; r++){
+
+            //gap before this run is masked
+            if( runs[r].start > x ){
+                memset(dstRow + x, 0, runs[r].start - x);
+            }
+
+            memcpy(dstRow + runs[r].start, srcRow + runs[r].start, runs[r].end - runs[r].start);
+            x = runs[r].end;
+        }
+
+        if( x < width ){
+            memset(dstRow + x, 0, width - x);
+        }
+    }
+
+}
+
+void BinaryMask::copyUnmasked(int x, int y, int n, const unsigned char *src, unsigned char *dst) const{
+
+    if( y < 0 || y >= height ) return;
+
+    int end = x + n;
+
+    for(int r = rowRunStart[y]; r < rowRunStart[y + 1]; r++){
+
+        int start = std::max(runs[r].start, x);
+        int stop = std::min(runs[r].end, end);
+
+        if( stop > start ){
+            memcpy(dst + start - x, src + start - x, stop - start);
+        }
+    }
+
+}
+
+bool BinaryMask::isAllocated() const{
+    return width > 0 && height > 0;
+}
+
+int BinaryMask::getWidth() const{
+    return width;
+}
+
+int BinaryMask::getHeight() const{
+    return height;
+}
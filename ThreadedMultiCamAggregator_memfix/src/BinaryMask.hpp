@@ -0,0 +1,77 @@
+//
+//  BinaryMask.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BinaryMask_hpp
+#define BinaryMask_hpp
+
+#include <stdio.h>
+
+#endif /* BinaryMask_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * BinaryMask:
+ *  Bit-packed version of the 8-bit mask image drawn in the
+ *  masking view. One bit per pixel, 64 pixels per word.
+ *
+ *  Every row is also stored as a list of unmasked runs so
+ *  applying the mask is just a memcpy of the runs and a memset
+ *  of the gaps. Fully masked rows cost nothing but a memset.
+ */
+
+class BinaryMask{
+
+public:
+
+    BinaryMask();
+
+    //any non-zero pixel in the first channel is considered masked
+    void setFromPixels(const ofPixels &pix);
+
+    //crop/pad to the new dimensions, keeping the top left
+    //corner in place. New area is left unmasked. Works on the
+    //bits, no 8-bit image needed
+    void resize(int w, int h);
+
+    //dst = src with all the masked pixels set to black.
+    //Replaces ofxCv::subtract(src, mask, dst) for 0/255 masks
+    void apply(const ofPixels &src, ofPixels &dst) const;
+
+    //copies the unmasked pixels of row y, columns [x, x+n), from
+    //src to dst (both start at column x). Masked ones are left alone
+    //so pasting into a cleared image masks as it goes
+    void copyUnmasked(int x, int y, int n, const unsigned char *src, unsigned char *dst) const;
+
+    bool isAllocated() const;
+
+    int getWidth() const;
+    int getHeight() const;
+
+
+private:
+
+    void buildRuns();
+
+    int width, height;
+    int wordsPerRow;
+
+    //one word covers 64 pixels, bit 0 is the leftmost pixel.
+    //Only kept for resize(), applying uses the runs
+    vector<uint64_t> bits;
+
+    //unmasked [start, end) spans for every row, all rows
+    //concatenated. rowRunStart[y] indexes into runs
+    struct Run{
+        int start;
+        int end;
+    };
+    vector<Run> runs;
+    vector<int> rowRunStart;
+
+};
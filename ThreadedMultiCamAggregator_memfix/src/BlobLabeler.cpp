@@ -0,0 +1,489 @@
+//
+//  BlobLabeler.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BlobLabeler.hpp"
+#include "CpuMeter.hpp"
+
+
+//-----------------------------BAND THREAD-----------------------------
+LabelBandThread::LabelBandThread(){
+
+}
+
+LabelBandThread::~LabelBandThread(){
+
+    job_IN.close();
+    band_OUT.close();
+
+    waitForThread(true, 4000);
+
+}
+
+void LabelBandThread::setup(){
+
+    startThread();
+
+}
+
+void LabelBandThread::analyze(const Job & job){
+
+    job_IN.send(job);
+
+}
+
+//blocks until the thread is done with the band
+bool LabelBandThread::waitForResult(Band & band){
+
+    return band_OUT.receive(band);
+
+}
+
+void LabelBandThread::process(const Job & job, Band & band){
+
+    const BinaryImage &bits = *job.bits;
+
+    int w = bits.getWidth();
+    int words = bits.getWordsPerRow();
+    int rows = job.endRow - job.startRow;
+
+    band.runs.clear();
+    band.rowStart.assign(rows + 1, 0);
+
+
+    //----------RUNS----------
+    for(int y = job.startRow; y < job.endRow; y++){
+
+        band.rowStart[y - job.startRow] = band.runs.size();
+
+        const uint64_t *row = bits.getRow(y);
+
+        bool inRun = false;
+        int start = 0;
+
+        for(int wd = 0; wd < words; wd++){
+
+            uint64_t word = row[wd];
+            int base = wd * 64;
+
+            //skip whole words that can't start or end a run
+            if( (!inRun && word == 0) || (inRun && word == ~0ULL) ) continue;
+
+            int pos = 0;
+
+            while( pos < 64 ){
+
+                if( !inRun ){
+                    uint64_t rest = word >> pos;
+                    if( rest == 0 ) break;
+
+                    pos += __builtin_ctzll(rest);
+                    start = base + pos;
+                    inRun = true;
+                } else {
+                    uint64_t rest = ~word >> pos;
+                    if( rest == 0 ) break;
+
+                    pos += __builtin_ctzll(rest);
+
+                    BlobRun r = { y, start, base + pos };
+                    band.runs.push_back(r);
+                    inRun = false;
+                }
+
+            }
+
+        }
+
+        if( inRun ){
+            BlobRun r = { y, start, w };
+            band.runs.push_back(r);
+        }
+
+    }
+
+    band.rowStart[rows] = band.runs.size();
+
+
+    //----------INTENSITY----------
+    band.runSum.assign(band.runs.size(), 0);
+    band.runMax.assign(band.runs.size(), 0);
+
+    if( job.intensity ){
+
+        int step = job.intensity -> getNumChannels();
+
+        for(int i = 0; i < band.runs.size(); i++){
+
+            const BlobRun &r = band.runs[i];
+            const uint8_t *p = job.intensity -> getData() + ((size_t)r.y * w + r.x0) * step;
+
+            uint64_t sum = 0;
+            int maxVal = 0;
+
+            for(int x = 0; x < r.x1 - r.x0; x++){
+                sum += p[x * step];
+                maxVal = std::max(maxVal, (int)p[x * step]);
+            }
+
+            band.runSum[i] = sum;
+            band.runMax[i] = maxVal;
+        }
+
+    }
+
+
+    //----------ZONES----------
+    band.runZone.assign(band.runs.size(), -1);
+
+    if( job.zones ){
+
+        for(int i = 0; i < band.runs.size(); i++){
+            const BlobRun &r = band.runs[i];
+            band.runZone[i] = job.zones -> getZone(r.y, r.x0, r.x1);
+        }
+
+    }
+
+
+    //----------CONNECT----------
+    band.parent.resize(band.runs.size());
+
+    for(int i = 0; i < band.parent.size(); i++){
+        band.parent[i] = i;
+    }
+
+    for(int y = 1; y < rows; y++){
+        BlobLabeler::connectRows(band.runs, band.rowStart, band.parent, y);
+    }
+
+}
+
+void LabelBandThread::threadedFunction(){
+
+    while(isThreadRunning()){
+
+        Job job;
+
+        if(job_IN.receive(job)){
+
+            uint64_t cpuStart = CpuMeter::getThreadCpuTime();
+
+            Band band;
+            process(job, band);
+
+            CpuMeter::addWorkerCpuTime( CpuMeter::getThreadCpuTime() - cpuStart );
+
+            band_OUT.send(std::move(band));
+
+        }
+
+    }
+
+}
+
+
+
+//-----------------------------LABELER-----------------------------
+BlobLabeler::BlobLabeler(){
+
+    numBands = 1;
+
+}
+
+void BlobLabeler::setup(int n){
+
+    numBands = std::max(1, n);
+
+    //shared_ptr destructor closes the channels and joins the thread
+    workers.clear();
+
+    if( numBands > 1 ){
+
+        for(int i = 0; i < numBands; i++){
+            workers.push_back( make_shared<LabelBandThread>() );
+            workers.back() -> setup();
+        }
+
+    }
+
+}
+
+int BlobLabeler::getNumBands() const{
+    return numBands;
+}
+
+const vector<Blob> & BlobLabeler::getBlobs() const{
+    return blobs;
+}
+
+const vector<BlobRun> & BlobLabeler::getRuns() const{
+    return runs;
+}
+
+int BlobLabeler::find(vector<int> & parent, int i){
+
+    //path halving
+    while( parent[i] != i ){
+        parent[i] = parent[ parent[i] ];
+        i = parent[i];
+    }
+
+    return i;
+
+}
+
+void BlobLabeler::unite(vector<int> & parent, int a, int b){
+
+    a = find(parent, a);
+    b = find(parent, b);
+
+    //the earlier run stays the root so every component is
+    //rooted at its first run in raster order
+    if( a < b ) parent[b] = a;
+    else if( b < a ) parent[a] = b;
+
+}
+
+void BlobLabeler::connectRows(const vector<BlobRun> & runs, const vector<int> & rowStart, vector<int> & parent, int y){
+
+    int i = rowStart[y - 1];
+    int j = rowStart[y];
+
+    while( i < rowStart[y] && j < rowStart[y + 1] ){
+
+        const BlobRun &above = runs[i];
+        const BlobRun &cur = runs[j];
+
+        //touching or diagonal neighbors
+        if( above.x0 <= cur.x1 && cur.x0 <= above.x1 ){
+            unite(parent, i, j);
+        }
+
+        //whichever ends first can't touch anything further right
+        if( above.x1 < cur.x1 ) i++;
+        else j++;
+
+    }
+
+}
+
+void BlobLabeler::label(const BinaryImage & bits, const ofPixels * intensity, int minArea, int maxArea, const ZoneMap * zones, const CameraMap * cameras){
+
+    int w = bits.getWidth();
+    int h = bits.getHeight();
+
+    if( intensity && (intensity -> getWidth() != w || intensity -> getHeight() != h) ){
+        intensity = NULL;
+    }
+
+    if( zones && (zones -> getWidth() != w || zones -> getHeight() != h) ){
+        zones = NULL;
+    }
+
+    if( cameras && (cameras -> getWidth() != w || cameras -> getHeight() != h) ){
+        cameras = NULL;
+    }
+
+    //bands need a few rows each to be worth a thread
+    int usedBands = std::max(1, std::min(numBands, h / 16));
+
+    if( workers.empty() ) usedBands = 1;
+
+    bands.resize(usedBands);
+    bandStartRows.resize(usedBands);
+
+    int bandHeight = (h + usedBands - 1) / usedBands;
+
+    if( usedBands == 1 ){
+
+        LabelBandThread::Job job = { &bits, intensity, zones, 0, h };
+        LabelBandThread::process(job, bands[0]);
+        bandStartRows[0] = 0;
+
+    } else {
+
+        //rounding up can leave the last worker(s) with no rows
+        usedBands = (h + bandHeight - 1) / bandHeight;
+        bands.resize(usedBands);
+        bandStartRows.resize(usedBands);
+
+        for(int i = 0; i < usedBands; i++){
+            LabelBandThread::Job job = { &bits, intensity, zones, i * bandHeight, std::min(h, (i + 1) * bandHeight) };
+            bandStartRows[i] = job.startRow;
+            workers[i] -> analyze(job);
+        }
+
+        for(int i = 0; i < usedBands; i++){
+            workers[i] -> waitForResult(bands[i]);
+        }
+
+    }
+
+    gatherBands(h);
+    measure(minArea, maxArea, cameras);
+
+}
+
+void BlobLabeler::gatherBands(int h){
+
+    if( bands.size() == 1 ){
+
+        allRuns.swap(bands[0].runs);
+        rowStart.swap(bands[0].rowStart);
+        parent.swap(bands[0].parent);
+        runSum.swap(bands[0].runSum);
+        runMax.swap(bands[0].runMax);
+        runZone.swap(bands[0].runZone);
+        return;
+
+    }
+
+    allRuns.clear();
+    parent.clear();
+    runSum.clear();
+    runMax.clear();
+    runZone.clear();
+    rowStart.assign(h + 1, 0);
+
+    for(int b = 0; b < bands.size(); b++){
+
+        LabelBandThread::Band &band = bands[b];
+        int offset = allRuns.size();
+        int rows = band.rowStart.size() - 1;
+
+        for(int y = 0; y < rows; y++){
+            rowStart[bandStartRows[b] + y] = offset + band.rowStart[y];
+        }
+
+        allRuns.insert(allRuns.end(), band.runs.begin(), band.runs.end());
+        runSum.insert(runSum.end(), band.runSum.begin(), band.runSum.end());
+        runMax.insert(runMax.end(), band.runMax.begin(), band.runMax.end());
+        runZone.insert(runZone.end(), band.runZone.begin(), band.runZone.end());
+
+        for(int i = 0; i < band.parent.size(); i++){
+            parent.push_back(offset + band.parent[i]);
+        }
+
+    }
+
+    rowStart[h] = allRuns.size();
+
+    //stitch the seams, first row of each band to the row above it
+    for(int b = 1; b < bands.size(); b++){
+        connectRows(allRuns, rowStart, parent, bandStartRows[b]);
+    }
+
+}
+
+void BlobLabeler::measure(int minArea, int maxArea, const CameraMap * cameras){
+
+    int numRuns = allRuns.size();
+
+    blobs.clear();
+    runs.clear();
+
+    vector<Blob> found;
+    vector<int> maxX, maxY;
+
+    blobIndex.assign(numRuns, -1);
+    sumX.clear();
+    sumY.clear();
+
+    for(int i = 0; i < numRuns; i++){
+
+        int root = find(parent, i);
+        const BlobRun &r = allRuns[i];
+
+        //roots are first in raster order, so this is a new blob
+        if( blobIndex[root] == -1 ){
+
+            blobIndex[root] = found.size();
+
+            Blob b;
+            b.area = 0;
+            b.bbox.x = r.x0;
+            b.bbox.y = r.y;
+            b.intensitySum = 0;
+            b.intensityMax = 0;
+            b.zone = -1;
+            b.firstRun = 0;
+            b.numRuns = 0;
+
+            found.push_back(b);
+            maxX.push_back(r.x1 - 1);
+            maxY.push_back(r.y);
+            sumX.push_back(0);
+            sumY.push_back(0);
+        }
+
+        int bi = blobIndex[root];
+        Blob &b = found[bi];
+
+        int len = r.x1 - r.x0;
+
+        b.area += len;
+        b.numRuns++;
+        b.bbox.x = std::min(b.bbox.x, (float)r.x0);
+        maxX[bi] = std::max(maxX[bi], r.x1 - 1);
+        maxY[bi] = r.y;
+
+        //x0 + (x0+1) + ... + (x1-1)
+        sumX[bi] += (uint64_t)len * (r.x0 + r.x1 - 1) / 2;
+        sumY[bi] += (uint64_t)len * r.y;
+
+        b.intensitySum += runSum[i];
+        b.intensityMax = std::max(b.intensityMax, runMax[i]);
+
+        //lower zone index is further in
+        if( runZone[i] != -1 && (b.zone == -1 || runZone[i] < b.zone) ){
+            b.zone = runZone[i];
+        }
+
+    }
+
+
+    //----------FILTER AND GROUP----------
+    vector<int> keep(found.size(), -1);
+
+    for(int i = 0; i < found.size(); i++){
+
+        Blob &b = found[i];
+
+        if( b.area < minArea || b.area > maxArea ) continue;
+
+        b.bbox.width = maxX[i] - b.bbox.x + 1;
+        b.bbox.height = maxY[i] - b.bbox.y + 1;
+        b.centroid.set( sumX[i] / (float)b.area, sumY[i] / (float)b.area );
+
+        b.camera = cameras ? cameras -> getCamera(b.centroid.x, b.centroid.y) : -1;
+
+        keep[i] = blobs.size();
+        blobs.push_back(b);
+
+    }
+
+    //each blob's runs sit together in the order they were found
+    int offset = 0;
+
+    for(int i = 0; i < blobs.size(); i++){
+        blobs[i].firstRun = offset;
+        offset += blobs[i].numRuns;
+        blobs[i].numRuns = 0;
+    }
+
+    runs.resize(offset);
+
+    for(int i = 0; i < numRuns; i++){
+
+        int k = keep[ blobIndex[ find(parent, i) ] ];
+        if( k == -1 ) continue;
+
+        Blob &b = blobs[k];
+        runs[b.firstRun + b.numRuns] = allRuns[i];
+        b.numRuns++;
+
+    }
+
+}
@@ -0,0 +1,181 @@
+//
+//  BlobLabeler.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BlobLabeler_hpp
+#define BlobLabeler_hpp
+
+#include <stdio.h>
+
+#endif /* BlobLabeler_hpp */
+
+#include "ofMain.h"
+#include "BinaryImage.hpp"
+#include "ZoneMap.hpp"
+#include "CameraMap.hpp"
+
+#pragma once
+
+
+//horizontal stretch of set pixels, x1 is one past the end
+struct BlobRun{
+    int y;
+    int x0, x1;
+};
+
+struct Blob{
+
+    int area;               //pixels
+    ofRectangle bbox;
+    ofVec2f centroid;
+
+    //from the intensity image (foreground difference),
+    //0 if there wasn't one
+    uint64_t intensitySum;
+    int intensityMax;
+
+    //innermost zone any of its pixels is in, -1 if none
+    int zone;
+
+    //camera that owns the centroid pixel, -1 if none
+    int camera;
+
+    //this blob's runs, top to bottom, in BlobLabeler::getRuns()
+    int firstRun;
+    int numRuns;
+
+};
+
+
+/*
+ * LabelBandThread:
+ *  Pulls the runs out of a range of rows and joins the ones
+ *  that touch inside that range. Used by BlobLabeler to work
+ *  on several bands of the image at once.
+ */
+
+class LabelBandThread: public ofThread{
+
+public:
+
+    LabelBandThread();
+    ~LabelBandThread();
+
+    struct Job{
+        const BinaryImage * bits;
+
+        //null to skip, otherwise the same size as bits
+        const ofPixels * intensity;
+
+        //null to skip, otherwise the same size as bits
+        const ZoneMap * zones;
+
+        int startRow, endRow;
+    };
+
+    //indices in rowStart and parent are local to the band.
+    //Intensity and zone are found per run here so the pixel
+    //work happens on the band threads
+    struct Band{
+        vector<BlobRun> runs;
+        vector<int> rowStart;
+        vector<int> parent;
+        vector<uint64_t> runSum;
+        vector<int> runMax;
+        vector<int> runZone;
+    };
+
+    void setup();
+    void analyze(const Job & job);
+    bool waitForResult(Band & band);
+
+    //the actual work, also used directly when running serially
+    static void process(const Job & job, Band & band);
+
+
+private:
+
+    ofThreadChannel<Job> job_IN;
+    ofThreadChannel<Band> band_OUT;
+
+    void threadedFunction();
+
+};
+
+
+/*
+ * BlobLabeler:
+ *  Connected components (8-connected) straight from a packed
+ *  BinaryImage:
+ *
+ *      -runs of set bits are pulled out of each row a word
+ *       at a time
+ *      -runs that touch a run in the row above (including
+ *       diagonally) are joined with union-find
+ *      -area, bbox, centroid, intensity and the innermost
+ *       zone are gathered per component from the runs, no
+ *       per-pixel labels, then the camera is looked up at
+ *       the centroid
+ *
+ *  With more than one band, each band of rows is done on its
+ *  own thread and then the seams between bands are joined
+ *  with the same union-find. Roots are always the earliest
+ *  run, so the result doesn't depend on the number of bands.
+ *
+ *  Blobs outside [minArea, maxArea] are dropped here, so the
+ *  later stages only ever see the ones that count. Blobs come
+ *  out in raster order of their first pixel.
+ */
+
+class BlobLabeler{
+
+public:
+
+    BlobLabeler();
+
+    void setup(int numBands);
+    int getNumBands() const;
+
+    //intensity, zones and cameras can be null or a different size to skip them
+    void label(const BinaryImage & bits, const ofPixels * intensity, int minArea, int maxArea, const ZoneMap * zones = NULL, const CameraMap * cameras = NULL);
+
+    const vector<Blob> & getBlobs() const;
+    const vector<BlobRun> & getRuns() const;
+
+    //shared with LabelBandThread
+    static int find(vector<int> & parent, int i);
+    static void unite(vector<int> & parent, int a, int b);
+
+    //joins runs in rows y-1 and y
+    static void connectRows(const vector<BlobRun> & runs, const vector<int> & rowStart, vector<int> & parent, int y);
+
+
+private:
+
+    void gatherBands(int h);
+    void measure(int minArea, int maxArea, const CameraMap * cameras);
+
+    int numBands;
+
+    //workers can't be copied so keep pointers
+    vector< shared_ptr<LabelBandThread> > workers;
+    vector<LabelBandThread::Band> bands;
+    vector<int> bandStartRows;
+
+    //runs of every row, rowStart[y] is the first run of row y
+    vector<BlobRun> allRuns;
+    vector<int> rowStart;
+    vector<int> parent;
+    vector<uint64_t> runSum;
+    vector<int> runMax;
+    vector<int> runZone;
+
+    vector<Blob> blobs;
+    vector<BlobRun> runs;
+
+    //per component scratch
+    vector<int> blobIndex;
+    vector<uint64_t> sumX, sumY;
+
+};
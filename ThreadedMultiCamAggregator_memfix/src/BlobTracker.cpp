@@ -0,0 +1,513 @@
+//
+//  BlobTracker.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "BlobTracker.hpp"
+
+
+//acceleration people can manage (pixels/second^2), squared
+static const float PROCESS_NOISE = 300.0f * 300.0f;
+
+//how far a blob centroid jitters frame to frame (pixels), squared
+static const float MEASUREMENT_NOISE = 2.0f * 2.0f;
+
+//how unsure a new track is about its velocity (pixels/second), squared
+static const float INITIAL_VELOCITY_VARIANCE = 200.0f * 200.0f;
+
+//costs that mean "not allowed" in the assignment
+static const float NO_MATCH_COST = 1e9f;
+
+//keep the grid small even if the gate is tiny
+static const int MAX_GRID_CELLS = 256;
+
+
+static int findRoot(vector<int> & parent, int i){
+
+    while( parent[i] != i ){
+        parent[i] = parent[ parent[i] ];
+        i = parent[i];
+    }
+
+    return i;
+
+}
+
+
+BlobTracker::BlobTracker(){
+
+    persistence = 15;
+    maxDistance = 64;
+    dwellSpeed = 15;
+    nextId = 0;
+
+}
+
+void BlobTracker::setPersistence(int frames){
+    persistence = std::max(0, frames);
+}
+
+void BlobTracker::setMaximumDistance(float pixels){
+    maxDistance = std::max(1.0f, pixels);
+}
+
+void BlobTracker::setDwellSpeed(float pixelsPerSecond){
+    dwellSpeed = pixelsPerSecond;
+}
+
+void BlobTracker::reset(){
+
+    tracks.clear();
+    filters.clear();
+
+}
+
+const vector<Track> & BlobTracker::getTracks() const{
+    return tracks;
+}
+
+
+
+void BlobTracker::predict(Filter & f, float dt){
+
+    float q = PROCESS_NOISE;
+
+    for(int a = 0; a < 2; a++){
+
+        f.p[a] += f.v[a] * dt;
+
+        //P = F P F' + Q for a constant velocity model
+        float pp = f.pp[a] + 2 * dt * f.pv[a] + dt * dt * f.vv[a] + q * dt * dt * dt / 3;
+        float pv = f.pv[a] + dt * f.vv[a] + q * dt * dt / 2;
+        float vv = f.vv[a] + q * dt;
+
+        f.pp[a] = pp;
+        f.pv[a] = pv;
+        f.vv[a] = vv;
+    }
+
+}
+
+void BlobTracker::correct(Filter & f, const ofVec2f & measured){
+
+    float z[2] = { measured.x, measured.y };
+
+    for(int a = 0; a < 2; a++){
+
+        float s = f.pp[a] + MEASUREMENT_NOISE;
+        float kp = f.pp[a] / s;
+        float kv = f.pv[a] / s;
+
+        float innovation = z[a] - f.p[a];
+
+        f.p[a] += kp * innovation;
+        f.v[a] += kv * innovation;
+
+        float pp = (1 - kp) * f.pp[a];
+        float pv = (1 - kp) * f.pv[a];
+        float vv = f.vv[a] - kv * f.pv[a];
+
+        f.pp[a] = pp;
+        f.pv[a] = pv;
+        f.vv[a] = vv;
+    }
+
+}
+
+
+
+//Hungarian algorithm with potentials, rows <= cols.
+//Cost is row major, match[row] = col
+void BlobTracker::solve(const vector<float> & cost, int rows, int cols, vector<int> & match){
+
+    vector<double> &u = solveU, &v = solveV, &minv = solveMinV;
+    vector<int> &p = solveP, &way = solveWay;
+    vector<bool> &used = solveUsed;
+
+    u.assign(rows + 1, 0);
+    v.assign(cols + 1, 0);
+    p.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+
+    for(int i = 1; i <= rows; i++){
+
+        p[0] = i;
+        int j0 = 0;
+
+        minv.assign(cols + 1, std::numeric_limits<double>::max());
+        used.assign(cols + 1, false);
+
+        do{
+            used[j0] = true;
+
+            int i0 = p[j0];
+            int j1 = 0;
+            double delta = std::numeric_limits<double>::max();
+
+            for(int j = 1; j <= cols; j++){
+
+                if( used[j] ) continue;
+
+                double cur = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+
+                if( cur < minv[j] ){
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+
+                if( minv[j] < delta ){
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+
+            for(int j = 0; j <= cols; j++){
+                if( used[j] ){
+                    u[ p[j] ] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+
+        } while( p[j0] != 0 );
+
+        do{
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while( j0 );
+
+    }
+
+    match.assign(rows, -1);
+
+    for(int j = 1; j <= cols; j++){
+        if( p[j] != 0 ) match[ p[j] - 1 ] = j - 1;
+    }
+
+}
+
+
+
+//back to -1 for the next cluster, only touching its own entries
+void BlobTracker::clearLocal(){
+
+    for(int i = 0; i < localTracks.size(); i++) trackLocal[ localTracks[i] ] = -1;
+    for(int i = 0; i < localBlobs.size(); i++) blobLocal[ localBlobs[i] ] = -1;
+
+}
+
+
+
+void BlobTracker::update(const vector<Blob> & blobs, float dt){
+
+    //keep the filter sane across hiccups and the first frame
+    dt = ofClamp(dt, 1/240.0f, 0.5f);
+
+    int numTracks = tracks.size();
+    int numBlobs = blobs.size();
+
+    float gate2 = maxDistance * maxDistance;
+
+
+    //----------PREDICT----------
+    for(int t = 0; t < numTracks; t++){
+        predict(filters[t], dt);
+    }
+
+
+    //----------GATE----------
+    //bucket the detections into gate sized cells so each track
+    //only looks at the 3x3 cells around its prediction
+    pairs.clear();
+
+    if( numTracks > 0 && numBlobs > 0 ){
+
+        float minX = blobs[0].centroid.x, maxX = minX;
+        float minY = blobs[0].centroid.y, maxY = minY;
+
+        for(int b = 1; b < numBlobs; b++){
+            minX = std::min(minX, blobs[b].centroid.x);
+            maxX = std::max(maxX, blobs[b].centroid.x);
+            minY = std::min(minY, blobs[b].centroid.y);
+            maxY = std::max(maxY, blobs[b].centroid.y);
+        }
+
+        float cellSize = std::max( maxDistance, std::max(maxX - minX, maxY - minY) / MAX_GRID_CELLS );
+
+        int cellsX = (int)((maxX - minX) / cellSize) + 1;
+        int cellsY = (int)((maxY - minY) / cellSize) + 1;
+
+        cellStart.assign(cellsX * cellsY + 1, 0);
+        cellItems.resize(numBlobs);
+        blobCell.resize(numBlobs);
+
+        for(int b = 0; b < numBlobs; b++){
+            int cx = (blobs[b].centroid.x - minX) / cellSize;
+            int cy = (blobs[b].centroid.y - minY) / cellSize;
+            blobCell[b] = cy * cellsX + cx;
+            cellStart[ blobCell[b] + 1 ]++;
+        }
+
+        for(int c = 0; c < cellsX * cellsY; c++){
+            cellStart[c + 1] += cellStart[c];
+        }
+
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+
+        for(int b = 0; b < numBlobs; b++){
+            cellItems[ cellFill[ blobCell[b] ]++ ] = b;
+        }
+
+        for(int t = 0; t < numTracks; t++){
+
+            ofVec2f predicted(filters[t].p[0], filters[t].p[1]);
+
+            int cx = floor( (predicted.x - minX) / cellSize );
+            int cy = floor( (predicted.y - minY) / cellSize );
+
+            for(int y = std::max(0, cy - 1); y <= std::min(cellsY - 1, cy + 1); y++){
+                for(int x = std::max(0, cx - 1); x <= std::min(cellsX - 1, cx + 1); x++){
+
+                    int c = y * cellsX + x;
+
+                    for(int k = cellStart[c]; k < cellStart[c + 1]; k++){
+
+                        int b = cellItems[k];
+                        float d2 = predicted.squareDistance(blobs[b].centroid);
+
+                        if( d2 < gate2 ){
+                            Pair pr = { t, b, d2 };
+                            pairs.push_back(pr);
+                        }
+                    }
+
+                }
+            }
+
+        }
+
+    }
+
+
+    //----------ASSIGN----------
+    //tracks are nodes 0..numTracks-1, blobs come after them.
+    //Anything connected by a gated pair is one cluster
+    trackMatch.assign(numTracks, -1);
+    blobMatch.assign(numBlobs, -1);
+
+    clusterParent.resize(numTracks + numBlobs);
+
+    for(int i = 0; i < clusterParent.size(); i++){
+        clusterParent[i] = i;
+    }
+
+    for(int i = 0; i < pairs.size(); i++){
+
+        int a = findRoot(clusterParent, pairs[i].track);
+        int b = findRoot(clusterParent, numTracks + pairs[i].blob);
+
+        if( a != b ) clusterParent[ std::max(a, b) ] = std::min(a, b);
+    }
+
+    //pairs grouped by cluster. Every cluster has a track in it
+    //and tracks come first, so the root is always a track
+    clusterStart.assign(numTracks + 1, 0);
+    clusterItems.resize(pairs.size());
+
+    for(int i = 0; i < pairs.size(); i++){
+        clusterStart[ findRoot(clusterParent, pairs[i].track) + 1 ]++;
+    }
+
+    for(int t = 0; t < numTracks; t++){
+        clusterStart[t + 1] += clusterStart[t];
+    }
+
+    cellFill.assign(clusterStart.begin(), clusterStart.end() - 1);
+
+    for(int i = 0; i < pairs.size(); i++){
+        clusterItems[ cellFill[ findRoot(clusterParent, pairs[i].track) ]++ ] = i;
+    }
+
+    trackLocal.assign(numTracks, -1);
+    blobLocal.assign(numBlobs, -1);
+
+    for(int root = 0; root < numTracks; root++){
+
+        const int *clusterPairs = clusterItems.data() + clusterStart[root];
+        int numClusterPairs = clusterStart[root + 1] - clusterStart[root];
+
+        if( numClusterPairs == 0 ) continue;
+
+        //the one everyone hopes for: one track, one blob
+        if( numClusterPairs == 1 ){
+            const Pair &pr = pairs[ clusterPairs[0] ];
+            trackMatch[pr.track] = pr.blob;
+            blobMatch[pr.blob] = pr.track;
+            continue;
+        }
+
+        //local indices for the cluster's tracks and blobs
+        localTracks.clear();
+        localBlobs.clear();
+
+        for(int i = 0; i < numClusterPairs; i++){
+
+            const Pair &pr = pairs[ clusterPairs[i] ];
+
+            if( trackLocal[pr.track] == -1 ){
+                trackLocal[pr.track] = localTracks.size();
+                localTracks.push_back(pr.track);
+            }
+
+            if( blobLocal[pr.blob] == -1 ){
+                blobLocal[pr.blob] = localBlobs.size();
+                localBlobs.push_back(pr.blob);
+            }
+        }
+
+        int rows = localTracks.size();
+        int numLocalBlobs = localBlobs.size();
+
+        if( rows > MAX_CLUSTER || numLocalBlobs > MAX_CLUSTER ){
+
+            //too big to solve every frame, take the closest pairs first
+            vector<Pair> &sorted = sortedPairs;
+            sorted.clear();
+
+            for(int i = 0; i < numClusterPairs; i++){
+                sorted.push_back( pairs[ clusterPairs[i] ] );
+            }
+
+            std::sort(sorted.begin(), sorted.end(), [](const Pair & a, const Pair & b){ return a.cost < b.cost; });
+
+            for(int i = 0; i < sorted.size(); i++){
+                if( trackMatch[sorted[i].track] == -1 && blobMatch[sorted[i].blob] == -1 ){
+                    trackMatch[sorted[i].track] = sorted[i].blob;
+                    blobMatch[sorted[i].blob] = sorted[i].track;
+                }
+            }
+
+            clearLocal();
+            continue;
+        }
+
+        //one extra "no match" column per track, costing as much as a
+        //detection right at the edge of the gate
+        int cols = numLocalBlobs + rows;
+
+        cost.assign(rows * cols, NO_MATCH_COST);
+
+        for(int r = 0; r < rows; r++){
+            for(int c = numLocalBlobs; c < cols; c++){
+                cost[r * cols + c] = gate2;
+            }
+        }
+
+        for(int i = 0; i < numClusterPairs; i++){
+            const Pair &pr = pairs[ clusterPairs[i] ];
+            cost[ trackLocal[pr.track] * cols + blobLocal[pr.blob] ] = pr.cost;
+        }
+
+        solve(cost, rows, cols, match);
+
+        for(int r = 0; r < rows; r++){
+
+            if( match[r] < 0 || match[r] >= numLocalBlobs ) continue;
+
+            int t = localTracks[r];
+            int b = localBlobs[ match[r] ];
+
+            trackMatch[t] = b;
+            blobMatch[b] = t;
+        }
+
+        clearLocal();
+
+    }
+
+
+    //----------UPDATE TRACKS----------
+    vector<Track> &kept = keptTracks;
+
+    kept.clear();
+    keptFilters.clear();
+
+    for(int t = 0; t < numTracks; t++){
+
+        Track &tr = tracks[t];
+        Filter &f = filters[t];
+
+        int b = trackMatch[t];
+
+        if( b != -1 ){
+            correct(f, blobs[b].centroid);
+            tr.blobIndex = b;
+            tr.bbox = blobs[b].bbox;
+            tr.area = blobs[b].area;
+            tr.missed = 0;
+        } else {
+            tr.blobIndex = -1;
+            tr.missed++;
+        }
+
+        //out of patience
+        if( tr.missed > persistence ) continue;
+
+        tr.pos.set(f.p[0], f.p[1]);
+        tr.vel.set(f.v[0], f.v[1]);
+        tr.age++;
+
+        tr.bDwelling = tr.vel.length() < dwellSpeed;
+        tr.dwellTime = tr.bDwelling ? tr.dwellTime + dt : 0;
+
+        tr.predictedPos = tr.pos;
+        tr.predictionLead = 0;
+
+        kept.push_back(tr);
+        keptFilters.push_back(f);
+
+    }
+
+
+    //----------NEW TRACKS----------
+    for(int b = 0; b < numBlobs; b++){
+
+        if( blobMatch[b] != -1 ) continue;
+
+        Track tr;
+        tr.id = nextId++;
+        tr.pos = blobs[b].centroid;
+        tr.vel.set(0, 0);
+        tr.blobIndex = b;
+        tr.bbox = blobs[b].bbox;
+        tr.area = blobs[b].area;
+        tr.age = 1;
+        tr.missed = 0;
+        tr.dwellTime = 0;
+        tr.bDwelling = false;
+        tr.predictedPos = tr.pos;
+        tr.predictionLead = 0;
+
+        Filter f;
+
+        for(int a = 0; a < 2; a++){
+            f.p[a] = a == 0 ? tr.pos.x : tr.pos.y;
+            f.v[a] = 0;
+            f.pp[a] = MEASUREMENT_NOISE;
+            f.pv[a] = 0;
+            f.vv[a] = INITIAL_VELOCITY_VARIANCE;
+        }
+
+        kept.push_back(tr);
+        keptFilters.push_back(f);
+
+    }
+
+    tracks.swap(kept);
+    filters.swap(keptFilters);
+
+}
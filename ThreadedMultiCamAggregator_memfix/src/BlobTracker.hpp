@@ -0,0 +1,153 @@
+//
+//  BlobTracker.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef BlobTracker_hpp
+#define BlobTracker_hpp
+
+#include <stdio.h>
+
+#endif /* BlobTracker_hpp */
+
+#include "ofMain.h"
+#include "BlobLabeler.hpp"
+
+#pragma once
+
+
+struct Track{
+
+    int id;
+
+    //filtered position and velocity (pixels, pixels/second)
+    ofVec2f pos;
+    ofVec2f vel;
+
+    //latest detection, -1 if the track is coasting this frame
+    int blobIndex;
+    ofRectangle bbox;
+    int area;
+
+    int age;            //frames since the track started
+    int missed;         //frames in a row without a detection
+
+    //seconds spent moving slower than the dwell speed
+    float dwellTime;
+    bool bDwelling;
+
+    //where the track should be `predictionLead` seconds after
+    //its detection. Same as pos until the predict stage runs
+    ofVec2f predictedPos;
+    float predictionLead;
+
+};
+
+
+/*
+ * BlobTracker:
+ *  Keeps IDs on blobs from frame to frame.
+ *
+ *      -every track has a constant velocity Kalman filter per
+ *       axis that predicts where it should be this frame
+ *      -detections are only considered for a track if they fall
+ *       inside the gate (maxDistance pixels) around that
+ *       prediction, found through a grid so it's not N x M
+ *      -gated pairs split into independent clusters, and each
+ *       cluster is solved with the Hungarian algorithm, so the
+ *       total distance is the smallest possible instead of
+ *       whoever happens to be checked first
+ *      -unmatched tracks coast on their prediction for up to
+ *       `persistence` frames, unmatched detections start tracks
+ *
+ *  Clusters bigger than MAX_CLUSTER per side fall back to
+ *  greedy nearest pairs to keep the worst case bounded.
+ */
+
+class BlobTracker{
+
+public:
+
+    BlobTracker();
+
+    void setPersistence(int frames);
+    void setMaximumDistance(float pixels);
+
+    //below this many pixels/second a track counts as dwelling
+    void setDwellSpeed(float pixelsPerSecond);
+
+    //dt is the time since the previous update, in seconds
+    void update(const vector<Blob> & blobs, float dt);
+
+    void reset();
+
+    const vector<Track> & getTracks() const;
+
+    static const int MAX_CLUSTER = 64;
+
+
+private:
+
+    struct Filter{
+        //per axis: [position, velocity] and its covariance
+        float p[2], v[2];
+        float pp[2], pv[2], vv[2];
+    };
+
+    void predict(Filter & f, float dt);
+    void correct(Filter & f, const ofVec2f & measured);
+
+    //fills match[t] with the detection for each local track
+    //(or -1) from a rows x cols cost matrix
+    void solve(const vector<float> & cost, int rows, int cols, vector<int> & match);
+
+    void clearLocal();
+
+    vector<Track> tracks;
+    vector<Filter> filters;
+
+    int persistence;
+    float maxDistance;
+    float dwellSpeed;
+    int nextId;
+
+    //scratch, cleared every update and kept so that once
+    //they've grown to the busiest frame updates don't allocate
+    struct Pair{
+        int track, blob;
+        float cost;
+    };
+
+    vector<Pair> pairs;
+    vector<int> clusterParent;
+    vector<int> trackMatch;
+    vector<int> blobMatch;
+
+    //detections bucketed by gate sized cells
+    vector<int> cellStart;
+    vector<int> cellFill;
+    vector<int> cellItems;
+    vector<int> blobCell;
+
+    //pairs grouped by the track at the root of their cluster
+    vector<int> clusterStart;
+    vector<int> clusterItems;
+
+    //the cluster being solved, local <-> global indices.
+    //trackLocal/blobLocal are -1 outside of it
+    vector<int> localTracks, localBlobs;
+    vector<int> trackLocal, blobLocal;
+    vector<Pair> sortedPairs;
+    vector<float> cost;
+    vector<int> match;
+
+    //solve()
+    vector<double> solveU, solveV, solveMinV;
+    vector<int> solveP, solveWay;
+    vector<bool> solveUsed;
+
+    //tracks that survive this update
+    vector<Track> keptTracks;
+    vector<Filter> keptFilters;
+
+};
@@ -0,0 +1,72 @@
+//
+//  CachedTexture.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "CachedTexture.hpp"
+
+
+CachedTexture::Stats CachedTexture::stats = { 0, 0, 0, 0 };
+
+CachedTexture::CachedTexture(){
+
+    //generations start at 1
+    generation = 0;
+    channels = 0;
+
+}
+
+bool CachedTexture::update(const ofPixels & pix, uint64_t _generation){
+
+    if( !pix.isAllocated() ) return false;
+
+    size_t bytes = pix.getWidth() * pix.getHeight() * pix.getNumChannels();
+
+    if( _generation == generation && texture.isAllocated() ){
+        stats.skipped++;
+        stats.bytesSaved += bytes;
+        return false;
+    }
+
+    //a new size or format needs a new texture
+    if( !texture.isAllocated() || texture.getWidth() != pix.getWidth() || texture.getHeight() != pix.getHeight() || channels != pix.getNumChannels() ){
+        texture.allocate(pix);
+        channels = pix.getNumChannels();
+    }
+
+    texture.loadData(pix);
+
+    generation = _generation;
+
+    stats.uploads++;
+    stats.bytesUploaded += bytes;
+
+    return true;
+
+}
+
+void CachedTexture::draw(float x, float y) const{
+
+    if( texture.isAllocated() ){
+        texture.draw(x, y);
+    }
+
+}
+
+void CachedTexture::draw(const ofVec2f & pos) const{
+
+    draw(pos.x, pos.y);
+
+}
+
+bool CachedTexture::isAllocated() const{
+
+    return texture.isAllocated();
+
+}
+
+CachedTexture::Stats CachedTexture::getStats(){
+
+    return stats;
+
+}
@@ -0,0 +1,71 @@
+//
+//  CachedTexture.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef CachedTexture_hpp
+#define CachedTexture_hpp
+
+#include <stdio.h>
+
+#endif /* CachedTexture_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+//unique app-wide and thread safe. Whoever publishes an image
+//stamps it with a new one every time its pixels change
+inline uint64_t nextImageGeneration(){
+    static std::atomic<uint64_t> lastGeneration(0);
+    return ++lastGeneration;
+}
+
+
+/*
+ * CachedTexture:
+ *  A texture that remembers which generation of pixels it
+ *  holds. update() only uploads when the generation has
+ *  changed, so a view drawn at 200 fps uploads at the rate
+ *  its images actually change, and only while it's shown.
+ *
+ *  Every view keeps one per image it draws. Nothing touches
+ *  GL until the first update(), so headless never does.
+ */
+
+class CachedTexture{
+
+public:
+
+    CachedTexture();
+
+    //true if it had to upload. Pixels are read straight
+    //from pix, nothing is copied on the way
+    bool update(const ofPixels & pix, uint64_t generation);
+
+    void draw(float x, float y) const;
+    void draw(const ofVec2f & pos) const;
+
+    bool isAllocated() const;
+
+    //every CachedTexture so far, GL thread only
+    struct Stats{
+        uint64_t uploads;
+        uint64_t skipped;           //generation hadn't changed
+        uint64_t bytesUploaded;
+        uint64_t bytesSaved;        //what skipped would have copied + uploaded
+    };
+
+    static Stats getStats();
+
+
+private:
+
+    ofTexture texture;
+    uint64_t generation;
+    int channels;
+
+    static Stats stats;
+
+};
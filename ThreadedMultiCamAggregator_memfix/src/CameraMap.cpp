@@ -0,0 +1,81 @@
+//
+//  CameraMap.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "CameraMap.hpp"
+
+
+const int CameraMap::MAX_CAMERAS;
+const uint8_t CameraMap::NONE;
+
+CameraMap::CameraMap(){
+
+    width = 0;
+    height = 0;
+
+}
+
+ofRectangle CameraMap::getRegion(const ofVec2f & position, int rotation, int tileW, int tileH){
+
+    //odd quarter turns swap the sides
+    int rot = ((rotation % 4) + 4) % 4;
+
+    int regionW = rot % 2 == 0 ? tileW : tileH;
+    int regionH = rot % 2 == 0 ? tileH : tileW;
+
+    return ofRectangle(position.x, position.y, regionW, regionH);
+
+}
+
+void CameraMap::build(const vector<ofVec2f> & positions, const vector<int> & rotations, int tileW, int tileH, int w, int h){
+
+    width = w;
+    height = h;
+
+    owners.assign(width * height, NONE);
+
+    int numCameras = std::min((int)positions.size(), MAX_CAMERAS);
+
+    //same order as the composite, later tiles on top
+    for(int i = 0; i < numCameras; i++){
+
+        int rotation = i < rotations.size() ? rotations[i] : 0;
+        ofRectangle region = getRegion(positions[i], rotation, tileW, tileH);
+
+        int x0 = std::max(0, (int)region.x);
+        int y0 = std::max(0, (int)region.y);
+        int x1 = std::min(width, (int)(region.x + region.width));
+        int y1 = std::min(height, (int)(region.y + region.height));
+
+        if( x1 <= x0 ) continue;
+
+        for(int y = y0; y < y1; y++){
+            memset(&owners[y * width + x0], i, x1 - x0);
+        }
+
+    }
+
+}
+
+bool CameraMap::isAllocated() const{
+    return width > 0 && height > 0;
+}
+
+int CameraMap::getWidth() const{
+    return width;
+}
+
+int CameraMap::getHeight() const{
+    return height;
+}
+
+int CameraMap::getCamera(int x, int y) const{
+
+    if( x < 0 || y < 0 || x >= width || y >= height ) return -1;
+
+    uint8_t owner = owners[y * width + x];
+
+    return owner == NONE ? -1 : owner;
+
+}
@@ -0,0 +1,61 @@
+//
+//  CameraMap.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef CameraMap_hpp
+#define CameraMap_hpp
+
+#include <stdio.h>
+
+#endif /* CameraMap_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * CameraMap:
+ *  Which camera every pixel of the composite came from, built
+ *  from the stitching layout whenever it changes.
+ *
+ *  Tiles are placed with their rotation the same way the
+ *  composite pastes them, and where they overlap the one
+ *  pasted last owns the pixel, since that's what ends up
+ *  on top. Any number of cameras (up to MAX_CAMERAS) and any
+ *  rotation, and a lookup is a single read. Never modified
+ *  after being sent, ofApp makes a new one on edits.
+ */
+
+class CameraMap{
+
+public:
+
+    CameraMap();
+
+    //tileW x tileH is one camera before rotation, rotations
+    //are in quarter turns like ofPixels::rotate90
+    void build(const vector<ofVec2f> & positions, const vector<int> & rotations, int tileW, int tileH, int w, int h);
+
+    bool isAllocated() const;
+    int getWidth() const;
+    int getHeight() const;
+
+    //camera that owns the pixel, -1 if none or off the map
+    int getCamera(int x, int y) const;
+
+    //where a camera ends up in the composite
+    static ofRectangle getRegion(const ofVec2f & position, int rotation, int tileW, int tileH);
+
+    static const int MAX_CAMERAS = 255;
+    static const uint8_t NONE = 255;
+
+
+private:
+
+    int width, height;
+
+    vector<uint8_t> owners;
+
+};
@@ -0,0 +1,115 @@
+//
+//  CpuMeter.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "CpuMeter.hpp"
+
+#include <sys/resource.h>
+#include <time.h>
+
+
+std::atomic<uint64_t> CpuMeter::workerCpuTime(0);
+
+CpuMeter::CpuMeter(){
+
+    interval = 5.0f;
+
+    lastWallTime = 0;
+    lastCpuTime = 0;
+    loops = 0;
+
+    cpu = 0;
+    loopRate = 0;
+
+}
+
+void CpuMeter::setup(float _interval){
+
+    interval = _interval;
+
+    lastWallTime = ofGetElapsedTimeMicros();
+    lastCpuTime = getCpuTime();
+    loops = 0;
+
+}
+
+bool CpuMeter::update(){
+
+    loops++;
+
+    uint64_t now = ofGetElapsedTimeMicros();
+
+    if( now - lastWallTime < interval * 1000000 ) return false;
+
+    uint64_t cpuTime = getCpuTime();
+
+    cpu = 100.0f * (cpuTime - lastCpuTime) / (float)(now - lastWallTime);
+    loopRate = loops * 1000000.0f / (now - lastWallTime);
+
+    lastWallTime = now;
+    lastCpuTime = cpuTime;
+    loops = 0;
+
+    return true;
+
+}
+
+float CpuMeter::getCpu() const{
+    return cpu;
+}
+
+float CpuMeter::getLoopRate() const{
+    return loopRate;
+}
+
+float CpuMeter::getPeakMemory() const{
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    //bytes on macOS, KB on Linux
+#ifdef TARGET_OSX
+    return usage.ru_maxrss / (1024.0f * 1024.0f);
+#else
+    return usage.ru_maxrss / 1024.0f;
+#endif
+
+}
+
+string CpuMeter::getReport() const{
+
+    return "CPU: " + ofToString(cpu, 1) + "% of one core, loop: " + ofToString(loopRate, 1) + " fps, peak memory: " + ofToString(getPeakMemory(), 1) + " MB";
+
+}
+
+uint64_t CpuMeter::getCpuTime(){
+
+    //all threads of the process
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+
+}
+
+uint64_t CpuMeter::getThreadCpuTime(){
+
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec/1000;
+
+}
+
+void CpuMeter::addWorkerCpuTime(uint64_t micros){
+
+    workerCpuTime.fetch_add(micros, std::memory_order_relaxed);
+
+}
+
+uint64_t CpuMeter::getWorkerCpuTime(){
+
+    return workerCpuTime.load(std::memory_order_relaxed);
+
+}
@@ -0,0 +1,72 @@
+//
+//  CpuMeter.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef CpuMeter_hpp
+#define CpuMeter_hpp
+
+#include <stdio.h>
+
+#endif /* CpuMeter_hpp */
+
+#include "ofMain.h"
+#include <atomic>
+
+#pragma once
+
+
+/*
+ * CpuMeter:
+ *  CPU time of the whole process (every thread, user +
+ *  system) per second of wall time, so the windowed and
+ *  the headless runtime can be compared on the same
+ *  machine with the same cameras.
+ *
+ *  100% = one core busy. Call update() once per loop, it
+ *  takes a new reading every `interval` seconds.
+ */
+
+class CpuMeter{
+
+public:
+
+    CpuMeter();
+
+    void setup(float interval);
+
+    //true when there's a new reading
+    bool update();
+
+    float getCpu() const;           //% of one core
+    float getLoopRate() const;      //update() calls per second
+    float getPeakMemory() const;    //MB, resident
+
+    string getReport() const;
+
+    //CPU time of the calling thread only, micros
+    static uint64_t getThreadCpuTime();
+
+    //band worker threads add the CPU time of each job they
+    //run here, so whoever handed the jobs out (StageGraph)
+    //can count it as theirs. Total since startup, micros
+    static void addWorkerCpuTime(uint64_t micros);
+    static uint64_t getWorkerCpuTime();
+
+
+private:
+
+    static uint64_t getCpuTime();   //micros
+
+    static std::atomic<uint64_t> workerCpuTime;
+
+    float interval;
+
+    uint64_t lastWallTime;
+    uint64_t lastCpuTime;
+    int loops;
+
+    float cpu;
+    float loopRate;
+
+};
@@ -24,10 +24,13 @@ void Feed::setup(int num, int _id, int w, int h){
     camWidth = w;
     camHeight = h;
     
-    rawImg.allocate(camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
-//    rawPix.allocate(camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
+    rawPix.allocate(camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
+    rawPix.setColor(0);
     grayPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
     
+    rawGeneration = nextImageGeneration();
+    grayGeneration = nextImageGeneration();
+    
     
     blackPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
     blackPix.setColor(0);
@@ -35,34 +38,34 @@ void Feed::setup(int num, int _id, int w, int h){
     pixelStats.setup(camNum);
     bDropThisFrame = false;
     
-
-    img.setFromPixels(blackPix.getData(), camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    
     //give reference to the pixel object the thread will fill
-    threadedCV.setup( &grayPix );
+    threadedCV.setup( camNum, &grayPix, &threshPix, &foregroundPix, &backgroundPix );
     
 }
 
 
-void Feed::newFrame( ofPixels &raw ){
+void Feed::newFrame( ofPixels &raw, uint64_t captureTime, const Settings &s ){
 
-    rawImg.getPixels() = raw;
-    rawImg.update();
-    
-//    rawPix = raw;
-//    grayPix = gray;
+    rawPix = raw;
+    rawGeneration = nextImageGeneration();
     
     
     vector<int> settings;
-    settings.resize(3);
-    settings[0] = *blurAmt;
-    settings[1] = (*contrastExp) * 1000;
-    settings[2] = (*contrastPhase) * 1000;
+    settings.resize(PreCompositeThreadCV::NUM_SETTINGS);
+    settings[PreCompositeThreadCV::SETTING_BLUR] = s.blurAmt;
+    settings[PreCompositeThreadCV::SETTING_CONTRAST_EXP] = s.contrastExp * 1000;
+    settings[PreCompositeThreadCV::SETTING_CONTRAST_SHIFT] = s.contrastPhase * 1000;
+    settings[PreCompositeThreadCV::SETTING_BG_DIFF] = s.useBgDiff && s.usePerCameraBg;
+    settings[PreCompositeThreadCV::SETTING_THRESHOLD] = s.threshold;
+    settings[PreCompositeThreadCV::SETTING_LEARNING_TIME] = s.learningTime;
+    settings[PreCompositeThreadCV::SETTING_SELECTIVE] = s.selectiveLearning;
+    settings[PreCompositeThreadCV::SETTING_BG_MODEL] = s.useMultiModalBg ? BackgroundModel::MULTI_MODAL : BackgroundModel::RUNNING_AVERAGE;
+    settings[PreCompositeThreadCV::SETTING_BG_RESET] = s.resetBackground;
 
     
     //tell the thread to analyze the frame
     //ofApp will update the thread and that will fill grayPix
-    threadedCV.analyze( raw, settings );
+    threadedCV.analyze( raw, settings, captureTime );
     
 //    adjustContrast( &grayPix , (*contrastExp), (*contrastPhase) );
 
@@ -80,10 +83,10 @@ void Feed::newFrame( ofPixels &raw ){
     
 //    cout << "Cam " << " last frame time: " << lastFrameTime << endl;
     
-    if( *stdDevToggle ){
+    if( s.stdDevToggle ){
         
-        pixelStats.setStdDevThresh( *stdDevThresh );
-        pixelStats.setAvgPixThresh( *avgPixThresh );
+        pixelStats.setStdDevThresh( s.stdDevThresh );
+        pixelStats.setAvgPixThresh( s.avgPixThresh );
         pixelStats.analyze( &grayPix );
         
         if( pixelStats.bDataIsBad ){
@@ -106,7 +109,9 @@ void Feed::update(){
     
     timeSinceLastFrame = ofGetElapsedTimef() - lastFrameTime;
     
-    threadedCV.update();
+    if( threadedCV.update() ){
+        grayGeneration = nextImageGeneration();
+    }
     
 }
 
@@ -122,15 +127,58 @@ ofPixels Feed::getOutputPix(){
     
 }
 
-void Feed::resetAllPixels(){
+ofPixels Feed::getThreshPix(){
+    
+    if( bDropThisFrame || !threshPix.isAllocated() ){
+        return blackPix;
+    } else {
+        return threshPix;
+    }
+    
+}
+
+ofPixels Feed::getForegroundPix(){
+    
+    if( bDropThisFrame || !foregroundPix.isAllocated() ){
+        return blackPix;
+    } else {
+        return foregroundPix;
+    }
+    
+}
+
+ofPixels Feed::getBackgroundPix(){
+    
+    //the background is still valid on a dropped frame
+    if( !backgroundPix.isAllocated() ){
+        return blackPix;
+    } else {
+        return backgroundPix;
+    }
     
-//    rawPix = blackPix;
-    rawImg.getPixels() = blackPix;
-    rawImg.update();
+}
+
+void Feed::seedBackground(const ofPixels & seed){
+    
+    threadedCV.seedBackground(seed);
     
+}
+
+uint64_t Feed::getCaptureTime(){
+    
+    return threadedCV.captureTime;
+    
+}
+
+void Feed::resetAllPixels(){
+    
+    rawPix.setColor(0);
     grayPix = blackPix;
+    threshPix.clear();
+    foregroundPix.clear();
     
-    img.setFromPixels(blackPix.getData(), camWidth, camHeight, OF_IMAGE_GRAYSCALE);
+    rawGeneration = nextImageGeneration();
+    grayGeneration = nextImageGeneration();
     
 }
 
@@ -159,10 +207,8 @@ void Feed::drawRaw( int x, int y ){
     ofDrawBitmapString("Cam " + ofToString(camNum) + " FR: "  + fr + "\nTime since last frame: " + ofToString(timeSinceLastFrame), x, y-5);
 
     
-//    img.setFromPixels(rawPix.getData(), camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
-//    img.draw(x, y);
-
-    rawImg.draw(x, y + 10);
+    rawTexture.update(rawPix, rawGeneration);
+    rawTexture.draw(x, y + 10);
     
     ofNoFill();
     ofDrawRectangle(x, y + 10, camWidth, camHeight);
@@ -186,17 +232,11 @@ void Feed::drawRawAndProcessed(int x, int y){
     ofDrawBitmapString("Cam " + ofToString(camNum) + " FR: "  + fr + ", Time since last frame: " + ofToString(timeSinceLastFrame), x, y-5);
     
     
-    rawImg.draw(x, y);
+    rawTexture.update(rawPix, rawGeneration);
+    rawTexture.draw(x, y);
     
-//    if( rawPix.isAllocated() ){
-//        img.setFromPixels(rawPix.getData(), camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
-//        img.draw(x, y);
-//    }
-    
-    if( grayPix.isAllocated() ){
-        img.setFromPixels(grayPix.getData(), camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-        img.draw(x + camWidth, y);        
-    }
+    grayTexture.update(grayPix, grayGeneration);
+    grayTexture.draw(x + camWidth, y);
     
     ofNoFill();
     ofDrawRectangle(x, y, camWidth * 2, camHeight);
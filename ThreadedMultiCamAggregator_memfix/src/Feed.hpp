@@ -15,13 +15,16 @@
 
 #include "ofMain.h"
 #include "PixelStatistics.hpp"
-#include "ofxGui.h"
 #include "PreCompositeThreadCV.hpp"
+#include "CachedTexture.hpp"
 
 
 #pragma once
 
 
+#define TOTAL_NUM_CAMS 7
+
+
 class Feed{
     
 public:
@@ -30,8 +33,29 @@ public:
     //make a dummy copy constructor
     Feed(const Feed &f);
     
+    //what newFrame() needs from the gui (or the settings
+    //files when there's no gui), plain values so a
+    //windowless build doesn't need ofxGui
+    struct Settings{
+        int blurAmt;
+        float contrastExp;
+        float contrastPhase;
+
+        int stdDevThresh;       //this camera's
+        int avgPixThresh;
+        bool stdDevToggle;
+
+        bool useBgDiff;
+        bool usePerCameraBg;
+        int threshold;
+        int learningTime;
+        bool selectiveLearning;
+        bool useMultiModalBg;
+        bool resetBackground;
+    };
+    
     void setup(int num, int _id, int w, int h);
-    void newFrame(ofPixels &raw);
+    void newFrame(ofPixels &raw, uint64_t captureTime, const Settings &s);
     void update();
     void adjustContrast( ofPixels *pix, float exp, float phase);
     void setValsFromGui(float exp, float phase, float stdDev);
@@ -40,6 +64,17 @@ public:
     void drawRawAndProcessed(int x, int y);
     ofPixels getOutputPix();
     
+    //per-camera background subtraction output, tile coordinates.
+    //Black until the first result comes back (or if dropped)
+    ofPixels getThreshPix();
+    ofPixels getForegroundPix();
+    ofPixels getBackgroundPix();
+    
+    void seedBackground(const ofPixels & seed);
+    
+    //capture time (ofGetElapsedTimeMicros) of what getOutputPix() returns
+    uint64_t getCaptureTime();
+    
     void resetAllPixels();
     
     PreCompositeThreadCV threadedCV;
@@ -49,23 +84,21 @@ public:
     int camNum;
     
     
-    //gui values
-    ofxIntSlider *blurAmt;
-    ofxFloatSlider *contrastExp;
-    ofxFloatSlider *contrastPhase;
-    
-    ofxIntSlider *stdDevThresh;
-    ofxIntSlider *avgPixThresh;
-    ofxToggle *stdDevToggle;
-    
-    
     int camWidth, camHeight;
     
-    ofImage rawImg;
-//    ofPixels rawPix;
+    ofPixels rawPix;
     ofPixels grayPix;
+    ofPixels threshPix;
+    ofPixels foregroundPix;
+    ofPixels backgroundPix;
     ofPixels blackPix;
-    ofImage img;
+    
+    //bumped whenever rawPix/grayPix change. The textures
+    //only upload when they're drawn and these have moved
+    uint64_t rawGeneration;
+    uint64_t grayGeneration;
+    CachedTexture rawTexture;
+    CachedTexture grayTexture;
     
     float camFrameRate, lastFrameRate;
     float lastFrameTime, timeSinceLastFrame;
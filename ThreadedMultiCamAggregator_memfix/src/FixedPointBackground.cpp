@@ -0,0 +1,262 @@
+//
+//  FixedPointBackground.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "FixedPointBackground.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+FixedPointBackground::FixedPointBackground(){
+
+    width = 0;
+    height = 0;
+    bNeedsReset = true;
+
+    learningTime = 100;
+    threshold = 26;
+    bSelective = false;
+
+    updateWeights();
+
+}
+
+BackgroundModel::Type FixedPointBackground::getType() const{
+    return RUNNING_AVERAGE;
+}
+
+string FixedPointBackground::getName() const{
+    return "Running average";
+}
+
+void FixedPointBackground::setLearningTime(float frames){
+
+    if( frames != learningTime ){
+        learningTime = frames;
+        updateWeights();
+    }
+
+}
+
+void FixedPointBackground::setThresholdValue(int t){
+
+    t = ofClamp(t, 0, 255);
+
+    if( t != threshold ){
+        threshold = t;
+        updateWeights();
+    }
+
+}
+
+void FixedPointBackground::setSelectiveLearning(bool b){
+    bSelective = b;
+}
+
+void FixedPointBackground::updateWeights(){
+
+    //same rate RunningBackground derives from its learning time:
+    //a change of one threshold is absorbed after learningTime frames
+    float rate = 1.0f;
+
+    if( learningTime > 0 ){
+        rate = 1.0f - powf(1.0f - threshold/255.0f, 1.0f/learningTime);
+    }
+
+    //both weights have to fit in 16 bits
+    int a = ofClamp( (int)roundf(rate * 65536.0f), 1, 65535 );
+
+    alpha = a;
+    inverse = 65536 - a;
+
+}
+
+void FixedPointBackground::reset(){
+    bNeedsReset = true;
+}
+
+void FixedPointBackground::setBackground(const ofPixels & bg){
+
+    width = bg.getWidth();
+    height = bg.getHeight();
+
+    const uint8_t *b = bg.getData();
+    int step = bg.getNumChannels();
+
+    accumulator.resize(width * height);
+
+    for(int i = 0; i < width * height; i++){
+        accumulator[i] = (b[i * step] << 8) | 0x80;
+    }
+
+    bNeedsReset = false;
+
+}
+
+bool FixedPointBackground::isAllocated() const{
+    return !accumulator.empty();
+}
+
+int FixedPointBackground::getWidth() const{
+    return width;
+}
+
+int FixedPointBackground::getHeight() const{
+    return height;
+}
+
+const vector<uint16_t> & FixedPointBackground::getAccumulator() const{
+    return accumulator;
+}
+
+size_t FixedPointBackground::getMemoryUsage() const{
+    return accumulator.size() * sizeof(uint16_t);
+}
+
+
+
+void FixedPointBackground::update(const ofPixels & src, ofPixels & thresh, ofPixels * foreground, ofPixels * background, const ofPixels * freezeMask){
+
+    int w = src.getWidth();
+    int h = src.getHeight();
+
+    if( w != width || h != height ){
+        width = w;
+        height = h;
+        accumulator.assign(w * h, 0);
+        bNeedsReset = true;
+    }
+
+    //start from the current frame. Pixel values sit in the
+    //middle of their 8.8 step so rounding can go both ways
+    if( bNeedsReset ){
+
+        const uint8_t *s = src.getData();
+
+        for(int i = 0; i < w * h; i++){
+            accumulator[i] = (s[i] << 8) | 0x80;
+        }
+
+        bNeedsReset = false;
+    }
+
+    if( thresh.getWidth() != w || thresh.getHeight() != h || thresh.getNumChannels() != 1 ){
+        thresh.allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    if( foreground && (foreground -> getWidth() != w || foreground -> getHeight() != h || foreground -> getNumChannels() != 1) ){
+        foreground -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    if( background && (background -> getWidth() != w || background -> getHeight() != h || background -> getNumChannels() != 1) ){
+        background -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    //mask has to line up pixel for pixel to be usable
+    if( freezeMask && (freezeMask -> getWidth() != w || freezeMask -> getHeight() != h || freezeMask -> getNumChannels() != 1) ){
+        freezeMask = NULL;
+    }
+
+    //rows are contiguous for grayscale so do it all as one long row
+    updateRow(src.getData(),
+              accumulator.data(),
+              thresh.getData(),
+              foreground ? foreground -> getData() : NULL,
+              background ? background -> getData() : NULL,
+              freezeMask ? freezeMask -> getData() : NULL,
+              w * h);
+
+}
+
+
+
+void FixedPointBackground::updateRow(const uint8_t * src, uint16_t * acc, uint8_t * thresh, uint8_t * fg, uint8_t * bg, const uint8_t * freeze, int n) const{
+
+    int i = 0;
+
+#ifdef __SSE2__
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(0x80);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i vAlpha = _mm_set1_epi16( (short)alpha );
+    const __m128i vInverse = _mm_set1_epi16( (short)inverse );
+    const __m128i vThresh = _mm_set1_epi8( (char)threshold );
+    const __m128i allOn = _mm_set1_epi8( (char)0xFF );
+    const __m128i selective = bSelective ? allOn : zero;
+
+    for(; i + 16 <= n; i += 16){
+
+        __m128i s = _mm_loadu_si128( (const __m128i*)(src + i) );
+        __m128i accLo = _mm_loadu_si128( (const __m128i*)(acc + i) );
+        __m128i accHi = _mm_loadu_si128( (const __m128i*)(acc + i + 8) );
+
+        //background is the integer part of the accumulator
+        __m128i b = _mm_packus_epi16( _mm_srli_epi16(accLo, 8), _mm_srli_epi16(accHi, 8) );
+
+        //BRIGHTER difference, then fg > threshold
+        __m128i f = _mm_subs_epu8(s, b);
+        __m128i t = _mm_andnot_si128( _mm_cmpeq_epi8( _mm_subs_epu8(f, vThresh), zero ), allOn );
+
+        _mm_storeu_si128( (__m128i*)(thresh + i), t );
+        if( fg ) _mm_storeu_si128( (__m128i*)(fg + i), f );
+        if( bg ) _mm_storeu_si128( (__m128i*)(bg + i), b );
+
+        //frame in 8.8: (s << 8) | 0x80
+        __m128i targetLo = _mm_or_si128( _mm_unpacklo_epi8(zero, s), half );
+        __m128i targetHi = _mm_or_si128( _mm_unpackhi_epi8(zero, s), half );
+
+        //acc * (1 - a) + frame * a, each product keeps its top 16 bits
+        __m128i newLo = _mm_adds_epu16( _mm_add_epi16( _mm_mulhi_epu16(accLo, vInverse), _mm_mulhi_epu16(targetLo, vAlpha) ), one );
+        __m128i newHi = _mm_adds_epu16( _mm_add_epi16( _mm_mulhi_epu16(accHi, vInverse), _mm_mulhi_epu16(targetHi, vAlpha) ), one );
+
+        //pixels that keep their old background
+        __m128i keep = _mm_and_si128(t, selective);
+
+        if( freeze ){
+            __m128i m = _mm_loadu_si128( (const __m128i*)(freeze + i) );
+            keep = _mm_or_si128( keep, _mm_andnot_si128( _mm_cmpeq_epi8(m, zero), allOn ) );
+        }
+
+        __m128i keepLo = _mm_unpacklo_epi8(keep, keep);
+        __m128i keepHi = _mm_unpackhi_epi8(keep, keep);
+
+        newLo = _mm_or_si128( _mm_and_si128(keepLo, accLo), _mm_andnot_si128(keepLo, newLo) );
+        newHi = _mm_or_si128( _mm_and_si128(keepHi, accHi), _mm_andnot_si128(keepHi, newHi) );
+
+        _mm_storeu_si128( (__m128i*)(acc + i), newLo );
+        _mm_storeu_si128( (__m128i*)(acc + i + 8), newHi );
+
+    }
+
+#endif
+
+    //whatever is left over (or everything without SSE2)
+    for(; i < n; i++){
+
+        uint8_t s = src[i];
+        uint8_t b = acc[i] >> 8;
+        uint8_t f = s > b ? s - b : 0;
+        uint8_t t = f > threshold ? 255 : 0;
+
+        thresh[i] = t;
+        if( fg ) fg[i] = f;
+        if( bg ) bg[i] = b;
+
+        bool keep = (bSelective && t) || (freeze && freeze[i]);
+
+        if( !keep ){
+
+            uint32_t target = (s << 8) | 0x80;
+            uint32_t blended = ((acc[i] * (uint32_t)inverse) >> 16) + ((target * (uint32_t)alpha) >> 16) + 1;
+
+            acc[i] = std::min(blended, (uint32_t)65535);
+
+        }
+
+    }
+
+}
@@ -0,0 +1,88 @@
+//
+//  FixedPointBackground.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef FixedPointBackground_hpp
+#define FixedPointBackground_hpp
+
+#include <stdio.h>
+
+#endif /* FixedPointBackground_hpp */
+
+#include "ofMain.h"
+#include "BackgroundModel.hpp"
+
+#pragma once
+
+
+/*
+ * FixedPointBackground:
+ *  Running average background in the style of
+ *  ofxCv::RunningBackground (BRIGHTER mode), without floats.
+ *
+ *  The accumulator is 16 bits per pixel in 8.8 fixed point
+ *  (half the memory of the float one) and each update does the
+ *  background read, the BRIGHTER difference, the threshold and
+ *  the accumulator blend in a single pass, 16 pixels at a time
+ *  with SSE2, one at a time otherwise. Both paths give identical
+ *  results. At very long learning times the 16 bit accumulator
+ *  can only track the scene to within a gray level or so.
+ *
+ *  With selective learning on, pixels over the threshold (and
+ *  any pixel set in the optional freeze mask) keep their old
+ *  background so people standing still aren't absorbed.
+ */
+
+class FixedPointBackground: public BackgroundModel{
+
+public:
+
+    FixedPointBackground();
+
+    Type getType() const;
+    string getName() const;
+
+    //same meaning as RunningBackground::setLearningTime()
+    void setLearningTime(float frames);
+    void setThresholdValue(int t);
+    void setSelectiveLearning(bool b);
+
+    //next update() copies the frame straight into the accumulator
+    void reset();
+    void setBackground(const ofPixels & bg);
+
+    //src and freezeMask are grayscale. Outputs get (re)allocated
+    //to the size of src, foreground/background can be null
+    void update(const ofPixels & src, ofPixels & thresh, ofPixels * foreground = NULL, ofPixels * background = NULL, const ofPixels * freezeMask = NULL);
+
+    bool isAllocated() const;
+    int getWidth() const;
+    int getHeight() const;
+
+    //8.8 fixed point, one per pixel, row major
+    const vector<uint16_t> & getAccumulator() const;
+
+    //bytes held by the model itself
+    size_t getMemoryUsage() const;
+
+
+private:
+
+    void updateRow(const uint8_t * src, uint16_t * acc, uint8_t * thresh, uint8_t * fg, uint8_t * bg, const uint8_t * freeze, int n) const;
+
+    vector<uint16_t> accumulator;
+    int width, height;
+    bool bNeedsReset;
+
+    float learningTime;
+    int threshold;
+    bool bSelective;
+
+    //blend weights in 0.16 fixed point, alpha + inverse = 65536
+    uint16_t alpha;
+    uint16_t inverse;
+
+    void updateWeights();
+
+};
@@ -0,0 +1,126 @@
+//
+//  FrameAssembler.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "FrameAssembler.hpp"
+
+
+void FrameAssembler::setup(int _tileWidth, int _tileHeight){
+
+    tileWidth = _tileWidth;
+    tileHeight = _tileHeight;
+
+    colorImg.setUseTexture(false);
+    colorImg.allocate(tileWidth, tileHeight);
+
+}
+
+bool FrameAssembler::ingest(vector<Feed> & feeds, const ofPixels & rgba, int camID, uint64_t captureTime, const AppSettings & settings, bool resetBackground){
+
+    for(int i = 0; i < feeds.size(); i++){
+
+        if( feeds[i].camID != camID ) continue;
+
+        colorImg.setFromPixels( rgba.getData(), tileWidth, tileHeight );
+
+        ofPixels raw;
+        raw.setFromPixels(colorImg.getPixels().getData(), tileWidth, tileHeight, OF_IMAGE_COLOR_ALPHA);
+
+        if( settings.camMirrors[i] ){
+            raw.mirror(false, true);
+        }
+
+        Feed::Settings feedSettings = settings.getFeedSettings(i);
+        feedSettings.resetBackground = resetBackground;
+
+        feeds[i].newFrame( raw, captureTime, feedSettings );
+
+        return true;
+    }
+
+    return false;
+
+}
+
+void FrameAssembler::assemble(Aggregator::Frame & frame, vector<Feed> & feeds, const AppSettings & settings, const vector< vector<ofVec2f> > & zonePoints, shared_ptr<const BinaryMask> mask){
+
+    Aggregator::Layout &layout = frame.layout;
+
+    layout.positions = settings.getCamPositions();
+    layout.rotations = settings.getCamRotations();
+    layout.tileWidth = tileWidth;
+    layout.tileHeight = tileHeight;
+
+    ofRectangle bounds = getBounds(layout.positions, layout.rotations, tileWidth, tileHeight);
+
+    layout.masterWidth = bounds.getRight();
+    layout.masterHeight = bounds.getBottom();
+
+    frame.captureTime = 0;
+
+    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+        frame.tiles.push_back( feeds[i].getOutputPix() );
+
+        //the composite is as new as its newest tile
+        frame.tileCaptureTimes.push_back( feeds[i].getCaptureTime() );
+        frame.captureTime = std::max( frame.captureTime, feeds[i].getCaptureTime() );
+    }
+
+    //fitted to the composite on the aggregator thread
+    frame.mask = mask;
+
+    //background subtraction already happened per camera,
+    //just pass the results along for stitching
+    frame.tileModelBytes = 0;
+
+    if( frame.settings.useBgDiff && frame.settings.usePerCameraBg ){
+        for(int i = 0; i < TOTAL_NUM_CAMS; i++){
+            frame.tileThresh.push_back( feeds[i].getThreshPix() );
+            frame.tileForeground.push_back( feeds[i].getForegroundPix() );
+            frame.tileBackground.push_back( feeds[i].getBackgroundPix() );
+            frame.tileModelBytes += feeds[i].threadedCV.modelBytes;
+        }
+    }
+
+    if( !zoneMap || zonePoints != zoneMapPoints || zoneMap -> getWidth() != layout.masterWidth || zoneMap -> getHeight() != layout.masterHeight ){
+        shared_ptr<ZoneMap> m = make_shared<ZoneMap>();
+        m -> build(zonePoints, layout.masterWidth, layout.masterHeight);
+        zoneMap = m;
+        zoneMapPoints = zonePoints;
+    }
+
+    if( !cameraMap || layout.positions != cameraMapPositions || layout.rotations != cameraMapRotations || cameraMap -> getWidth() != layout.masterWidth || cameraMap -> getHeight() != layout.masterHeight ){
+        shared_ptr<CameraMap> m = make_shared<CameraMap>();
+        m -> build(layout.positions, layout.rotations, tileWidth, tileHeight, layout.masterWidth, layout.masterHeight);
+        cameraMap = m;
+        cameraMapPositions = layout.positions;
+        cameraMapRotations = layout.rotations;
+    }
+
+    frame.zoneMap = zoneMap;
+    frame.cameraMap = cameraMap;
+
+}
+
+ofRectangle FrameAssembler::getBounds(const vector<ofVec2f> & positions, const vector<int> & rotations, int tileWidth, int tileHeight){
+
+    int furthestRight = 0;
+    int furthestDown = 0;
+    int furthestLeft = 10000;
+    int furthestUp = 10000;
+
+    for(int i = 0; i < positions.size(); i++){
+
+        int xDim = rotations[i] % 2 == 1 ? tileHeight : tileWidth;
+        int yDim = rotations[i] % 2 == 1 ? tileWidth : tileHeight;
+
+        furthestRight = max( furthestRight, (int)positions[i].x + xDim );
+        furthestDown = max( furthestDown, (int)positions[i].y + yDim );
+        furthestLeft = min( furthestLeft, (int)positions[i].x );
+        furthestUp = min( furthestUp, (int)positions[i].y );
+    }
+
+    return ofRectangle(furthestLeft, furthestUp, furthestRight - furthestLeft, furthestDown - furthestUp);
+
+}
@@ -0,0 +1,75 @@
+//
+//  FrameAssembler.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef FrameAssembler_hpp
+#define FrameAssembler_hpp
+
+#include <stdio.h>
+
+#endif /* FrameAssembler_hpp */
+
+#include "ofMain.h"
+#include "ofxOpenCv.h"
+#include "Feed.hpp"
+#include "Aggregator.hpp"
+#include "AppSettings.hpp"
+#include "BinaryMask.hpp"
+#include "ZoneMap.hpp"
+#include "CameraMap.hpp"
+
+#pragma once
+
+
+/*
+ * FrameAssembler:
+ *  Everything between a camera frame coming in and the
+ *  Aggregator getting its Frame, the same for ofApp and
+ *  HeadlessApp:
+ *
+ *      -ingest() mirrors a camera's RGBA frame if asked to
+ *       and hands it to the feed with that address
+ *      -assemble() sizes the composite from the stitching
+ *       layout and fills in the tiles, capture times,
+ *       per-camera background tiles, mask, zone map, camera
+ *       map and settings
+ *
+ *  The zone and camera maps are only rebuilt when the zone
+ *  points, the layout or the composite size change. The
+ *  aggregator thread may still be using the old ones so
+ *  they're always new objects.
+ */
+
+class FrameAssembler{
+
+public:
+
+    void setup(int tileWidth, int tileHeight);
+
+    //false if no feed has this address
+    bool ingest(vector<Feed> & feeds, const ofPixels & rgba, int camID, uint64_t captureTime, const AppSettings & settings, bool resetBackground);
+
+    //settings are whatever frame.settings already holds
+    void assemble(Aggregator::Frame & frame, vector<Feed> & feeds, const AppSettings & settings, const vector< vector<ofVec2f> > & zonePoints, shared_ptr<const BinaryMask> mask);
+
+    //left/top-most corner and right/bottom-most edges
+    //of the tiles, rotated ones are taller than wide
+    static ofRectangle getBounds(const vector<ofVec2f> & positions, const vector<int> & rotations, int tileWidth, int tileHeight);
+
+
+private:
+
+    int tileWidth, tileHeight;
+
+    //camera RGBA -> the pixels Feeds get, only ever pixels
+    ofxCvColorImage colorImg;
+
+    shared_ptr<const ZoneMap> zoneMap;
+    vector< vector<ofVec2f> > zoneMapPoints;
+
+    shared_ptr<const CameraMap> cameraMap;
+    vector<ofVec2f> cameraMapPositions;
+    vector<int> cameraMapRotations;
+
+};
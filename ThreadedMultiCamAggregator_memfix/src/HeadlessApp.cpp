@@ -0,0 +1,303 @@
+//
+//  HeadlessApp.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "HeadlessApp.hpp"
+#include "BackgroundStore.hpp"
+
+
+//IP on the first line, port on the second
+static void loadAddress(string fileName, string &ip, int &port){
+
+    ofBuffer buffer = ofBufferFromFile(fileName);
+
+    int lineNum = 0;
+
+    for (ofBuffer::Line it = buffer.getLines().begin(), end = buffer.getLines().end(); it != end; ++it) {
+
+        string line = *it;
+
+        if(lineNum == 0 && !line.empty()){
+            ip = line;
+        } else if(lineNum == 1 && !line.empty()){
+            port = ofToInt(line);
+        }
+
+        lineNum++;
+    }
+
+}
+
+
+//--------------------------------------------------------------
+void HeadlessApp::setup(){
+
+    //same loop rate as the windowed app so
+    //latency and CPU can be compared
+    ofSetFrameRate(200);
+
+    loadSettings();
+    loadMask();
+
+
+    //----------OSC and preview stream----------
+    string oscIP = "";
+    int oscPort = 0;
+    loadAddress("osc.txt", oscIP, oscPort);
+
+    oscSender = make_shared<OscSender>();
+    oscSender -> setup(oscIP, oscPort);
+
+    string previewIP = "127.0.0.1";
+    int previewPort = 12346;
+    loadAddress("preview.txt", previewIP, previewPort);
+
+    previewStreamer = make_shared<PreviewStreamer>();
+    previewStreamer -> setup(previewIP, previewPort);
+
+    statusReporter.setup(oscSender);
+
+
+    //----------Detection pipeline----------
+    aggregator.setup(camWidth, camHeight, oscSender, previewStreamer);
+
+
+    //----------Cameras----------
+    thermal.setup();
+    ofAddListener( thermal.newFrameEvt, this, &HeadlessApp::addNewFrameToQueue );
+
+    frameAssembler.setup(camWidth, camHeight);
+
+    feeds.resize(TOTAL_NUM_CAMS);
+
+    for(int i = 0; i < feeds.size(); i++){
+        feeds[i].setup( i, addresses[i], camWidth, camHeight );
+    }
+
+#ifndef TARGET_OSX
+    syntheticCameras.resize(TOTAL_NUM_CAMS);
+
+    for(int i = 0; i < syntheticCameras.size(); i++){
+
+        syntheticCameras[i].setup(camWidth, camHeight, 2);
+
+        //every camera needs an address to be matched to its feed
+        if( addresses[i] == 0 ){
+            addresses[i] = i + 1;
+            feeds[i].camID = addresses[i];
+        }
+    }
+
+    cout << "[HeadlessApp] No thermal cameras on this platform, using synthetic cameras" << endl;
+#endif
+
+    lastSyntheticTime = 0;
+
+
+    //warm start the per-camera backgrounds, same as ofApp
+    BackgroundStore backgroundLoader;
+    ofPixels savedBackground;
+    Aggregator::Layout savedLayout;
+
+    if( backgroundLoader.load(savedBackground, savedLayout) && savedLayout.tileWidth == camWidth && savedLayout.tileHeight == camHeight ){
+
+        for(int i = 0; i < feeds.size(); i++){
+
+            ofPixels tile;
+
+            if( BackgroundStore::extractTile(savedBackground, savedLayout, i, tile) ){
+                feeds[i].seedBackground(tile);
+            }
+
+        }
+
+    }
+
+    cpuMeter.setup(10.0f);
+
+#if PROFILER_ENABLED
+    profiler.setup(1.0f, 10.0f, "profile.csv", "profile.json");
+#endif
+
+    cout << "[HeadlessApp] Running without a window" << endl;
+
+}
+
+void HeadlessApp::loadSettings(){
+
+    //----------the xml files ofApp's panels save----------
+    appSettings.setup(camWidth, camHeight);
+    appSettings.loadFromFiles();
+
+    pipelineSettings = appSettings.getPipelineSettings();
+
+    //outlines are only ever drawn
+    pipelineSettings.traceContours = false;
+
+    zonePoints = appSettings.getZonePoints();
+
+
+    //----------camAddresses.txt, pipeline.txt----------
+    addresses.assign(TOTAL_NUM_CAMS, 0);
+
+    ofBuffer addressBuffer = ofBufferFromFile("camAddresses.txt");
+    int lineNum = 0;
+
+    for (ofBuffer::Line it = addressBuffer.getLines().begin(), end = addressBuffer.getLines().end(); it != end && lineNum < TOTAL_NUM_CAMS; ++it) {
+        addresses[lineNum] = ofToInt(*it);
+        lineNum++;
+    }
+
+    ofBuffer pipelineBuffer = ofBufferFromFile("pipeline.txt");
+
+    for (ofBuffer::Line it = pipelineBuffer.getLines().begin(), end = pipelineBuffer.getLines().end(); it != end; ++it) {
+
+        string line = ofTrim(*it);
+
+        if( !line.empty() ){
+            pipelineSettings.stageOrder.push_back(line);
+        }
+    }
+
+    if( pipelineSettings.stageOrder.empty() ){
+        pipelineSettings.stageOrder = StageGraph::getDefaultOrder();
+    }
+
+}
+
+void HeadlessApp::loadMask(){
+
+    //straight into pixels, ofImage would want a texture
+    if( ofLoadImage(maskPix, "mask/mask.png") ){
+
+        maskPix.setImageType(OF_IMAGE_GRAYSCALE);
+
+    } else {
+
+        cout << "[HeadlessApp] No mask found, nothing masked" << endl;
+
+        ofRectangle bounds = FrameAssembler::getBounds(appSettings.getCamPositions(), appSettings.getCamRotations(), camWidth, camHeight);
+
+        maskPix.allocate(bounds.getRight(), bounds.getBottom(), OF_IMAGE_GRAYSCALE);
+        maskPix.setColor(ofColor(0));
+    }
+
+}
+
+//--------------------------------------------------------------
+void HeadlessApp::addNewFrameToQueue( ofxThermalClient::NewFrameData &nf ){
+
+    CameraFrame frame;
+    frame.pix = nf.pix;
+    frame.ID = nf.ID;
+    frame.captureTime = nf.captureTime;
+
+    frameQueue.push_back(frame);
+
+}
+
+void HeadlessApp::updateSyntheticCameras(){
+
+    //the thermal cameras run at about 9 fps
+    if( syntheticCameras.empty() || ofGetElapsedTimef() - lastSyntheticTime < 1.0f/9.0f ) return;
+
+    lastSyntheticTime = ofGetElapsedTimef();
+
+    for(int i = 0; i < syntheticCameras.size(); i++){
+
+        syntheticCameras[i].update();
+
+        const ofPixels &gray = syntheticCameras[i].getPixels();
+
+        //RGBA like the cameras
+        CameraFrame frame;
+        frame.pix.allocate(camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
+
+        for(int j = 0; j < camWidth * camHeight; j++){
+            frame.pix[j*4] = frame.pix[j*4 + 1] = frame.pix[j*4 + 2] = gray[j];
+            frame.pix[j*4 + 3] = 255;
+        }
+
+        frame.ID = addresses[i];
+        frame.captureTime = ofGetElapsedTimeMicros();
+
+        frameQueue.push_back(frame);
+    }
+
+}
+
+//--------------------------------------------------------------
+void HeadlessApp::update(){
+
+    thermal.checkForNewFrame();
+    updateSyntheticCameras();
+
+    for(int i = 0; i < feeds.size(); i++){
+        feeds[i].update();
+    }
+
+
+    if( frameQueue.size() > 0 ){
+
+        PROFILE_SCOPE(Profiler::INGEST);
+
+        //--------------------NEW FRAME -> FEED ASSIGNMENT--------------------
+        do{
+
+            CameraFrame &cf = frameQueue.front();
+            frameAssembler.ingest( feeds, cf.pix, cf.ID, cf.captureTime, appSettings, false );
+
+            frameQueue.pop_front();
+
+        } while ( frameQueue.size() );
+
+
+        //packed once, a mask saved at another composite size
+        //is fitted to this one on the aggregator thread
+        if( !binaryMask ){
+            shared_ptr<BinaryMask> m = make_shared<BinaryMask>();
+            m -> setFromPixels(maskPix);
+            binaryMask = m;
+        }
+
+
+        //--------------------HAND OFF TO AGGREGATOR THREAD--------------------
+        Aggregator::Frame frame;
+
+        frame.settings = pipelineSettings;
+        frameAssembler.assemble( frame, feeds, appSettings, zonePoints, binaryMask );
+
+        aggregator.analyze(frame);
+
+    }
+
+
+    aggregator.update();
+
+    if( aggregator.isFrameNew() ){
+        for(int i = 0; i < aggregator.newConsoleLines.size(); i++){
+            cout << "[HeadlessApp] " << aggregator.newConsoleLines[i] << endl;
+        }
+    }
+
+
+    statusReporter.update( feeds, addresses, appSettings );
+
+
+    if( cpuMeter.update() ){
+        cout << "[HeadlessApp] " << cpuMeter.getReport() << ", status: " << statusReporter.getStatus() << endl;
+    }
+
+#if PROFILER_ENABLED
+    profiler.update();
+#endif
+
+}
+
+//--------------------------------------------------------------
+void HeadlessApp::exit(){
+
+    ofRemoveListener( thermal.newFrameEvt, this, &HeadlessApp::addNewFrameToQueue );
+
+}
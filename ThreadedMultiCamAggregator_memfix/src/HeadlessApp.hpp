@@ -0,0 +1,114 @@
+//
+//  HeadlessApp.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef HeadlessApp_hpp
+#define HeadlessApp_hpp
+
+#include <stdio.h>
+
+#endif /* HeadlessApp_hpp */
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "ofxThermalClient.h"
+#include "Feed.hpp"
+#include "Aggregator.hpp"
+#include "OscSender.hpp"
+#include "PreviewStreamer.hpp"
+#include "BinaryMask.hpp"
+#include "AppSettings.hpp"
+#include "FrameAssembler.hpp"
+#include "StatusReporter.hpp"
+#include "SyntheticSource.hpp"
+#include "CpuMeter.hpp"
+#include "Profiler.hpp"
+
+#pragma once
+
+
+/*
+ * HeadlessApp:
+ *  The install without a window, run with ofAppNoWindow
+ *  (main.cpp --headless). No GL context is ever made: no
+ *  gui, no fonts, no textures, no draw().
+ *
+ *      -camera frames, feeds, the Aggregator pipeline, OSC,
+ *       shared memory and the preview stream are the same
+ *       objects ofApp uses
+ *      -settings come only from the xml files ofApp's panels
+ *       save (see AppSettings) plus mask/mask.png and the
+ *       txt files. Nothing is ever written back
+ *      -frames reach the aggregator through the same
+ *       FrameAssembler and /status goes out through the same
+ *       StatusReporter as in ofApp
+ *      -there are no thermal cameras off the Mac, so there
+ *       every address in camAddresses.txt gets a
+ *       SyntheticSource instead
+ */
+
+class HeadlessApp : public ofBaseApp{
+
+public:
+
+    void setup();
+    void update();
+    void exit();
+
+    const int camWidth = 206;
+    const int camHeight = 156;
+
+    struct CameraFrame{
+        ofPixels pix;
+        int ID;
+        uint64_t captureTime;
+    };
+
+
+private:
+
+    void loadSettings();
+    void loadMask();
+
+    //queues one frame per camera about as often as
+    //the thermal cameras send them
+    void updateSyntheticCameras();
+
+    ofxThermalClient thermal;
+    void addNewFrameToQueue( ofxThermalClient::NewFrameData &nf );
+
+    list<CameraFrame> frameQueue;
+
+    vector<SyntheticSource> syntheticCameras;
+    double lastSyntheticTime;
+
+    vector<int> addresses;
+    vector<Feed> feeds;
+    Aggregator aggregator;
+    FrameAssembler frameAssembler;
+
+    //-----settings, from the xml files-----
+    //nothing changes them after setup, so mapped once
+    AppSettings appSettings;
+    Aggregator::Settings pipelineSettings;
+    vector< vector<ofVec2f> > zonePoints;
+
+    //-----handed to the aggregator-----
+    ofPixels maskPix;
+    shared_ptr<const BinaryMask> binaryMask;
+
+    //-----OSC-----
+    shared_ptr<OscSender> oscSender;
+    shared_ptr<PreviewStreamer> previewStreamer;
+
+    StatusReporter statusReporter;
+
+    CpuMeter cpuMeter;
+
+#if PROFILER_ENABLED
+    //no INFO view here, profile.csv/json only
+    Profiler profiler;
+#endif
+
+};
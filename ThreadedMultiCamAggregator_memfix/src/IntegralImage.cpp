@@ -0,0 +1,195 @@
+//
+//  IntegralImage.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "IntegralImage.hpp"
+
+
+IntegralImage::IntegralImage(){
+
+    width = 0;
+    height = 0;
+
+}
+
+void IntegralImage::setFromThreshold(const ofPixels & pix, int threshold, const ofPixels * intensity){
+
+    width = pix.getWidth();
+    height = pix.getHeight();
+
+    Entry zero = { 0, 0 };
+
+    bands.resize(1);
+    rowBand.assign(height + 1, 0);
+
+    Band &band = bands[0];
+    band.startRow = 0;
+    band.rows = height;
+    band.top.assign(width + 1, zero);
+
+    vector<Entry> &table = band.table;
+
+    if( intensity && (intensity -> getWidth() != width || intensity -> getHeight() != height) ){
+        intensity = NULL;
+    }
+
+    int stride = width + 1;
+
+    //only the top row and left column need clearing, the
+    //rest is written below
+    table.resize(stride * (height + 1));
+
+    std::fill(table.begin(), table.begin() + stride, zero);
+
+    int channels = pix.getNumChannels();
+    int intensityChannels = intensity ? intensity -> getNumChannels() : 0;
+
+    for(int y = 0; y < height; y++){
+
+        const unsigned char *src = pix.getData() + (size_t)y * width * channels;
+        const unsigned char *val = intensity ? intensity -> getData() + (size_t)y * width * intensityChannels : NULL;
+
+        const Entry *above = &table[y * stride];
+        Entry *row = &table[(y + 1) * stride];
+
+        row[0] = zero;
+
+        //running sums of this row, added to the row above
+        uint32_t rowCount = 0;
+        uint32_t rowIntensity = 0;
+
+        for(int x = 0; x < width; x++){
+
+            uint32_t on = src[x * channels] > threshold;
+
+            rowCount += on;
+
+            if( val ){
+                //branchless, on is 0 or 1
+                rowIntensity += val[x * intensityChannels] * on;
+            }
+
+            row[x + 1].count = above[x + 1].count + rowCount;
+            row[x + 1].intensity = above[x + 1].intensity + rowIntensity;
+
+        }
+
+    }
+
+}
+
+void IntegralImage::setFromBands(vector<IntegralImage> & bandImages){
+
+    clear();
+
+    if( bandImages.empty() ) return;
+
+    width = bandImages[0].width;
+
+    Entry zero = { 0, 0 };
+    int stride = width + 1;
+
+    rowBand.push_back(0);
+
+    for(int i = 0; i < bandImages.size(); i++){
+
+        IntegralImage &img = bandImages[i];
+
+        //only whole images built in one go can be joined
+        if( img.width != width || img.bands.size() != 1 ){
+            clear();
+            return;
+        }
+
+        Band band;
+        band.startRow = height;
+        band.rows = img.height;
+        band.table.swap(img.bands[0].table);
+
+        //sums above this band = sums above the last one plus its bottom row
+        if( bands.empty() ){
+            band.top.assign(stride, zero);
+        } else {
+
+            const Band &above = bands.back();
+            const Entry *bottom = &above.table[above.rows * stride];
+
+            band.top.resize(stride);
+
+            for(int x = 0; x < stride; x++){
+                band.top[x].count = above.top[x].count + bottom[x].count;
+                band.top[x].intensity = above.top[x].intensity + bottom[x].intensity;
+            }
+        }
+
+        for(int y = 0; y < band.rows; y++){
+            rowBand.push_back(bands.size());
+        }
+
+        height += band.rows;
+        bands.push_back(std::move(band));
+
+        img.clear();
+    }
+
+}
+
+void IntegralImage::clear(){
+
+    width = 0;
+    height = 0;
+    bands.clear();
+    rowBand.clear();
+
+}
+
+bool IntegralImage::isAllocated() const{
+    return width > 0 && height > 0;
+}
+
+int IntegralImage::getWidth() const{
+    return width;
+}
+
+int IntegralImage::getHeight() const{
+    return height;
+}
+
+IntegralImage::Entry IntegralImage::at(int x, int y) const{
+
+    const Band &band = bands[rowBand[y]];
+
+    const Entry &e = band.table[(y - band.startRow) * (width + 1) + x];
+    const Entry &above = band.top[x];
+
+    Entry sum = { e.count + above.count, e.intensity + above.intensity };
+    return sum;
+
+}
+
+uint32_t IntegralImage::getCount(int x0, int y0, int x1, int y1) const{
+
+    x0 = ofClamp(x0, 0, width);
+    x1 = ofClamp(x1, 0, width);
+    y0 = ofClamp(y0, 0, height);
+    y1 = ofClamp(y1, 0, height);
+
+    if( x1 <= x0 || y1 <= y0 ) return 0;
+
+    return at(x1, y1).count - at(x0, y1).count - at(x1, y0).count + at(x0, y0).count;
+
+}
+
+uint32_t IntegralImage::getIntensity(int x0, int y0, int x1, int y1) const{
+
+    x0 = ofClamp(x0, 0, width);
+    x1 = ofClamp(x1, 0, width);
+    y0 = ofClamp(y0, 0, height);
+    y1 = ofClamp(y1, 0, height);
+
+    if( x1 <= x0 || y1 <= y0 ) return 0;
+
+    return at(x1, y1).intensity - at(x0, y1).intensity - at(x1, y0).intensity + at(x0, y0).intensity;
+
+}
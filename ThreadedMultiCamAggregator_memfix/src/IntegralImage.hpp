@@ -0,0 +1,95 @@
+//
+//  IntegralImage.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef IntegralImage_hpp
+#define IntegralImage_hpp
+
+#include <stdio.h>
+
+#endif /* IntegralImage_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * IntegralImage:
+ *  Summed-area table of the thresholded image. Every entry
+ *  holds how many pixels above and to the left are over the
+ *  threshold, and the sum of their intensity.
+ *
+ *  Thresholding and summing happen in the same pass, and
+ *  the sum of any rectangle is 4 lookups after that.
+ *
+ *  The pipeline builds one per band on the band threads and
+ *  joins them with setFromBands(): every band keeps its own
+ *  table plus one row with the sums of the bands above it,
+ *  so joining costs a row per band rather than a full pass.
+ *
+ *  Sums are 32 bit and may wrap on big images, but the
+ *  unsigned differences still come out right for any
+ *  rectangle whose own sum fits.
+ */
+
+class IntegralImage{
+
+public:
+
+    IntegralImage();
+
+    //pixels over threshold in the first channel of pix count.
+    //intensity is summed over those pixels, skipped if null
+    //or a different size
+    void setFromThreshold(const ofPixels & pix, int threshold, const ofPixels * intensity);
+
+    //one image from images of consecutive horizontal bands,
+    //top first, all the same width. Their tables are moved
+    //in, so the bands are left empty
+    void setFromBands(vector<IntegralImage> & bandImages);
+
+    void clear();
+
+    bool isAllocated() const;
+    int getWidth() const;
+    int getHeight() const;
+
+    //pixels over the threshold in [x0, x1) x [y0, y1)
+    uint32_t getCount(int x0, int y0, int x1, int y1) const;
+
+    //their intensity, 0 if there was no intensity image
+    uint32_t getIntensity(int x0, int y0, int x1, int y1) const;
+
+
+private:
+
+    //count and intensity side by side so a lookup is one cache line
+    struct Entry{
+        uint32_t count;
+        uint32_t intensity;
+    };
+
+    struct Band{
+        int startRow;
+        int rows;
+
+        //(width + 1) x (rows + 1), first row and column are 0
+        vector<Entry> table;
+
+        //sums of everything above the band, width + 1
+        vector<Entry> top;
+    };
+
+    Entry at(int x, int y) const;
+
+    int width, height;
+
+    //a whole image built in one go is a single band
+    vector<Band> bands;
+
+    //band of every table row, height + 1
+    vector<int> rowBand;
+
+};
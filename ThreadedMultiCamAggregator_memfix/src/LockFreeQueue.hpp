@@ -0,0 +1,135 @@
+//
+//  LockFreeQueue.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef LockFreeQueue_hpp
+#define LockFreeQueue_hpp
+
+#include <stdio.h>
+
+#endif /* LockFreeQueue_hpp */
+
+#include "ofMain.h"
+#include <atomic>
+
+#pragma once
+
+
+/*
+ * LockFreeQueue:
+ *  Fixed size queue any number of threads can push to and
+ *  pop from without locks (bounded MPMC, one sequence number
+ *  per slot). push() fails instead of waiting when it's full,
+ *  so a producer never blocks on a slow consumer.
+ *
+ *  Slots are made once up front and items are moved in and
+ *  out, so items that keep their capacity (vectors that are
+ *  cleared rather than freed) don't allocate once warmed up.
+ */
+
+template<typename T>
+class LockFreeQueue{
+
+public:
+
+    //rounded up to a power of two
+    LockFreeQueue(size_t capacity = 64){
+
+        size_t size = 2;
+        while( size < capacity ) size *= 2;
+
+        mask = size - 1;
+        cells.reset( new Cell[size] );
+
+        for(size_t i = 0; i < size; i++){
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+
+    }
+
+    //false if full, item is left alone in that case
+    bool push(T & item){
+
+        Cell *cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+        while( true ){
+
+            cell = &cells[pos & mask];
+            size_t seq = cell -> sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+            if( diff == 0 ){
+                //slot is free, claim it
+                if( enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) ) break;
+            } else if( diff < 0 ){
+                return false;
+            } else {
+                //someone else got there first
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+
+        }
+
+        std::swap(cell -> data, item);
+        cell -> sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+
+    }
+
+    //false if empty. The old contents of item end up in the
+    //slot, so their memory gets reused by a later push
+    bool pop(T & item){
+
+        Cell *cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+        while( true ){
+
+            cell = &cells[pos & mask];
+            size_t seq = cell -> sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+            if( diff == 0 ){
+                if( dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) ) break;
+            } else if( diff < 0 ){
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+
+        }
+
+        std::swap(item, cell -> data);
+        cell -> sequence.store(pos + mask + 1, std::memory_order_release);
+
+        return true;
+
+    }
+
+    size_t getCapacity() const{
+        return mask + 1;
+    }
+
+
+private:
+
+    struct Cell{
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    //on separate cache lines so producers and the consumer
+    //don't fight over them
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+
+};
@@ -0,0 +1,218 @@
+//
+//  MultiModalBackground.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "MultiModalBackground.hpp"
+
+
+MultiModalBackground::MultiModalBackground(){
+
+    width = 0;
+    height = 0;
+    bNeedsReset = true;
+
+    bgWeight = 100;
+    threshold = 26;
+    matchRadius = 13;
+    bSelective = false;
+
+    frameCount = 0;
+
+}
+
+BackgroundModel::Type MultiModalBackground::getType() const{
+    return MULTI_MODAL;
+}
+
+string MultiModalBackground::getName() const{
+    return "Multi-modal";
+}
+
+void MultiModalBackground::setLearningTime(float frames){
+
+    //leave headroom under 255 so established
+    //modes survive a while without being seen
+    bgWeight = ofClamp( (int)frames, 1, 200 );
+
+}
+
+void MultiModalBackground::setThresholdValue(int t){
+
+    threshold = ofClamp(t, 0, 255);
+
+    //anything within half a threshold is the same mode
+    matchRadius = std::max(2, threshold/2);
+
+}
+
+void MultiModalBackground::setSelectiveLearning(bool b){
+    bSelective = b;
+}
+
+void MultiModalBackground::reset(){
+    bNeedsReset = true;
+}
+
+void MultiModalBackground::setBackground(const ofPixels & bg){
+
+    width = bg.getWidth();
+    height = bg.getHeight();
+
+    int n = width * height;
+    const uint8_t *b = bg.getData();
+    int step = bg.getNumChannels();
+
+    values.assign(NUM_MODES * n, 0);
+    weights.assign(NUM_MODES * n, 0);
+
+    //only the dominant mode is known, the others rebuild themselves
+    for(int i = 0; i < n; i++){
+        values[i] = b[i * step];
+    }
+
+    memset(weights.data(), bgWeight, n);
+
+    bNeedsReset = false;
+
+}
+
+size_t MultiModalBackground::getMemoryUsage() const{
+    return values.size() + weights.size();
+}
+
+
+
+void MultiModalBackground::update(const ofPixels & src, ofPixels & thresh, ofPixels * foreground, ofPixels * background, const ofPixels * freezeMask){
+
+    int w = src.getWidth();
+    int h = src.getHeight();
+    int n = w * h;
+
+    if( w != width || h != height ){
+        width = w;
+        height = h;
+        values.assign(NUM_MODES * n, 0);
+        weights.assign(NUM_MODES * n, 0);
+        bNeedsReset = true;
+    }
+
+    const uint8_t *s = src.getData();
+
+    //the current frame becomes the one and only background mode
+    if( bNeedsReset ){
+
+        memcpy(values.data(), s, n);
+        memset(weights.data(), bgWeight, n);
+        memset(weights.data() + n, 0, (NUM_MODES - 1) * n);
+
+        bNeedsReset = false;
+    }
+
+    if( thresh.getWidth() != w || thresh.getHeight() != h || thresh.getNumChannels() != 1 ){
+        thresh.allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    if( foreground && (foreground -> getWidth() != w || foreground -> getHeight() != h || foreground -> getNumChannels() != 1) ){
+        foreground -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    if( background && (background -> getWidth() != w || background -> getHeight() != h || background -> getNumChannels() != 1) ){
+        background -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+    }
+
+    if( freezeMask && (freezeMask -> getWidth() != w || freezeMask -> getHeight() != h || freezeMask -> getNumChannels() != 1) ){
+        freezeMask = NULL;
+    }
+
+    uint8_t *t = thresh.getData();
+    uint8_t *fg = foreground ? foreground -> getData() : NULL;
+    uint8_t *bg = background ? background -> getData() : NULL;
+    const uint8_t *freeze = freezeMask ? freezeMask -> getData() : NULL;
+
+    frameCount++;
+    bool bDecay = frameCount % DECAY_INTERVAL == 0;
+    bool bSlowTick = frameCount % 4 == 0;
+
+    uint8_t *v[NUM_MODES];
+    uint8_t *wt[NUM_MODES];
+
+    for(int k = 0; k < NUM_MODES; k++){
+        v[k] = values.data() + k * n;
+        wt[k] = weights.data() + k * n;
+    }
+
+    for(int i = 0; i < n; i++){
+
+        int x = s[i];
+
+        //----------classify----------
+        int diff = 255;
+        int dominant = 0;
+        bool anyBackground = false;
+
+        for(int k = 0; k < NUM_MODES; k++){
+
+            if( wt[k][i] >= bgWeight ){
+                int d = x > v[k][i] ? x - v[k][i] : 0;
+                diff = std::min(diff, d);
+                anyBackground = true;
+            }
+
+            if( wt[k][i] > wt[dominant][i] ) dominant = k;
+
+        }
+
+        if( !anyBackground ) diff = 0;
+
+        uint8_t isForeground = diff > threshold ? 255 : 0;
+
+        t[i] = isForeground;
+        if( fg ) fg[i] = diff;
+        if( bg ) bg[i] = v[dominant][i];
+
+
+        //----------learn----------
+        if( freeze && freeze[i] ) continue;
+
+        //foreground only adds weight every 4th frame
+        int gain = ( bSelective && isForeground && !bSlowTick ) ? 0 : 1;
+
+        int match = -1;
+        int weakest = 0;
+
+        for(int k = 0; k < NUM_MODES; k++){
+
+            if( match == -1 && std::abs(x - v[k][i]) <= matchRadius ){
+                match = k;
+            }
+
+            if( wt[k][i] < wt[weakest][i] ) weakest = k;
+
+        }
+
+        if( match != -1 ){
+
+            //approximate median: step one level toward the sample
+            if( x > v[match][i] ) v[match][i]++;
+            else if( x < v[match][i] ) v[match][i]--;
+
+            wt[match][i] = std::min(255, wt[match][i] + gain);
+
+        } else if( gain ){
+
+            v[weakest][i] = x;
+            wt[weakest][i] = 1;
+            match = weakest;
+
+        }
+
+        if( bDecay ){
+            for(int k = 0; k < NUM_MODES; k++){
+                if( k != match && wt[k][i] > 0 ) wt[k][i]--;
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,83 @@
+//
+//  MultiModalBackground.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef MultiModalBackground_hpp
+#define MultiModalBackground_hpp
+
+#include <stdio.h>
+
+#endif /* MultiModalBackground_hpp */
+
+#include "ofMain.h"
+#include "BackgroundModel.hpp"
+
+#pragma once
+
+
+/*
+ * MultiModalBackground:
+ *  A few approximate-median modes per pixel instead of one
+ *  running average, so things that flip between two states
+ *  (HVAC vents cycling) end up as background twice over while
+ *  a person standing still only ever builds up one new mode.
+ *
+ *  Each mode has a value and a weight:
+ *      -a pixel within matchRadius of a mode nudges that mode's
+ *       value one gray level toward it and adds to its weight
+ *      -no match replaces the weakest mode
+ *      -unmatched modes slowly lose weight
+ *      -modes with weight >= learningTime count as background
+ *
+ *  A pixel is foreground if it is more than threshold brighter
+ *  than every background mode. With selective learning on,
+ *  foreground pixels build weight at a quarter of the rate.
+ *
+ *  Stored as structure of arrays (all mode 0 values, then all
+ *  mode 1 values...) so every pass walks memory linearly.
+ */
+
+class MultiModalBackground: public BackgroundModel{
+
+public:
+
+    static const int NUM_MODES = 3;
+
+    MultiModalBackground();
+
+    Type getType() const;
+    string getName() const;
+
+    void setLearningTime(float frames);
+    void setThresholdValue(int t);
+    void setSelectiveLearning(bool b);
+
+    void reset();
+    void setBackground(const ofPixels & bg);
+
+    void update(const ofPixels & src, ofPixels & thresh, ofPixels * foreground = NULL, ofPixels * background = NULL, const ofPixels * freezeMask = NULL);
+
+    size_t getMemoryUsage() const;
+
+
+private:
+
+    //NUM_MODES planes of width * height each
+    vector<uint8_t> values;
+    vector<uint8_t> weights;
+
+    int width, height;
+    bool bNeedsReset;
+
+    int bgWeight;
+    int threshold;
+    int matchRadius;
+    bool bSelective;
+
+    unsigned int frameCount;
+
+    //unmatched modes lose one weight every this many frames
+    static const int DECAY_INTERVAL = 8;
+
+};
@@ -0,0 +1,282 @@
+//
+//  OscSender.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "OscSender.hpp"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+
+OscSender::OscSender(): queue(64){
+
+    rawSocket = -1;
+    bWake = false;
+
+    //biggest datagram that's safe on every platform we run on
+    writer.setup(8192);
+
+    batchesSent = 0;
+    bundlesSent = 0;
+    messagesSent = 0;
+    dropped = 0;
+
+    lastLatency = 0;
+    totalLatency = 0;
+    maxLatency = 0;
+
+}
+
+OscSender::~OscSender(){
+
+    stopThread();
+    wake();
+    waitForThread(false, 4000);
+
+    if( rawSocket >= 0 ) close(rawSocket);
+
+}
+
+void OscSender::setup(string ip, int port){
+
+    osc.setup(ip, port);
+
+    //connected datagram socket so each packet is a single send()
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    rawSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if( rawSocket < 0 || inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1 || connect(rawSocket, (sockaddr*)&addr, sizeof(addr)) != 0 ){
+        cout << "[OscSender] Couldn't open socket to " << ip << ":" << port << ", pre-encoded packets won't be sent" << endl;
+        if( rawSocket >= 0 ) close(rawSocket);
+        rawSocket = -1;
+    }
+
+    startThread();
+
+}
+
+bool OscSender::send(Batch & batch){
+
+    if( batch.messages.empty() && batch.packetSizes.empty() ) return true;
+
+    batch.queuedTime = ofGetElapsedTimeMicros();
+
+    bool bQueued = queue.push(batch);
+
+    if( bQueued ){
+        wake();
+    } else {
+        dropped++;
+    }
+
+    //either way batch gets emptied: if it was queued what came
+    //back out of the slot is an old, already sent batch
+    batch.messages.clear();
+    batch.data.clear();
+    batch.packetSizes.clear();
+    batch.encodedMessages = 0;
+    batch.timeTag = OscWriter::IMMEDIATELY;
+
+    return bQueued;
+
+}
+
+OscSender::Stats OscSender::getStats() const{
+
+    Stats s;
+
+    s.bundlesSent = bundlesSent;
+    s.messagesSent = messagesSent;
+    s.dropped = dropped;
+    s.queueCapacity = queue.getCapacity();
+
+    s.lastLatency = lastLatency / 1000.0f;
+    s.meanLatency = batchesSent > 0 ? totalLatency / 1000.0f / batchesSent : 0;
+    s.maxLatency = maxLatency / 1000.0f;
+
+    return s;
+
+}
+
+void OscSender::threadedFunction(){
+
+    Batch batch;
+    ofxOscBundle bundle;
+
+    while(isThreadRunning()){
+
+        if( !queue.pop(batch) ){
+
+            //nothing to do, sleep until send() has something.
+            //The timeout is only a backstop
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(100), [this]{ return bWake; });
+            bWake = false;
+
+            continue;
+        }
+
+        if( !batch.messages.empty() && batch.timeTag != OscWriter::IMMEDIATELY ){
+
+            sendTagged(batch.messages, batch.timeTag);
+
+        } else if( !batch.messages.empty() ){
+
+            bundle.clear();
+
+            for(int i = 0; i < batch.messages.size(); i++){
+                bundle.addMessage( batch.messages[i] );
+            }
+
+            osc.sendBundle(bundle);
+            bundlesSent++;
+
+        }
+
+        size_t offset = 0;
+
+        for(int i = 0; i < batch.packetSizes.size(); i++){
+
+            sendPacket(&batch.data[offset], batch.packetSizes[i]);
+
+            offset += batch.packetSizes[i];
+
+        }
+
+        bundlesSent += batch.packetSizes.size();
+
+        uint64_t latency = ofGetElapsedTimeMicros() - batch.queuedTime;
+
+        batchesSent++;
+        messagesSent += batch.messages.size() + batch.encodedMessages;
+
+        lastLatency = latency;
+        totalLatency += latency;
+
+        if( latency > maxLatency ) maxLatency = latency;
+
+        batch.messages.clear();
+        batch.data.clear();
+        batch.packetSizes.clear();
+        batch.encodedMessages = 0;
+        batch.timeTag = OscWriter::IMMEDIATELY;
+
+    }
+
+}
+
+void OscSender::wake(){
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        bWake = true;
+    }
+
+    wakeCondition.notify_one();
+
+}
+
+void OscSender::sendPacket(const char * data, size_t size){
+
+    if( rawSocket >= 0 ){
+        ::send(rawSocket, data, size, 0);
+    }
+
+}
+
+void OscSender::sendTagged(const vector<ofxOscMessage> & messages, uint64_t timeTag){
+
+    writer.clear();
+    writer.beginBundle(timeTag);
+
+    int inBundle = 0;
+
+    for(int i = 0; i < messages.size(); i++){
+
+        if( writeTagged(messages[i]) ){
+            inBundle++;
+            continue;
+        }
+
+        //full, send what we have and carry on in a new bundle
+        //with the same time tag
+        if( inBundle > 0 ){
+
+            writer.endBundle();
+            sendPacket(writer.getData(), writer.getSize());
+            bundlesSent++;
+
+            writer.clear();
+            writer.beginBundle(timeTag);
+            inBundle = 0;
+
+            if( writeTagged(messages[i]) ){
+                inBundle++;
+                continue;
+            }
+        }
+
+        //a single message too big for a datagram doesn't go out
+        cout << "[OscSender] Time tagged message " << messages[i].getAddress() << " too big, dropped" << endl;
+        dropped++;
+
+    }
+
+    writer.endBundle();
+
+    if( inBundle == 0 ) return;
+
+    sendPacket(writer.getData(), writer.getSize());
+    bundlesSent++;
+
+}
+
+bool OscSender::writeTagged(const ofxOscMessage & m){
+
+    size_t start = writer.getSize();
+
+    typeTags.clear();
+
+    //the ofxOsc arg types are the OSC type tag characters,
+    //anything we don't write goes out as an int 0
+    for(int j = 0; j < m.getNumArgs(); j++){
+
+        ofxOscArgType type = m.getArgType(j);
+
+        bool bSupported = type == OFXOSC_TYPE_INT64 || type == OFXOSC_TYPE_FLOAT || type == OFXOSC_TYPE_STRING || type == OFXOSC_TYPE_TIMETAG;
+
+        typeTags += bSupported ? (char)type : 'i';
+    }
+
+    writer.beginMessage(m.getAddress().c_str(), typeTags.c_str());
+
+    for(int j = 0; j < m.getNumArgs(); j++){
+
+        switch( m.getArgType(j) ){
+            case OFXOSC_TYPE_INT32: writer.addInt( m.getArgAsInt32(j) ); break;
+            case OFXOSC_TYPE_INT64: writer.addInt64( m.getArgAsInt64(j) ); break;
+            case OFXOSC_TYPE_FLOAT: writer.addFloat( m.getArgAsFloat(j) ); break;
+            case OFXOSC_TYPE_STRING: writer.addString( m.getArgAsString(j).c_str() ); break;
+            case OFXOSC_TYPE_TIMETAG: writer.addTimeTag( m.getArgAsTimetag(j) ); break;
+            default: writer.addInt(0); break;
+        }
+    }
+
+    writer.endMessage();
+
+    //cut the half written message off so the bundle stays valid
+    if( writer.hasOverflowed() ){
+        writer.truncate(start);
+        return false;
+    }
+
+    return true;
+
+}
@@ -0,0 +1,132 @@
+//
+//  OscSender.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef OscSender_hpp
+#define OscSender_hpp
+
+#include <stdio.h>
+
+#endif /* OscSender_hpp */
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "LockFreeQueue.hpp"
+#include "OscWriter.hpp"
+#include <condition_variable>
+
+#pragma once
+
+
+/*
+ * OscSender:
+ *  Owns the OSC socket and does all the sending on its own
+ *  thread, so a slow or stuck network never holds up the
+ *  detection pipeline or the GL thread.
+ *
+ *      -whoever has messages for a tick hands them over as
+ *       one Batch through a lock-free queue, and that never
+ *       waits: if the queue is full the batch is dropped
+ *       and counted
+ *      -the messages of a batch go out as a single OSC
+ *       bundle, pre-encoded packets as they are on a plain
+ *       UDP socket to the same address
+ *      -ofxOscSender can only send "immediately" bundles, so
+ *       batches with a time tag are encoded here instead and
+ *       split over more bundles if they don't fit in one
+ *       datagram. A message too big for a datagram on its
+ *       own is dropped and counted, the rest still go out
+ *      -the thread sleeps on a condition variable while
+ *       the queue is empty, send() wakes it
+ *      -latency is measured from hand over to the socket
+ *       returning
+ */
+
+class OscSender: public ofThread{
+
+public:
+
+    OscSender();
+    ~OscSender();
+
+    struct Batch{
+        vector<ofxOscMessage> messages;
+
+        //packets already encoded (OscWriter), back to back in
+        //data, each sent as its own datagram
+        vector<char> data;
+        vector<int> packetSizes;
+        int encodedMessages = 0;
+
+        //time tag for the bundle(s) messages go out in,
+        //see OscWriter::getTimeTag()
+        uint64_t timeTag = OscWriter::IMMEDIATELY;
+
+        //filled in by send()
+        uint64_t queuedTime;
+    };
+
+    struct Stats{
+        uint64_t bundlesSent;
+        uint64_t messagesSent;
+        uint64_t dropped;
+        size_t queueCapacity;
+
+        //hand over -> sent, ms
+        float lastLatency;
+        float meanLatency;
+        float maxLatency;
+    };
+
+    void setup(string ip, int port);
+
+    //takes the messages out of batch and leaves it with
+    //recycled (empty) storage. Never blocks, false if the
+    //batch had to be dropped
+    bool send(Batch & batch);
+
+    Stats getStats() const;
+
+
+private:
+
+    void threadedFunction();
+
+    //wakes the thread up after a push, and on shutdown
+    void wake();
+
+    //messages as time tagged bundles through writer
+    void sendTagged(const vector<ofxOscMessage> & messages, uint64_t timeTag);
+    void sendPacket(const char * data, size_t size);
+
+    //m into the open bundle, false and nothing written if
+    //it doesn't fit
+    bool writeTagged(const ofxOscMessage & m);
+
+    OscWriter writer;
+    string typeTags;
+
+    ofxOscSender osc;
+
+    //for pre-encoded packets, -1 if it couldn't be opened
+    int rawSocket;
+
+    LockFreeQueue<Batch> queue;
+
+    //the thread blocks on this while the queue is empty
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool bWake;
+
+    std::atomic<uint64_t> batchesSent;
+    std::atomic<uint64_t> bundlesSent;
+    std::atomic<uint64_t> messagesSent;
+    std::atomic<uint64_t> dropped;
+
+    //microseconds
+    std::atomic<uint64_t> lastLatency;
+    std::atomic<uint64_t> totalLatency;
+    std::atomic<uint64_t> maxLatency;
+
+};
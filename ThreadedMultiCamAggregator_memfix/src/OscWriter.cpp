@@ -0,0 +1,222 @@
+//
+//  OscWriter.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "OscWriter.hpp"
+
+
+const uint64_t OscWriter::IMMEDIATELY;
+
+OscWriter::OscWriter(){
+
+    size = 0;
+    bOverflow = false;
+    bInBundle = false;
+    messageSizePos = 0;
+
+}
+
+void OscWriter::setup(size_t capacity){
+
+    buffer.assign(capacity, 0);
+    clear();
+
+}
+
+void OscWriter::clear(){
+
+    size = 0;
+    bOverflow = false;
+    bInBundle = false;
+    messageSizePos = 0;
+
+}
+
+void OscWriter::truncate(size_t _size){
+
+    size = std::min(_size, size);
+    bOverflow = false;
+
+}
+
+size_t OscWriter::paddedLength(const char * s){
+
+    //the terminating 0 plus padding to a multiple of 4
+    return (strlen(s) / 4 + 1) * 4;
+
+}
+
+size_t OscWriter::getMessageSize(const char * address, const char * typeTags){
+
+    size_t bytes = 4 + paddedLength(address) + (strlen(typeTags) + 1) / 4 * 4 + 4;
+
+    //int and float are 4 bytes, int64 and time tags 8
+    for(const char *t = typeTags; *t; t++){
+        bytes += *t == 't' || *t == 'h' ? 8 : 4;
+    }
+
+    return bytes;
+
+}
+
+bool OscWriter::hasRoom(size_t bytes) const{
+    return size + bytes <= buffer.size();
+}
+
+bool OscWriter::hasOverflowed() const{
+    return bOverflow;
+}
+
+const char * OscWriter::getData() const{
+    return buffer.data();
+}
+
+size_t OscWriter::getSize() const{
+    return size;
+}
+
+void OscWriter::write32(uint32_t value){
+
+    if( !hasRoom(4) ){
+        bOverflow = true;
+        return;
+    }
+
+    //OSC is big endian
+    buffer[size++] = (value >> 24) & 0xFF;
+    buffer[size++] = (value >> 16) & 0xFF;
+    buffer[size++] = (value >> 8) & 0xFF;
+    buffer[size++] = value & 0xFF;
+
+}
+
+void OscWriter::write64(uint64_t value){
+
+    write32(value >> 32);
+    write32(value & 0xFFFFFFFF);
+
+}
+
+void OscWriter::writeString(const char * s){
+
+    size_t len = strlen(s);
+    size_t padded = paddedLength(s);
+
+    if( !hasRoom(padded) ){
+        bOverflow = true;
+        return;
+    }
+
+    memcpy(&buffer[size], s, len);
+    memset(&buffer[size + len], 0, padded - len);
+    size += padded;
+
+}
+
+void OscWriter::beginBundle(uint64_t timeTag){
+
+    writeString("#bundle");
+    write64(timeTag);
+
+    bInBundle = true;
+
+}
+
+void OscWriter::endBundle(){
+
+    bInBundle = false;
+
+}
+
+void OscWriter::beginMessage(const char * address, const char * typeTags){
+
+    //elements of a bundle are prefixed with their size,
+    //filled in by endMessage()
+    if( bInBundle ){
+        messageSizePos = size;
+        write32(0);
+    }
+
+    writeString(address);
+
+    //type tag string, ',' then one char per argument
+    size_t len = strlen(typeTags);
+    size_t padded = (len + 1) / 4 * 4 + 4;
+
+    if( !hasRoom(padded) ){
+        bOverflow = true;
+        return;
+    }
+
+    buffer[size] = ',';
+    memcpy(&buffer[size + 1], typeTags, len);
+    memset(&buffer[size + 1 + len], 0, padded - len - 1);
+    size += padded;
+
+}
+
+void OscWriter::endMessage(){
+
+    if( !bInBundle || bOverflow ) return;
+
+    uint32_t bytes = size - messageSizePos - 4;
+
+    buffer[messageSizePos] = (bytes >> 24) & 0xFF;
+    buffer[messageSizePos + 1] = (bytes >> 16) & 0xFF;
+    buffer[messageSizePos + 2] = (bytes >> 8) & 0xFF;
+    buffer[messageSizePos + 3] = bytes & 0xFF;
+
+}
+
+void OscWriter::addInt(int32_t value){
+
+    write32( (uint32_t)value );
+
+}
+
+void OscWriter::addInt64(int64_t value){
+
+    write64( (uint64_t)value );
+
+}
+
+void OscWriter::addFloat(float value){
+
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+
+    write32(bits);
+
+}
+
+void OscWriter::addTimeTag(uint64_t value){
+
+    write64(value);
+
+}
+
+void OscWriter::addString(const char * value){
+
+    writeString(value);
+
+}
+
+uint64_t OscWriter::getTimeTag(uint64_t elapsedMicros){
+
+    //how long ago that was, taken off the wall clock
+    uint64_t now = ofGetElapsedTimeMicros();
+    uint64_t ago = now > elapsedMicros ? now - elapsedMicros : 0;
+
+    uint64_t wall = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::system_clock::now().time_since_epoch() ).count() - ago;
+
+    //NTP counts seconds from 1900 in the top 32 bits and
+    //fractions of a second in the bottom 32
+    const uint64_t secondsFrom1900To1970 = 2208988800ULL;
+
+    uint64_t seconds = wall / 1000000 + secondsFrom1900To1970;
+    uint64_t fraction = ( (wall % 1000000) << 32 ) / 1000000;
+
+    return (seconds << 32) | fraction;
+
+}
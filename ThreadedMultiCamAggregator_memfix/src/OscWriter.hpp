@@ -0,0 +1,96 @@
+//
+//  OscWriter.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef OscWriter_hpp
+#define OscWriter_hpp
+
+#include <stdio.h>
+
+#endif /* OscWriter_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * OscWriter:
+ *  Encodes OSC bundles and messages straight into a buffer
+ *  that's allocated once, for output that goes out every
+ *  frame with hundreds of messages. ofxOscMessage allocates
+ *  for every argument, this never does after setup.
+ *
+ *  One level of bundle, int32/int64/float32/string/timetag
+ *  arguments, which is all our output needs. The caller
+ *  checks hasRoom() before each message; writes past the end
+ *  are dropped and flagged instead of overrunning, and a
+ *  message that overflowed can be cut off with truncate().
+ */
+
+class OscWriter{
+
+public:
+
+    OscWriter();
+
+    void setup(size_t capacity);
+
+    //start over with an empty buffer
+    void clear();
+
+    //throw away everything past size, e.g. a message that
+    //didn't fit, and clear the overflow flag
+    void truncate(size_t size);
+
+    //OSC time tags are NTP format. 1 means "immediately"
+    void beginBundle(uint64_t timeTag = IMMEDIATELY);
+    void endBundle();
+
+    //typeTags without the leading ',' e.g. "iff"
+    void beginMessage(const char * address, const char * typeTags);
+    void endMessage();
+
+    void addInt(int32_t value);
+    void addInt64(int64_t value);
+    void addFloat(float value);
+    void addString(const char * value);
+    void addTimeTag(uint64_t value);
+
+    //NTP time tag for a time from ofGetElapsedTimeMicros(), in
+    //wall clock time so receivers can compare it to their own
+    static uint64_t getTimeTag(uint64_t elapsedMicros);
+
+    //bytes a message with this address and these tags takes,
+    //including its size prefix inside a bundle. No strings
+    static size_t getMessageSize(const char * address, const char * typeTags);
+
+    bool hasRoom(size_t bytes) const;
+    bool hasOverflowed() const;
+
+    const char * getData() const;
+    size_t getSize() const;
+
+    static const uint64_t IMMEDIATELY = 1;
+
+
+private:
+
+    void writeString(const char * s);
+    void write32(uint32_t value);
+    void write64(uint64_t value);
+
+    //strings are padded to 4 bytes with at least one 0
+    static size_t paddedLength(const char * s);
+
+    vector<char> buffer;
+    size_t size;
+    bool bOverflow;
+
+    //messages inside a bundle get a size prefix, this is
+    //where the open message's prefix is
+    bool bInBundle;
+    size_t messageSizePos;
+
+};
@@ -0,0 +1,213 @@
+//
+//  PipelineData.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef PipelineData_hpp
+#define PipelineData_hpp
+
+#include <stdio.h>
+
+#endif /* PipelineData_hpp */
+
+#include "ofMain.h"
+#include "ofxCv.h"
+#include "BinaryMask.hpp"
+#include "BlobLabeler.hpp"
+#include "BlobTracker.hpp"
+#include "ZoneMap.hpp"
+#include "CameraMap.hpp"
+#include "CachedTexture.hpp"
+#include "IntegralImage.hpp"
+
+#pragma once
+
+
+/*
+ * Everything that goes into and comes out of one tick
+ * of the detection pipeline. Shared between the Aggregator
+ * and the pipeline stages.
+ */
+
+struct PipelineSettings{
+
+    bool useMask;
+
+    int threshold;
+    bool useBgDiff;
+    int learningTime;
+    bool selectiveLearning;
+    bool useMultiModalBg;
+    bool usePerCameraBg;
+    bool resetBackground;
+
+    //seconds between background saves, 0 = never
+    float bgSaveInterval;
+    int numErosions;
+    int numDilations;
+
+    bool useParallelBands;
+    int numBands;
+
+    int minBlobArea;
+    int maxBlobArea;
+    int persistence;    //frames a track survives without a blob
+    int maxDistance;    //track gate, pixels from the prediction
+
+    //contour outlines are only for drawing, so only
+    //trace them when a view is showing them
+    bool traceContours;
+
+    bool sendOSC;
+    float waitBeforeOSC;
+    float maxOSCSendRate;
+
+    //only send what changed plus a heartbeat, see OscStage.
+    //Tracks need to move updateDistance pixels and occupancy
+    //occupancyStep (fraction) before they're resent
+    bool deltaOSC;
+    float heartbeatInterval;
+    float updateDistance;
+    float occupancyStep;
+
+    //OSC bundles carry the capture time instead of
+    //"immediately", plus per-camera frame ages
+    bool useTimeTags;
+
+    //one /blob message per tracked blob every frame, with
+    //positions on the floor at floorScale cm per pixel
+    bool sendBlobs;
+    float floorScale;
+
+    //extrapolate tracks past the capture->send latency,
+    //plus this much more (seconds) of look-ahead
+    bool usePrediction;
+    float predictionHorizon;
+
+    //put every frame and the blob table in shared memory
+    //for local processes, see SharedFrameRing
+    bool publishShared;
+
+    //low rate, downscaled composite + threshold + blob boxes
+    //over UDP, see PreviewStreamer. Budget is the fraction of
+    //a core the encoder may use
+    bool streamPreview;
+    int previewScale;
+    float previewFps;
+    float previewBudget;
+
+    //stage names in the order they should run.
+    //A leading '-' keeps the stage but switches it off
+    vector<string> stageOrder;
+
+};
+
+struct PipelineLayout{
+    int masterWidth;
+    int masterHeight;
+
+    //size of one camera before rotation
+    int tileWidth;
+    int tileHeight;
+
+    vector<ofVec2f> positions;
+    vector<int> rotations;
+};
+
+struct PipelineFrame{
+    vector<ofPixels> tiles;
+    PipelineLayout layout;
+    PipelineSettings settings;
+
+    //null if the mask is switched off. Never modified
+    //after being sent, ofApp makes a new one on edits
+    shared_ptr<const BinaryMask> mask;
+
+    //zones rasterized at the composite size, innermost first.
+    //Same lifetime rules as the mask
+    shared_ptr<const ZoneMap> zoneMap;
+
+    //which camera each composite pixel came from, built
+    //from the layout above. Same lifetime rules as the mask
+    shared_ptr<const CameraMap> cameraMap;
+
+    //ofGetElapsedTimeMicros() when each tile was captured
+    //(0 = unknown) and the newest of them
+    vector<uint64_t> tileCaptureTimes;
+    uint64_t captureTime;
+
+    //per-camera background subtraction results in tile
+    //coordinates. Empty when it's done on the composite
+    vector<ofPixels> tileThresh;
+    vector<ofPixels> tileForeground;
+    vector<ofPixels> tileBackground;
+    size_t tileModelBytes;
+};
+
+struct ZoneOccupancy{
+    int area;               //pixels in the zone
+    int occupied;           //of those, pixels over the threshold
+    float fraction;         //occupied / area
+    float meanIntensity;    //foreground value over the occupied pixels
+};
+
+struct StageTiming{
+    string name;
+    bool bEnabled;
+    float wallTime;     //ms
+    float cpuTime;      //ms, Aggregator thread + band workers
+    float throughput;   //megapixels per second of wall time
+};
+
+struct PipelineResult{
+
+    unsigned long long frameNum;
+
+    //new for every snapshot (frameNum restarts with the
+    //thread), views keep their textures until it changes
+    uint64_t generation;
+
+    ofPixels masterPix;
+    ofPixels processedPix;
+    ofPixels threshPix;
+    ofPixels backgroundPix;
+    ofPixels foregroundPix;
+
+    //summed-area table of threshPix/foregroundPix built by the
+    //background bands for occupancy. Cleared by anything that
+    //changes threshPix after that, empty if it wasn't built
+    IntegralImage threshIntegral;
+
+    //what detection runs on. Runs are grouped per blob
+    vector<Blob> blobs;
+    vector<BlobRun> blobRuns;
+
+    //blobs with IDs that last from frame to frame
+    vector<Track> tracks;
+
+    //outlines for drawing, empty unless settings.traceContours
+    ofxCv::ContourFinder contours;
+
+    int activeZone;
+
+    //one per zone, empty if the occupancy stage didn't run
+    vector<ZoneOccupancy> zoneOccupancy;
+
+    //innermost zone a predicted track position is in, -1 if none
+    int predictedZone;
+
+    //newest capture to the zone test, ms
+    float captureLatency;
+
+    //only filled in when a /detected message went out
+    string consoleLine;
+
+    float processingTime;   //ms
+
+    //which background engine ran and how much it holds
+    string backgroundModelName;
+    size_t backgroundMemory;    //bytes
+
+    vector<StageTiming> stageTimings;
+
+};
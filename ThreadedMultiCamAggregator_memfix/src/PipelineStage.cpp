@@ -0,0 +1,1138 @@
+//
+//  PipelineStage.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "PipelineStage.hpp"
+
+
+PipelineStage::PipelineStage(string _name){
+
+    name = _name;
+    bEnabled = true;
+
+}
+
+PipelineStage::~PipelineStage(){
+
+}
+
+void PipelineStage::reset(){
+
+}
+
+
+
+//-----------------------------COMPOSITE-----------------------------
+CompositeStage::CompositeStage(): PipelineStage("composite"){
+
+    bFuseMask = false;
+
+}
+
+void CompositeStage::composite(vector<ofPixels> & tiles, const PipelineLayout & layout, ofPixels *dst, ofPixels *maskedDst, const BinaryMask *mask){
+
+    int w = layout.masterWidth;
+    int h = layout.masterHeight;
+
+    //all feeds are pasted into the dst objects so we need to
+    //clear them every frame to avoid pixel build up
+    if( dst ){
+        dst -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+        dst -> setColor(ofColor(0));
+    }
+
+    if( maskedDst ){
+        maskedDst -> allocate(w, h, OF_IMAGE_GRAYSCALE);
+        maskedDst -> setColor(ofColor(0));
+    }
+
+
+    //Now paste the new frame into the dst objects
+    //with any rotations specified. Later tiles win where
+    //they overlap, same as blendInto() did for gray pixels
+    for (int i = 0; i < tiles.size(); i++){
+
+        if( !tiles[i].isAllocated() ) continue;
+
+        if( layout.rotations[i] != 0 ){
+            tiles[i].rotate90( layout.rotations[i] );
+        }
+
+        if( tiles[i].getNumChannels() != 1 ){
+            tiles[i].setImageType(OF_IMAGE_GRAYSCALE);
+        }
+
+        int tw = tiles[i].getWidth();
+        int th = tiles[i].getHeight();
+        int x0 = layout.positions[i].x;
+        int y0 = layout.positions[i].y;
+
+        //crop to the composite
+        int left = std::max(0, -x0);
+        int right = std::min(tw, w - x0);
+        int top = std::max(0, -y0);
+        int bottom = std::min(th, h - y0);
+
+        if( right <= left ) continue;
+
+        for(int y = top; y < bottom; y++){
+
+            const unsigned char *src = tiles[i].getData() + y * tw + left;
+            int offset = (y0 + y) * w + x0 + left;
+
+            if( dst ){
+                memcpy(dst -> getData() + offset, src, right - left);
+            }
+
+            if( maskedDst ){
+                mask -> copyUnmasked(x0 + left, y0 + y, right - left, src, maskedDst -> getData() + offset);
+            }
+        }
+
+    }
+
+}
+
+void CompositeStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    //a mask that doesn't match the composite masks nothing
+    const BinaryMask *mask = NULL;
+
+    if( bFuseMask && frame.settings.useMask && frame.mask
+        && frame.mask -> getWidth() == frame.layout.masterWidth && frame.mask -> getHeight() == frame.layout.masterHeight ){
+        mask = frame.mask.get();
+    }
+
+    if( mask ){
+        composite(frame.tiles, frame.layout, &r.masterPix, &r.processedPix, mask);
+    } else {
+        composite(frame.tiles, frame.layout, &r.masterPix);
+
+        if( bFuseMask ) r.processedPix = r.masterPix;
+    }
+
+    //with per-camera backgrounds the cameras already did the
+    //subtraction, so only their outputs need stitching
+    if( !frame.tileThresh.empty() ){
+
+        if( mask ){
+            composite(frame.tileThresh, frame.layout, NULL, &r.threshPix, mask);
+            composite(frame.tileForeground, frame.layout, NULL, &r.foregroundPix, mask);
+        } else {
+            composite(frame.tileThresh, frame.layout, &r.threshPix);
+            composite(frame.tileForeground, frame.layout, &r.foregroundPix);
+        }
+
+        composite(frame.tileBackground, frame.layout, &r.backgroundPix);
+    }
+
+}
+
+
+
+//-----------------------------MASK-----------------------------
+MaskStage::MaskStage(): PipelineStage("mask"){
+
+    bFused = false;
+
+}
+
+void MaskStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    if( bFused ) return;
+
+    //masterPix will hold the raw composite pixels
+    //We'll subtract the mask from it and store it in processedPix
+    if( frame.settings.useMask && frame.mask ){
+
+        frame.mask -> apply(r.masterPix, r.processedPix);
+
+        //per-camera foreground gets the same treatment
+        if( r.threshPix.isAllocated() ){
+            ofPixels masked;
+            frame.mask -> apply(r.threshPix, masked);
+            r.threshPix.swap(masked);
+
+            frame.mask -> apply(r.foregroundPix, masked);
+            r.foregroundPix.swap(masked);
+        }
+
+    } else {
+        r.processedPix = r.masterPix;
+    }
+
+}
+
+
+
+//-----------------------------BACKGROUND/THRESHOLD-----------------------------
+BackgroundStage::BackgroundStage(): PipelineStage("background"){
+
+    bFuseErode = false;
+    bFuseDilate = false;
+    bBuildIntegral = false;
+
+    bFirstFrame = true;
+    lastSaveTime = 0;
+
+    bandPool.setup(1);
+
+    store.setup();
+
+}
+
+void BackgroundStage::reset(){
+
+    bandPool.reset();
+
+    //pick up where we left off rather than learning from scratch
+    if( lastBackground.isAllocated() ){
+        bandPool.seed(lastBackground);
+    }
+
+}
+
+void BackgroundStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    //one band runs on this thread, more run across cores
+    int bands = s.useParallelBands ? s.numBands : 1;
+
+    if( bandPool.getNumBands() != bands ){
+        bandPool.setup(bands);
+    }
+
+    if( !frame.tileThresh.empty() ){
+        processTiles(frame, r);
+    } else if( !processComposite(frame, r) ){
+        return;
+    }
+
+
+    //----------persistence----------
+    if( s.useBgDiff ){
+
+        lastBackground = r.backgroundPix;
+        lastLayout = frame.layout;
+
+        //the store thread does the disk work
+        if( s.bgSaveInterval > 0 && ofGetElapsedTimef() - lastSaveTime > s.bgSaveInterval ){
+            store.save(lastBackground, lastLayout);
+            lastSaveTime = ofGetElapsedTimef();
+        }
+
+    }
+
+}
+
+
+
+bool BackgroundStage::processComposite(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    //if the mask stage is off, start from the raw composite
+    const ofPixels &src = r.processedPix.isAllocated() ? r.processedPix : r.masterPix;
+
+    if( !src.isAllocated() ) return false;
+
+
+    //----------warm start----------
+    if( s.useBgDiff && !s.resetBackground ){
+
+        ofPixels oldBackground;
+        PipelineLayout oldLayout;
+        bool bRemap = false;
+
+        if( bFirstFrame ){
+            bRemap = store.load(oldBackground, oldLayout);
+        } else if( lastBackground.isAllocated() && !BackgroundStore::isSameLayout(lastLayout, frame.layout) ){
+            oldBackground = lastBackground;
+            oldLayout = lastLayout;
+            bRemap = true;
+        }
+
+        //cameras go to their new spots, anything
+        //not covered before starts from this frame
+        if( bRemap ){
+            ofPixels seed = src;
+            BackgroundStore::remap(oldBackground, oldLayout, frame.layout, seed);
+            bandPool.seed(seed);
+        }
+
+        bFirstFrame = false;
+
+    }
+
+    PostCompositeThreadCV::Settings bandSettings;
+    bandSettings.threshold = s.threshold;
+    bandSettings.useBgDiff = s.useBgDiff;
+    bandSettings.learningTime = s.learningTime;
+    bandSettings.selectiveLearning = s.selectiveLearning;
+    bandSettings.backgroundModel = s.useMultiModalBg ? BackgroundModel::MULTI_MODAL : BackgroundModel::RUNNING_AVERAGE;
+    bandSettings.resetBackground = s.resetBackground;
+    bandSettings.numErosions = bFuseErode ? s.numErosions : 0;
+    bandSettings.numDilations = bFuseDilate ? s.numDilations : 0;
+
+    //BG needs to start over if we switch back to BG diff
+    if( !s.useBgDiff ){
+        bandPool.reset();
+    }
+
+    bandPool.process(src, bandSettings, r.threshPix, r.foregroundPix, r.backgroundPix, bBuildIntegral ? &r.threshIntegral : NULL);
+
+    if( s.useBgDiff ){
+        r.backgroundModelName = s.useMultiModalBg ? "Multi-modal" : "Running average";
+    } else {
+        r.backgroundModelName = "None";
+    }
+
+    r.backgroundMemory = bandPool.getModelMemory();
+
+    return true;
+
+}
+
+void BackgroundStage::processTiles(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    //the composite stage already stitched the per-camera output
+    if( !r.threshPix.isAllocated() ) return;
+
+    //the saved background is loaded straight into the
+    //cameras at startup, nothing to do here for that
+    bFirstFrame = false;
+
+    //run the fused erode/dilate across the bands. The mask is
+    //already 0/255 so the plain threshold passes it through
+    if( bFuseErode || bFuseDilate ){
+
+        PostCompositeThreadCV::Settings bandSettings;
+        bandSettings.threshold = 127;
+        bandSettings.useBgDiff = false;
+        bandSettings.learningTime = s.learningTime;
+        bandSettings.selectiveLearning = false;
+        bandSettings.backgroundModel = BackgroundModel::RUNNING_AVERAGE;
+        bandSettings.resetBackground = false;
+        bandSettings.numErosions = bFuseErode ? s.numErosions : 0;
+        bandSettings.numDilations = bFuseDilate ? s.numDilations : 0;
+
+        ofPixels thresh, unusedFg, unusedBg;
+        bandPool.process(r.threshPix, bandSettings, thresh, unusedFg, unusedBg);
+
+        r.threshPix.swap(thresh);
+    }
+
+    r.backgroundModelName = string("Per-camera ") + (s.useMultiModalBg ? "multi-modal" : "running average");
+    r.backgroundMemory = frame.tileModelBytes;
+
+}
+
+
+
+//-----------------------------ERODE-----------------------------
+ErodeStage::ErodeStage(): PipelineStage("erode"){
+
+    bFused = false;
+
+}
+
+void ErodeStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    if( bFused || !r.threshPix.isAllocated() ) return;
+
+    if( frame.settings.numErosions <= 0 ) return;
+
+    bits.setFromThreshold(r.threshPix, 127);
+    bits.erode(frame.settings.numErosions);
+    bits.toPixels(r.threshPix);
+
+    r.threshIntegral.clear();
+
+}
+
+
+
+//-----------------------------DILATE-----------------------------
+DilateStage::DilateStage(): PipelineStage("dilate"){
+
+    bFused = false;
+
+}
+
+void DilateStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    if( bFused || !r.threshPix.isAllocated() ) return;
+
+    if( frame.settings.numDilations <= 0 ) return;
+
+    bits.setFromThreshold(r.threshPix, 127);
+    bits.dilate(frame.settings.numDilations);
+    bits.toPixels(r.threshPix);
+
+    r.threshIntegral.clear();
+
+}
+
+
+
+//-----------------------------BLOBS-----------------------------
+BlobStage::BlobStage(): PipelineStage("blobs"){
+
+}
+
+void BlobStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    if( !r.threshPix.isAllocated() ) return;
+
+    PipelineSettings &s = frame.settings;
+
+    //label across the same number of bands as the pixel work
+    int bands = s.useParallelBands ? s.numBands : 1;
+
+    if( labeler.getNumBands() != bands ){
+        labeler.setup(bands);
+    }
+
+    bits.setFromThreshold(r.threshPix, 127);
+
+    //foreground is how far above the background each pixel is
+    //and every blob picks up its zone and camera from the maps on the way
+    labeler.label(bits, &r.foregroundPix, s.minBlobArea, s.maxBlobArea, frame.zoneMap.get(), frame.cameraMap.get());
+
+    r.blobs = labeler.getBlobs();
+    r.blobRuns = labeler.getRuns();
+
+}
+
+
+
+//-----------------------------TRACK-----------------------------
+TrackStage::TrackStage(): PipelineStage("track"){
+
+    lastTime = -1;
+    lastCaptureTime = 0;
+
+}
+
+void TrackStage::reset(){
+
+    tracker.reset();
+    lastTime = -1;
+    lastCaptureTime = 0;
+
+}
+
+void TrackStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    float now = ofGetElapsedTimef();
+    float dt = lastTime < 0 ? 1/30.0f : now - lastTime;
+    lastTime = now;
+
+    //time between captures is what the blobs actually moved in,
+    //fall back on our own clock if no newer frame came in
+    if( frame.captureTime > lastCaptureTime && lastCaptureTime > 0 ){
+        dt = (frame.captureTime - lastCaptureTime)/1000000.0f;
+    }
+
+    if( frame.captureTime > lastCaptureTime ){
+        lastCaptureTime = frame.captureTime;
+    }
+
+    tracker.setPersistence(s.persistence);
+    tracker.setMaximumDistance(s.maxDistance);
+
+    tracker.update(r.blobs, dt);
+
+    r.tracks = tracker.getTracks();
+
+}
+
+
+
+//-----------------------------PREDICT-----------------------------
+const float PredictStage::MAX_LEAD = 1.0f;
+
+PredictStage::PredictStage(): PipelineStage("predict"){
+
+}
+
+void PredictStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    uint64_t now = ofGetElapsedTimeMicros();
+
+    r.predictedZone = -1;
+    r.captureLatency = frame.captureTime > 0 && now > frame.captureTime ? (now - frame.captureTime)/1000.0f : 0;
+
+    if( !s.usePrediction ) return;
+
+    //----------EXTRAPOLATE----------
+    for(int i = 0; i < r.tracks.size(); i++){
+
+        Track &t = r.tracks[i];
+
+        //the camera this track was seen by sets how stale it is
+        uint64_t captured = frame.captureTime;
+        int cam = -1;
+
+        if( t.blobIndex >= 0 && t.blobIndex < r.blobs.size() ){
+            cam = r.blobs[t.blobIndex].camera;
+        } else if( frame.cameraMap ){
+            cam = frame.cameraMap -> getCamera(t.pos.x, t.pos.y);
+        }
+
+        if( cam != -1 && cam < frame.tileCaptureTimes.size() && frame.tileCaptureTimes[cam] > 0 ){
+            captured = frame.tileCaptureTimes[cam];
+        }
+
+        float lead = s.predictionHorizon;
+
+        if( captured > 0 && now > captured ){
+            lead += (now - captured)/1000000.0f;
+        }
+
+        t.predictionLead = ofClamp(lead, 0, MAX_LEAD);
+        t.predictedPos = t.pos + t.vel * t.predictionLead;
+
+    }
+
+    //----------PREDICTED ZONE----------
+    if( !frame.zoneMap ) return;
+
+    const ZoneMap &zones = *frame.zoneMap;
+
+    for(int i = 0; i < r.tracks.size(); i++){
+
+        const Track &t = r.tracks[i];
+
+        int zone;
+
+        //move the whole blob if we have it, coasting tracks only have a point
+        if( t.blobIndex >= 0 && t.blobIndex < r.blobs.size() ){
+            zone = ZoneStage::blobZone(zones, r.blobs[t.blobIndex], r.blobRuns, t.predictedPos - t.pos);
+        } else {
+            zone = zones.getZone(t.predictedPos.x, t.predictedPos.y);
+        }
+
+        if( zone != -1 && (r.predictedZone == -1 || zone < r.predictedZone) ){
+            r.predictedZone = zone;
+        }
+
+    }
+
+}
+
+
+
+//-----------------------------CONTOURS-----------------------------
+ContoursStage::ContoursStage(): PipelineStage("contours"){
+
+}
+
+void ContoursStage::reset(){
+
+    contourFinder = ofxCv::ContourFinder();
+
+}
+
+void ContoursStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    if( !s.traceContours || !r.threshPix.isAllocated() ) return;
+
+    //Define contour finder
+    contourFinder.setMinArea(s.minBlobArea);
+    contourFinder.setMaxArea(s.maxBlobArea);
+    contourFinder.setThreshold(254);  //only detect white
+
+    // wait before forgetting something
+    contourFinder.getTracker().setPersistence(s.persistence);
+
+    // an object can move up to X pixels per frame
+    contourFinder.getTracker().setMaximumDistance(s.maxDistance);
+
+    //find dem blobs
+    contourFinder.findContours(r.threshPix);
+
+    //snapshot of the contours for the later stages and for drawing
+    r.contours = contourFinder;
+
+}
+
+
+
+//-----------------------------ZONES-----------------------------
+ZoneStage::ZoneStage(): PipelineStage("zones"){
+
+}
+
+int ZoneStage::blobZone(const ZoneMap & zones, const Blob & b, const vector<BlobRun> & runs, const ofVec2f & offset){
+
+    int dx = roundf(offset.x);
+    int dy = roundf(offset.y);
+
+    int zone = -1;
+
+    for(int k = b.firstRun; k < b.firstRun + b.numRuns; k++){
+
+        const BlobRun &run = runs[k];
+
+        int z = zones.getZone(run.y + dy, run.x0 + dx, run.x1 + dx);
+
+        if( z != -1 && (zone == -1 || z < zone) ){
+            zone = z;
+
+            //can't do better than the innermost
+            if( zone == 0 ) break;
+        }
+
+    }
+
+    return zone;
+
+}
+
+void ZoneStage::process(PipelineFrame &, PipelineResult & r){
+
+    //every blob already knows the innermost zone it touches
+    //from labeling, so this is just the innermost of those
+
+    r.activeZone = -1;
+
+    for(int i = 0; i < r.blobs.size(); i++){
+
+        int zone = r.blobs[i].zone;
+
+        if( zone != -1 && (r.activeZone == -1 || zone < r.activeZone) ){
+            r.activeZone = zone;
+        }
+
+    }
+
+}
+
+
+
+//-----------------------------OCCUPANCY-----------------------------
+OccupancyStage::OccupancyStage(): PipelineStage("occupancy"){
+
+}
+
+void OccupancyStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    r.zoneOccupancy.clear();
+
+    if( !frame.zoneMap || !r.threshPix.isAllocated() ) return;
+
+    const ZoneMap &zones = *frame.zoneMap;
+
+    if( zones.getWidth() != r.threshPix.getWidth() || zones.getHeight() != r.threshPix.getHeight() ) return;
+
+    //normally the background bands built it along with the
+    //threshold, otherwise it takes a pass of its own
+    const IntegralImage *table = &r.threshIntegral;
+
+    if( r.threshIntegral.getWidth() != zones.getWidth() || r.threshIntegral.getHeight() != zones.getHeight() ){
+        integral.setFromThreshold(r.threshPix, 127, &r.foregroundPix);
+        table = &integral;
+    }
+
+    for(int i = 0; i < zones.getNumZones(); i++){
+
+        ZoneOccupancy o;
+        o.area = zones.getZoneArea(i);
+
+        uint64_t occupied = 0;
+        uint64_t intensity = 0;
+
+        int x0, y0, x1, y1;
+
+        if( zones.getRectangle(i, x0, y0, x1, y1) ){
+
+            occupied = table -> getCount(x0, y0, x1, y1);
+            intensity = table -> getIntensity(x0, y0, x1, y1);
+
+        } else {
+
+            //one row high rectangle per span
+            const vector<ZoneMap::Span> &spans = zones.getSpans(i);
+            const vector<int> &rowStart = zones.getRowStarts(i);
+
+            for(int y = 0; y < zones.getHeight(); y++){
+                for(int k = rowStart[y]; k < rowStart[y + 1]; k++){
+                    occupied += table -> getCount(spans[k].start, y, spans[k].end, y + 1);
+                    intensity += table -> getIntensity(spans[k].start, y, spans[k].end, y + 1);
+                }
+            }
+
+        }
+
+        o.occupied = occupied;
+        o.fraction = o.area > 0 ? occupied / (float)o.area : 0;
+        o.meanIntensity = occupied > 0 ? intensity / (float)occupied : 0;
+
+        r.zoneOccupancy.push_back(o);
+
+    }
+
+}
+
+
+
+//-----------------------------PUBLISH-----------------------------
+PublishStage::PublishStage(): PipelineStage("publish"){
+
+}
+
+void PublishStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    if( !frame.settings.publishShared ){
+        if( ring.isSetup() ) ring.close();
+        return;
+    }
+
+    //enough slots that a reader has a few frames to look
+    //at one before it's reused
+    if( !ring.isSetup() ){
+        ring.setup(SharedFrameRing::DEFAULT_NAME, 4, r.masterPix.getWidth(), r.masterPix.getHeight(), 1024);
+    }
+
+    ring.publish(r, frame.captureTime);
+
+}
+
+
+
+//-----------------------------PREVIEW-----------------------------
+PreviewStage::PreviewStage(): PipelineStage("preview"){
+
+}
+
+void PreviewStage::setup(shared_ptr<PreviewStreamer> _streamer){
+
+    streamer = _streamer;
+
+}
+
+void PreviewStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    if( !s.streamPreview || !streamer ) return;
+
+    streamer -> submit(r, s.previewScale, s.previewFps, s.previewBudget);
+
+}
+
+
+
+//-----------------------------OSC-----------------------------
+const int OscStage::MAX_PACKET_SIZE;
+
+OscStage::OscStage(): PipelineStage("osc"){
+
+    lastZoneSendTime = 0;
+    lastOccupancySendTime = 0;
+
+    lastSentZone = -1;
+    lastSentPredictedZone = -1;
+    sequence = 0;
+    lastHeartbeatTime = 0;
+
+    writer.setup(MAX_PACKET_SIZE);
+
+}
+
+void OscStage::setup(shared_ptr<OscSender> _sender){
+
+    sender = _sender;
+
+}
+
+void OscStage::process(PipelineFrame & frame, PipelineResult & r){
+
+    PipelineSettings &s = frame.settings;
+
+    //with prediction on, report whichever is further in: where
+    //blobs are now or where they're about to be
+    int zoneToSend = r.activeZone;
+
+    if( s.usePrediction && r.predictedZone != -1 && (zoneToSend == -1 || r.predictedZone < zoneToSend) ){
+        zoneToSend = r.predictedZone;
+    }
+
+    if( !s.sendOSC || !sender ) return;
+
+    //everything from this tick goes out as one bundle
+    batch.messages.clear();
+
+    //with deltaOSC all of this is replaced by sendChanges()
+    //occupancy goes out whether or not anything is detected,
+    //one message per zone
+    if( !s.deltaOSC && !r.zoneOccupancy.empty() && ofGetElapsedTimef() - lastOccupancySendTime > s.maxOSCSendRate && ofGetElapsedTimef() > s.waitBeforeOSC ){
+
+        for(int i = 0; i < r.zoneOccupancy.size(); i++){
+
+            const ZoneOccupancy &o = r.zoneOccupancy[i];
+
+            ofxOscMessage occupancy;
+
+            occupancy.setAddress("/occupancy");
+            occupancy.addIntArg( i );
+            occupancy.addFloatArg( o.fraction );
+            occupancy.addIntArg( o.occupied );
+            occupancy.addFloatArg( o.meanIntensity );
+
+            batch.messages.push_back(occupancy);
+        }
+
+        lastOccupancySendTime = ofGetElapsedTimef();
+    }
+
+    //if we found something, send the message
+    //only send at the desired rate && wait after startup
+    if( !s.deltaOSC && zoneToSend != -1 && ofGetElapsedTimef() - lastZoneSendTime > s.maxOSCSendRate && ofGetElapsedTimef() > s.waitBeforeOSC ){
+
+        ofxOscMessage zone;
+
+        zone.setAddress("/detected");
+        zone.addIntArg( zoneToSend );
+        zone.addIntArg( r.blobs.size() );
+
+        batch.messages.push_back(zone);
+
+        //lets the receiver tell a prediction from a detection
+        if( s.usePrediction && r.predictedZone != -1 ){
+
+            ofxOscMessage predicted;
+
+            predicted.setAddress("/predicted");
+            predicted.addIntArg( r.predictedZone );
+            predicted.addFloatArg( r.captureLatency + s.predictionHorizon * 1000 );
+
+            batch.messages.push_back(predicted);
+        }
+
+        r.consoleLine = getConsoleLine(r, zoneToSend);
+
+        lastZoneSendTime = ofGetElapsedTimef();
+
+    }
+
+    if( s.deltaOSC && ofGetElapsedTimef() > s.waitBeforeOSC ){
+        sendChanges(frame, r, zoneToSend);
+    }
+
+    //bundles are stamped with when the newest tile was captured,
+    //and say how old every camera's tile was at that point
+    uint64_t timeTag = OscWriter::IMMEDIATELY;
+
+    if( s.useTimeTags && frame.captureTime > 0 ){
+
+        timeTag = OscWriter::getTimeTag(frame.captureTime);
+
+        if( !batch.messages.empty() ){
+
+            ofxOscMessage ages;
+
+            ages.setAddress("/frameAges");
+
+            for(int i = 0; i < frame.tileCaptureTimes.size(); i++){
+                uint64_t captured = frame.tileCaptureTimes[i];
+                ages.addFloatArg( captured > 0 && captured <= frame.captureTime ? (frame.captureTime - captured)/1000.0f : -1 );
+            }
+
+            batch.messages.push_back(ages);
+        }
+    }
+
+    batch.timeTag = timeTag;
+
+    if( s.sendBlobs && ofGetElapsedTimef() > s.waitBeforeOSC ){
+        encodeBlobs(r, s.floorScale, timeTag, writer, batch);
+    }
+
+    //hands off to the sender thread, never waits on the network
+    sender -> send(batch);
+
+}
+
+string OscStage::getConsoleLine(const PipelineResult & r, int zone){
+
+    //cameras of the blobs that are in the zone, each blob
+    //knows its own from labeling
+    string cams;
+
+    for(int i = 0; i < r.blobs.size(); i++){
+        if( r.blobs[i].zone == zone ){
+            cams += (cams.empty() ? "" : " ") + ofToString(r.blobs[i].camera);
+        }
+    }
+
+    return "- Time: " + ofToString(ofGetElapsedTimef(), 2) + ", Cam Num: " + (cams.empty() ? "-1" : cams);
+
+}
+
+ofxOscMessage & OscStage::addEvent(const string & address){
+
+    //every event carries the next sequence number so the
+    //receiver can tell when one went missing
+    batch.messages.push_back( ofxOscMessage() );
+
+    ofxOscMessage &m = batch.messages.back();
+
+    m.setAddress(address);
+    m.addIntArg( ++sequence );
+
+    return m;
+
+}
+
+void OscStage::sendChanges(PipelineFrame & frame, PipelineResult & r, int zoneToSend){
+
+    PipelineSettings &s = frame.settings;
+
+    //----------TRACKS----------
+    for(int i = 0; i < r.tracks.size(); i++){
+
+        const Track &t = r.tracks[i];
+
+        map<int, SentTrack>::iterator it = sentTracks.find(t.id);
+
+        //coasting tracks stay in the zone they were last seen in
+        int zone = -1;
+
+        if( t.blobIndex != -1 ){
+            zone = r.blobs[t.blobIndex].zone;
+        } else if( it != sentTracks.end() ){
+            zone = it -> second.zone;
+        }
+
+        if( it == sentTracks.end() ){
+
+            ofxOscMessage &m = addEvent("/track/new");
+            m.addIntArg( t.id );
+            m.addFloatArg( t.pos.x );
+            m.addFloatArg( t.pos.y );
+            m.addIntArg( zone );
+
+            if( zone != -1 ){
+                ofxOscMessage &enter = addEvent("/zone/enter");
+                enter.addIntArg( zone );
+                enter.addIntArg( t.id );
+            }
+
+            SentTrack &st = sentTracks[t.id];
+            st.pos = t.pos;
+            st.zone = zone;
+            st.lastFrame = r.frameNum;
+
+            continue;
+        }
+
+        SentTrack &st = it -> second;
+        st.lastFrame = r.frameNum;
+
+        if( zone != st.zone ){
+
+            if( st.zone != -1 ){
+                ofxOscMessage &exit = addEvent("/zone/exit");
+                exit.addIntArg( st.zone );
+                exit.addIntArg( t.id );
+            }
+
+            if( zone != -1 ){
+                ofxOscMessage &enter = addEvent("/zone/enter");
+                enter.addIntArg( zone );
+                enter.addIntArg( t.id );
+            }
+        }
+
+        //small jitter isn't worth a message
+        if( zone != st.zone || t.pos.distance(st.pos) > s.updateDistance ){
+
+            ofxOscMessage &m = addEvent("/track/update");
+            m.addIntArg( t.id );
+            m.addFloatArg( t.pos.x );
+            m.addFloatArg( t.pos.y );
+            m.addIntArg( zone );
+
+            st.pos = t.pos;
+            st.zone = zone;
+        }
+
+    }
+
+    //anything that wasn't in this frame's tracks is gone
+    for(map<int, SentTrack>::iterator it = sentTracks.begin(); it != sentTracks.end(); ){
+
+        if( it -> second.lastFrame == r.frameNum ){
+            ++it;
+            continue;
+        }
+
+        if( it -> second.zone != -1 ){
+            ofxOscMessage &exit = addEvent("/zone/exit");
+            exit.addIntArg( it -> second.zone );
+            exit.addIntArg( it -> first );
+        }
+
+        ofxOscMessage &lost = addEvent("/track/lost");
+        lost.addIntArg( it -> first );
+
+        sentTracks.erase(it++);
+
+    }
+
+    //----------ZONES----------
+    //same arguments as the fixed rate messages with the
+    //sequence number first, so they get their own addresses
+    //and /detected etc. always look the same to a receiver
+    if( zoneToSend != lastSentZone ){
+
+        ofxOscMessage &zone = addEvent("/delta/detected");
+        zone.addIntArg( zoneToSend );
+        zone.addIntArg( r.blobs.size() );
+
+        r.consoleLine = getConsoleLine(r, zoneToSend);
+
+        lastSentZone = zoneToSend;
+    }
+
+    int predictedZone = s.usePrediction ? r.predictedZone : -1;
+
+    if( predictedZone != lastSentPredictedZone ){
+
+        ofxOscMessage &predicted = addEvent("/delta/predicted");
+        predicted.addIntArg( predictedZone );
+        predicted.addFloatArg( r.captureLatency + s.predictionHorizon * 1000 );
+
+        lastSentPredictedZone = predictedZone;
+    }
+
+    //occupancy changes a little almost every frame, only
+    //report a zone when it's moved by more than occupancyStep
+    lastSentOccupancy.resize(r.zoneOccupancy.size(), -1);
+
+    for(int i = 0; i < r.zoneOccupancy.size(); i++){
+
+        const ZoneOccupancy &o = r.zoneOccupancy[i];
+
+        //always report going to or from empty
+        bool bWasEmpty = lastSentOccupancy[i] == 0;
+        bool bChanged = lastSentOccupancy[i] < 0 || bWasEmpty != (o.occupied == 0) || fabs(o.fraction - lastSentOccupancy[i]) >= s.occupancyStep;
+
+        if( !bChanged ) continue;
+
+        ofxOscMessage &occupancy = addEvent("/delta/occupancy");
+        occupancy.addIntArg( i );
+        occupancy.addFloatArg( o.fraction );
+        occupancy.addIntArg( o.occupied );
+        occupancy.addFloatArg( o.meanIntensity );
+
+        lastSentOccupancy[i] = o.fraction;
+    }
+
+    //----------HEARTBEAT----------
+    //the last sequence number used plus enough state to resync,
+    //a receiver that's behind on sequence lost something
+    if( ofGetElapsedTimef() - lastHeartbeatTime > s.heartbeatInterval ){
+
+        ofxOscMessage heartbeat;
+
+        heartbeat.setAddress("/heartbeat");
+        heartbeat.addIntArg( sequence );
+        heartbeat.addIntArg( (int)r.frameNum );
+        heartbeat.addIntArg( sentTracks.size() );
+        heartbeat.addIntArg( lastSentZone );
+
+        batch.messages.push_back(heartbeat);
+
+        lastHeartbeatTime = ofGetElapsedTimef();
+    }
+
+}
+
+void OscStage::encodeBlobs(const PipelineResult & r, float floorScale, uint64_t timeTag, OscWriter & writer, OscSender::Batch & batch){
+
+    //only tracks that were detected this frame, coasting ones
+    //have no blob to report
+    int numBlobs = 0;
+
+    for(int i = 0; i < r.tracks.size(); i++){
+        if( r.tracks[i].blobIndex != -1 ) numBlobs++;
+    }
+
+    //every bundle starts with a /frame header so the receiver
+    //can put a frame back together from its parts:
+    //  /frame  frameNum, numBlobs, part, numParts
+    //  /blob   id, x, y, floorX, floorY, area, zone, vx, vy, camera
+    //x, y are composite pixels, floor position in cm, velocity
+    //in cm/s
+    size_t headerSize = 16 + OscWriter::getMessageSize("/frame", "iiii");
+    size_t blobSize = OscWriter::getMessageSize("/blob", "iffffiiffi");
+
+    int blobsPerPart = (MAX_PACKET_SIZE - headerSize) / blobSize;
+    int numParts = max(1, (numBlobs + blobsPerPart - 1) / blobsPerPart);
+
+    int track = 0;
+
+    for(int part = 0; part < numParts; part++){
+
+        writer.clear();
+        writer.beginBundle(timeTag);
+
+        writer.beginMessage("/frame", "iiii");
+        writer.addInt( (int32_t)r.frameNum );
+        writer.addInt( numBlobs );
+        writer.addInt( part );
+        writer.addInt( numParts );
+        writer.endMessage();
+
+        int numInPart = 0;
+
+        for( ; track < r.tracks.size() && numInPart < blobsPerPart; track++){
+
+            const Track &t = r.tracks[track];
+
+            if( t.blobIndex == -1 ) continue;
+
+            const Blob &b = r.blobs[t.blobIndex];
+
+            writer.beginMessage("/blob", "iffffiiffi");
+            writer.addInt( t.id );
+            writer.addFloat( b.centroid.x );
+            writer.addFloat( b.centroid.y );
+            writer.addFloat( b.centroid.x * floorScale );
+            writer.addFloat( b.centroid.y * floorScale );
+            writer.addInt( b.area );
+            writer.addInt( b.zone );
+            writer.addFloat( t.vel.x * floorScale );
+            writer.addFloat( t.vel.y * floorScale );
+            writer.addInt( b.camera );
+            writer.endMessage();
+
+            numInPart++;
+
+        }
+
+        writer.endBundle();
+
+        //sized so this can't happen, but never send half a bundle
+        if( writer.hasOverflowed() ) break;
+
+        batch.data.insert(batch.data.end(), writer.getData(), writer.getData() + writer.getSize());
+        batch.packetSizes.push_back( writer.getSize() );
+        batch.encodedMessages += 1 + numInPart;
+
+    }
+
+}
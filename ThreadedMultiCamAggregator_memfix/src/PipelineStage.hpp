@@ -0,0 +1,309 @@
+//
+//  PipelineStage.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef PipelineStage_hpp
+#define PipelineStage_hpp
+
+#include <stdio.h>
+
+#endif /* PipelineStage_hpp */
+
+#include "ofMain.h"
+#include "ofxCv.h"
+#include "ofxOsc.h"
+#include "OscSender.hpp"
+#include "OscWriter.hpp"
+#include "PipelineData.hpp"
+#include "BandPool.hpp"
+#include "BackgroundStore.hpp"
+#include "BinaryImage.hpp"
+#include "IntegralImage.hpp"
+#include "SharedFrameRing.hpp"
+#include "PreviewStreamer.hpp"
+
+#pragma once
+
+
+/*
+ * PipelineStage:
+ *  One step of the detection pipeline. Stages read what
+ *  they need from the frame/result and write their output
+ *  back into the result for the next stage.
+ *
+ *  Stages only ever run on the Aggregator thread.
+ *  Subclass and register with StageGraph::registerStage()
+ *  to add custom ones.
+ */
+
+class PipelineStage{
+
+public:
+
+    PipelineStage(string _name);
+    virtual ~PipelineStage();
+
+    virtual void process(PipelineFrame & frame, PipelineResult & r) = 0;
+
+    //drop any learned state (background, tracking, etc.)
+    virtual void reset();
+
+    string name;
+    bool bEnabled;
+
+};
+
+
+//-----------------------------BUILT-IN STAGES-----------------------------
+
+//tiles + layout -> masterPix
+//(and threshPix, foregroundPix, backgroundPix from per-camera BG)
+//When the mask stage comes right after this one it gets fused
+//in: the tiles are pasted into processedPix through the mask
+//in the same pass (see StageGraph)
+class CompositeStage: public PipelineStage{
+public:
+    CompositeStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //either dst can be NULL. maskedDst only gets the pixels
+    //the mask leaves alone, the rest stay black
+    static void composite(vector<ofPixels> & tiles, const PipelineLayout & layout, ofPixels *dst, ofPixels *maskedDst = NULL, const BinaryMask *mask = NULL);
+
+    bool bFuseMask;
+};
+
+
+//masterPix -> processedPix (with or without the mask)
+//per-camera threshPix/foregroundPix get masked too
+class MaskStage: public PipelineStage{
+public:
+    MaskStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //set when the composite stage already did it
+    bool bFused;
+};
+
+
+//processedPix -> threshPix, foregroundPix, backgroundPix
+//Plain threshold, FixedPointBackground or MultiModalBackground
+//depending on settings.
+//When parallel bands are on, erode/dilate stages that directly
+//follow this one get fused into the bands (see StageGraph).
+//The background is saved every bgSaveInterval seconds, reloaded
+//on the first frame and carried over restarts and layout changes.
+//With per-camera BG the subtraction already happened in the
+//feeds and this only runs the fused erode/dilate.
+//The bands also build threshIntegral when occupancy runs
+class BackgroundStage: public PipelineStage{
+public:
+    BackgroundStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+    void reset();
+
+    bool bFuseErode;
+    bool bFuseDilate;
+    bool bBuildIntegral;
+
+private:
+    //false if there was nothing to work on
+    bool processComposite(PipelineFrame & frame, PipelineResult & r);
+    void processTiles(PipelineFrame & frame, PipelineResult & r);
+
+    BandPool bandPool;
+
+    BackgroundStore store;
+    bool bFirstFrame;
+    float lastSaveTime;
+
+    //what the background looked like last frame and the
+    //layout it was in, for remapping and watchdog restarts
+    ofPixels lastBackground;
+    PipelineLayout lastLayout;
+};
+
+
+//threshPix eroded numErosions times
+class ErodeStage: public PipelineStage{
+public:
+    ErodeStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //set when the background stage already did it in the bands
+    bool bFused;
+
+    //kept around so the packed buffer isn't reallocated every frame
+    BinaryImage bits;
+};
+
+
+//threshPix dilated numDilations times
+class DilateStage: public PipelineStage{
+public:
+    DilateStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    bool bFused;
+    BinaryImage bits;
+};
+
+
+//threshPix (+ foregroundPix for intensity) -> blobs
+class BlobStage: public PipelineStage{
+public:
+    BlobStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+private:
+    BinaryImage bits;
+    BlobLabeler labeler;
+};
+
+
+//blobs -> tracks
+class TrackStage: public PipelineStage{
+public:
+    TrackStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+    void reset();
+
+private:
+    BlobTracker tracker;
+    float lastTime;
+    uint64_t lastCaptureTime;
+};
+
+
+//tracks -> predicted positions and predictedZone.
+//Each track is pushed forward by the time since its own
+//camera captured it (plus the horizon) when prediction is on
+class PredictStage: public PipelineStage{
+public:
+    PredictStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //longest we'll extrapolate, seconds
+    static const float MAX_LEAD;
+};
+
+
+//threshPix -> contours (tracked), only for drawing
+class ContoursStage: public PipelineStage{
+public:
+    ContoursStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+    void reset();
+
+private:
+    //lives across frames so contours keep their IDs
+    ofxCv::ContourFinder contourFinder;
+};
+
+
+//blob zones -> activeZone
+class ZoneStage: public PipelineStage{
+public:
+    ZoneStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //innermost zone under the blob moved by offset, -1 if none
+    static int blobZone(const ZoneMap & zones, const Blob & blob, const vector<BlobRun> & runs, const ofVec2f & offset);
+};
+
+
+//threshIntegral (or threshPix + foregroundPix) + zones -> zoneOccupancy
+class OccupancyStage: public PipelineStage{
+public:
+    OccupancyStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+private:
+    //only when threshIntegral wasn't built
+    IntegralImage integral;
+};
+
+
+//masterPix, foregroundPix, threshPix, blobs + tracks -> the
+//SharedFrameRing, for other processes on this machine.
+//Only while publishShared is on, the segment goes away when
+//it's turned off
+class PublishStage: public PipelineStage{
+public:
+    PublishStage();
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+private:
+    SharedFrameRing ring;
+};
+
+
+//masterPix, threshPix, blobs + tracks -> PreviewStreamer, at
+//whatever rate its CPU budget allows. Only hands frames over,
+//the encoding and sending happen on the streamer's thread
+class PreviewStage: public PipelineStage{
+public:
+    PreviewStage();
+    void setup(shared_ptr<PreviewStreamer> streamer);
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+private:
+    shared_ptr<PreviewStreamer> streamer;
+};
+
+
+//activeZone -> /detected, predictedZone -> /predicted, zoneOccupancy
+//-> /occupancy, as one bundle per tick through the OscSender.
+//With deltaOSC only changes go out instead: tracks appearing,
+//moving and leaving, zones entered and left, the active zone
+//and occupancy when they change (/delta/detected, ...), all
+//with sequence numbers, plus a heartbeat every heartbeatInterval.
+//With sendBlobs, tracks -> /frame + one /blob each, encoded
+//without allocating and split over as many bundles as it takes
+//to keep each one in a single datagram.
+//With useTimeTags every bundle carries the capture time and
+//there's a /frameAges with how old each camera's tile was
+class OscStage: public PipelineStage{
+public:
+    OscStage();
+    void setup(shared_ptr<OscSender> sender);
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //biggest datagram a blob bundle is allowed to be
+    static const int MAX_PACKET_SIZE = 8192;
+
+    //appends the /frame + /blob bundles for r's tracks to batch,
+    //writer needs MAX_PACKET_SIZE bytes
+    static void encodeBlobs(const PipelineResult & r, float floorScale, uint64_t timeTag, OscWriter & writer, OscSender::Batch & batch);
+
+private:
+    void sendChanges(PipelineFrame & frame, PipelineResult & r, int zoneToSend);
+
+    //appends a message with the next sequence number as its
+    //first argument, valid until the next one is added
+    ofxOscMessage & addEvent(const string & address);
+
+    static string getConsoleLine(const PipelineResult & r, int zone);
+
+    //shared with ofApp, which sends /status through it
+    shared_ptr<OscSender> sender;
+    OscSender::Batch batch;
+    OscWriter writer;
+    float lastZoneSendTime;
+    float lastOccupancySendTime;
+
+    //what the receiver was last told, for deltaOSC
+    struct SentTrack{
+        ofVec2f pos;
+        int zone;
+        unsigned long long lastFrame;
+    };
+
+    map<int, SentTrack> sentTracks;
+    int lastSentZone;
+    int lastSentPredictedZone;
+    vector<float> lastSentOccupancy;    //-1 = never sent
+    int sequence;
+    float lastHeartbeatTime;
+};
@@ -0,0 +1,156 @@
+//
+//  PostCompositeThreadCV.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "PostCompositeThreadCV.hpp"
+#include "Profiler.hpp"
+#include "CpuMeter.hpp"
+
+
+PostCompositeThreadCV::PostCompositeThreadCV(){
+
+}
+
+
+PostCompositeThreadCV::~PostCompositeThreadCV(){
+
+    closeAllChannels();
+
+    waitForThread(true, 4000);
+
+}
+
+void PostCompositeThreadCV::closeAllChannels(){
+
+    band_IN.close();
+    result_OUT.close();
+
+}
+
+void PostCompositeThreadCV::setup(){
+
+    startThread();
+
+}
+
+//threadChannel's send() method already makes a copy, so
+//move the band in to avoid copying the pixels twice
+void PostCompositeThreadCV::analyze(Band & b){
+
+    band_IN.send(std::move(b));
+
+}
+
+//blocks until the thread is done with the band
+bool PostCompositeThreadCV::waitForResult(Result & result){
+
+    return result_OUT.receive(result);
+
+}
+
+
+void PostCompositeThreadCV::process(Band & b, shared_ptr<BackgroundModel> & bg, Result & result){
+
+    int w = b.pix.getWidth();
+    int h = b.pix.getHeight();
+
+    ofPixels thresh;
+    thresh.allocate(w, h, OF_IMAGE_GRAYSCALE);
+
+    ofPixels foreground;
+    ofPixels background;
+
+    //packed copy of thresh for the morphology
+    BinaryImage bits;
+    bool bMorphology = b.settings.numErosions > 0 || b.settings.numDilations > 0;
+
+    result.modelBytes = 0;
+
+    if( !b.settings.useBgDiff ){
+
+        //without BG subtraction, foreground is essentially just the processed pix
+        foreground = b.pix;
+
+        background.allocate(w, h, OF_IMAGE_GRAYSCALE);
+        background.setColor(70);
+
+        //threshold straight into bits
+        PROFILE_SCOPE(Profiler::THRESHOLD);
+        bits.setFromThreshold(b.pix, b.settings.threshold);
+
+    } else {
+
+        //switching engines starts the background over
+        if( !bg || bg -> getType() != b.settings.backgroundModel ){
+            bg = BackgroundModel::create(b.settings.backgroundModel);
+        }
+
+        if( b.pix.getWidth() == b.seed.getWidth() && b.pix.getHeight() == b.seed.getHeight() ){
+            bg -> setBackground(b.seed);
+        } else if( b.settings.resetBackground ){
+            bg -> reset();
+        }
+
+        bg -> setLearningTime(b.settings.learningTime);
+        bg -> setThresholdValue(b.settings.threshold);
+        bg -> setSelectiveLearning(b.settings.selectiveLearning);
+
+        //difference, threshold and learning all in one pass
+        bg -> update(b.pix, thresh, &foreground, &background);
+
+        result.modelBytes = bg -> getMemoryUsage();
+
+        if( bMorphology ) bits.setFromThreshold(thresh, 127);
+
+    }
+
+    //ERODE then DILATE it, all iterations at once
+    if( bMorphology ){
+        PROFILE_SCOPE(Profiler::MORPHOLOGY);
+        bits.erode(b.settings.numErosions);
+        bits.dilate(b.settings.numDilations);
+    }
+
+    if( bits.isAllocated() ) bits.toPixels(thresh);
+
+
+    //crop the halos off so only the band's own rows go back
+    int coreHeight = h - b.haloTop - b.haloBottom;
+
+    thresh.cropTo(result.threshPix, 0, b.haloTop, w, coreHeight);
+    foreground.cropTo(result.foregroundPix, 0, b.haloTop, w, coreHeight);
+    background.cropTo(result.backgroundPix, 0, b.haloTop, w, coreHeight);
+
+    //occupancy sums for the band's own rows while they're still
+    //in cache, BandPool joins the bands' tables
+    if( b.settings.buildIntegral ){
+        result.integral.setFromThreshold(result.threshPix, 127, &result.foregroundPix);
+    } else {
+        result.integral.clear();
+    }
+
+}
+
+
+void PostCompositeThreadCV::threadedFunction(){
+
+    while(isThreadRunning()){
+
+        if(band_IN.receive(band)){
+
+            uint64_t cpuStart = CpuMeter::getThreadCpuTime();
+
+            Result result;
+            process(band, background, result);
+
+            CpuMeter::addWorkerCpuTime( CpuMeter::getThreadCpuTime() - cpuStart );
+
+            //send things back to whoever is gathering the bands
+            result_OUT.send(std::move(result));
+
+        }
+
+    }
+
+}
@@ -0,0 +1,106 @@
+//
+//  PostCompositeThreadCV.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef PostCompositeThreadCV_hpp
+#define PostCompositeThreadCV_hpp
+
+#include <stdio.h>
+
+#endif /* PostCompositeThreadCV_hpp */
+
+#include "ofMain.h"
+#include "ofxCv.h"
+#include "BackgroundModel.hpp"
+#include "BinaryImage.hpp"
+#include "IntegralImage.hpp"
+#pragma once
+
+
+/*
+ * PostCompositeThreadCV:
+ *  Handles one horizontal band of the composite image.
+ *
+ *  INPUT:
+ *      -Band of masked composite pixels, with extra "halo"
+ *       rows above and below so erode/dilate near the band
+ *       edges see the same neighbors as the full image
+ *      -CV variables:
+ *          -threshold, BG learning, erosions, dilations
+ *
+ *  OUTPUT:
+ *      -thresholded, foreground and background pixels for
+ *       the band's own rows (halos are cropped off)
+ *      -if asked for, the summed-area table of those rows
+ *       for zone occupancy (see IntegralImage)
+ */
+
+class PostCompositeThreadCV: public ofThread{
+
+public:
+
+    PostCompositeThreadCV();
+    ~PostCompositeThreadCV();
+
+    struct Settings{
+        int threshold;
+        bool useBgDiff;
+        int learningTime;
+        bool selectiveLearning;
+        bool resetBackground;
+        BackgroundModel::Type backgroundModel;
+        int numErosions;
+        int numDilations;
+        bool buildIntegral;
+    };
+
+    struct Band{
+        ofPixels pix;
+        int haloTop;
+        int haloBottom;
+        Settings settings;
+
+        //if allocated, the background starts from this
+        //instead of being learned from scratch
+        ofPixels seed;
+    };
+
+    struct Result{
+        ofPixels threshPix;
+        ofPixels foregroundPix;
+        ofPixels backgroundPix;
+        IntegralImage integral;
+
+        //state held by this band's background model
+        size_t modelBytes;
+    };
+
+    void setup();
+    void analyze(Band & band);
+    bool waitForResult(Result & result);
+    void closeAllChannels();
+
+    //the actual CV work. Used by the thread and also
+    //directly when the pipeline runs serially
+    //(bg is (re)created to match the settings)
+    static void process(Band & band, shared_ptr<BackgroundModel> & bg, Result & result);
+
+
+private:
+
+    //inputs
+    ofThreadChannel<Band> band_IN;
+
+    //outputs
+    ofThreadChannel<Result> result_OUT;
+
+    //These are objects to be accessed --ONLY--
+    //from within thread. Each band learns its own
+    //background since the band rows never change
+    shared_ptr<BackgroundModel> background;
+    Band band;
+
+    void threadedFunction();
+
+};
@@ -7,6 +7,7 @@
 //
 
 #include "PreCompositeThreadCV.hpp"
+#include "Profiler.hpp"
 
 
 PreCompositeThreadCV::PreCompositeThreadCV(){
@@ -45,10 +46,18 @@ void PreCompositeThreadCV::emptyAllChannels(){
     
 }
 
-void PreCompositeThreadCV::setup(ofPixels *_mainPix){
+void PreCompositeThreadCV::setup(int _camNum, ofPixels *_mainPix, ofPixels *_threshPix, ofPixels *_foregroundPix, ofPixels *_backgroundPix){
+    
+    camNum = _camNum;
     
     //get pointers to the objects on the main thread we'll be filling
     mainPix = _mainPix;
+    threshPix = _threshPix;
+    foregroundPix = _foregroundPix;
+    backgroundPix = _backgroundPix;
+    
+    modelBytes = 0;
+    captureTime = 0;
     
     
     //Thread management and background resetting
@@ -63,22 +72,39 @@ void PreCompositeThreadCV::setup(ofPixels *_mainPix){
 
 //threadChannel's send() method already makes a copy so the
 //parameters of analyze() are references to avoid double copies
-void PreCompositeThreadCV::analyze(ofPixels & p, vector<int> & settings){
+void PreCompositeThreadCV::analyze(ofPixels & p, vector<int> & settings, uint64_t captureTime){
     
     NewFrame newF;
     newF.pix = p;
     newF.settings = settings;
+    newF.captureTime = captureTime;
+    
+    //seeds only go out once
+    newF.seed.swap(pendingSeed);
     
     newFrame_IN.send(newF);
     
 }
 
-void PreCompositeThreadCV::update(){
+void PreCompositeThreadCV::seedBackground(const ofPixels & seed){
+    
+    pendingSeed = seed;
+    
+}
+
+bool PreCompositeThreadCV::update(){
     
     //attempt to receive data from thread
-    ofPixels t;
-    if(newPix_OUT.tryReceive(t)){
-        *mainPix = t;
+    Output t;
+    bool bReceived = newPix_OUT.tryReceive(t);
+    
+    if(bReceived){
+        *mainPix = t.pix;
+        *threshPix = t.threshPix;
+        *foregroundPix = t.foregroundPix;
+        *backgroundPix = t.backgroundPix;
+        modelBytes = t.modelBytes;
+        captureTime = t.captureTime;
         
 //        cout << "Num channels in thread output" << mainPix -> getNumChannels() << endl;
 //        cout << "New frame from thread" << endl;
@@ -144,6 +170,8 @@ void PreCompositeThreadCV::update(){
     
     
     
+    return bReceived;
+    
 }
 
 
@@ -157,10 +185,12 @@ void PreCompositeThreadCV::threadedFunction(){
         
         if(newFrame_IN.receive(nf)){
             
+            PROFILE_SCOPE(Profiler::PREPROCESS + std::min(camNum, Profiler::MAX_CAMERAS - 1));
+            
             //unpack the vector and save it to the values we'll be using
-            int blurAmt = nf.settings[0];
-            float contrastExp = nf.settings[1]/1000.0f;   //divide to cast int to float
-            float contrastShift = nf.settings[2]/1000.0f; //divide to cast int to float
+            int blurAmt = nf.settings[SETTING_BLUR];
+            float contrastExp = nf.settings[SETTING_CONTRAST_EXP]/1000.0f;   //divide to cast int to float
+            float contrastShift = nf.settings[SETTING_CONTRAST_SHIFT]/1000.0f; //divide to cast int to float
             
             
             nf.pix.setImageType(OF_IMAGE_GRAYSCALE);
@@ -174,10 +204,47 @@ void PreCompositeThreadCV::threadedFunction(){
                 
                 nf.pix[i] = ofClamp( 255 * pow((normPixVal + contrastShift), contrastExp), 0, 255);
             }
+            
+            
+            //Background subtraction in this camera's own coordinates
+            //so moving the camera in the composite doesn't matter
+            Output out;
+            out.modelBytes = 0;
+            out.captureTime = nf.captureTime;
+            
+            if( nf.settings[SETTING_BG_DIFF] ){
+                
+                BackgroundModel::Type type = (BackgroundModel::Type)nf.settings[SETTING_BG_MODEL];
+                
+                if( !background || background -> getType() != type ){
+                    background = BackgroundModel::create(type);
+                }
+                
+                if( nf.seed.getWidth() == nf.pix.getWidth() && nf.seed.getHeight() == nf.pix.getHeight() ){
+                    background -> setBackground(nf.seed);
+                } else if( nf.settings[SETTING_BG_RESET] ){
+                    background -> reset();
+                }
+                
+                background -> setLearningTime(nf.settings[SETTING_LEARNING_TIME]);
+                background -> setThresholdValue(nf.settings[SETTING_THRESHOLD]);
+                background -> setSelectiveLearning(nf.settings[SETTING_SELECTIVE]);
+                
+                background -> update(nf.pix, out.threshPix, &out.foregroundPix, &out.backgroundPix);
+                
+                out.modelBytes = background -> getMemoryUsage();
+                
+            } else if( background ){
+                
+                //start over next time it's switched on
+                background -> reset();
+                
+            }
                         
             
             //send things out to the GL-thread
-            newPix_OUT.send(std::move(nf.pix));
+            out.pix = std::move(nf.pix);
+            newPix_OUT.send(std::move(out));
             
         }
         
@@ -15,6 +15,7 @@
 
 #include "ofMain.h"
 #include "ofxCv.h"
+#include "BackgroundModel.hpp"
 #pragma once
 
 
@@ -24,9 +25,12 @@
  *      -Raw Pixels (post quad mapping)
  *      -CV variables:
  *          -Blur amt, threshold, etc.
+ *          -Background model settings (see SETTING_ indices)
  *
  *  OUTPUT:
  *      -altered Pixel object
+ *      -this camera's threshold/foreground/background in its
+ *       own tile coordinates when per-camera BG diff is on
  */
 
 class PreCompositeThreadCV: public ofThread{
@@ -36,16 +40,45 @@ public:
     PreCompositeThreadCV();
     ~PreCompositeThreadCV();
     
-    void setup(ofPixels *_mainPix);
-    void analyze(ofPixels & pix, vector<int> & settings);
+    //where each value lives in the settings vector
+    enum{
+        SETTING_BLUR = 0,
+        SETTING_CONTRAST_EXP,       //x1000
+        SETTING_CONTRAST_SHIFT,     //x1000
+        SETTING_BG_DIFF,            //0 = per-camera BG off
+        SETTING_THRESHOLD,
+        SETTING_LEARNING_TIME,
+        SETTING_SELECTIVE,
+        SETTING_BG_MODEL,           //BackgroundModel::Type
+        SETTING_BG_RESET,
+        NUM_SETTINGS
+    };
+
+    void setup(int _camNum, ofPixels *_mainPix, ofPixels *_threshPix, ofPixels *_foregroundPix, ofPixels *_backgroundPix);
+    void analyze(ofPixels & pix, vector<int> & settings, uint64_t captureTime);
+
+    //next frame starts its background from this (same size as the tile)
+    void seedBackground(const ofPixels & seed);
     void closeAllChannels();
     void emptyAllChannels();
     
-    void update();
+    //true if a new result came back
+    bool update();
     
     struct NewFrame{
         ofPixels pix;
         vector<int> settings;
+        ofPixels seed;
+        uint64_t captureTime;
+    };
+
+    struct Output{
+        ofPixels pix;
+        ofPixels threshPix;
+        ofPixels foregroundPix;
+        ofPixels backgroundPix;
+        size_t modelBytes;
+        uint64_t captureTime;
     };
     
     
@@ -53,6 +86,15 @@ public:
     //the 'PostCompositeThreadCV' class. We'll fill them
     //directly when getting things back from the thread
     ofPixels *mainPix;
+    ofPixels *threshPix;
+    ofPixels *foregroundPix;
+    ofPixels *backgroundPix;
+    
+    //memory held by this camera's background model
+    size_t modelBytes;
+    
+    //capture time of the frame now in mainPix
+    uint64_t captureTime;
     
     
     //for restarting the thread
@@ -71,7 +113,9 @@ private:
     
     
     //outputs
-    ofThreadChannel<ofPixels> newPix_OUT;
+    ofThreadChannel<Output> newPix_OUT;
+    
+    ofPixels pendingSeed;
 
     
     //These are objects to be accessed --ONLY--
@@ -79,6 +123,12 @@ private:
 //    ofPixels pix_thread;
     
     NewFrame nf;
+
+    //which camera this is, for the Profiler
+    int camNum;
+    
+    //this camera's background, in tile coordinates
+    shared_ptr<BackgroundModel> background;
     
     void threadedFunction();
     
@@ -0,0 +1,552 @@
+//
+//  PreviewStreamer.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "PreviewStreamer.hpp"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+
+const uint32_t PreviewStreamer::MAGIC;
+const int PreviewStreamer::KEYFRAME_INTERVAL;
+const int PreviewStreamer::QUANT_SHIFT;
+const int PreviewStreamer::HEADER_SIZE;
+const int PreviewStreamer::FRAME_HEADER_SIZE;
+const int PreviewStreamer::BLOB_SIZE;
+const int PreviewStreamer::MAX_PACKET_SIZE;
+
+static void put16(vector<unsigned char> & out, size_t pos, uint16_t v){
+    out[pos] = v & 0xFF;
+    out[pos + 1] = v >> 8;
+}
+
+static void put32(vector<unsigned char> & out, size_t pos, uint32_t v){
+    put16(out, pos, v & 0xFFFF);
+    put16(out, pos + 2, v >> 16);
+}
+
+static uint16_t get16(const unsigned char * p){
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const unsigned char * p){
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+PreviewStreamer::PreviewStreamer(): queue(2){
+
+    rawSocket = -1;
+    bWake = false;
+    frameId = 0;
+    nextSubmitTime = 0;
+
+    framesSent = 0;
+    framesDropped = 0;
+    bytesSent = 0;
+    lastFrameBytes = 0;
+    lastRatio = 0;
+    meanEncodeTime = 0;
+    lastSubmitTime = 0;
+    fps = 0;
+
+}
+
+PreviewStreamer::~PreviewStreamer(){
+
+    stopThread();
+    wake();
+    waitForThread(false, 4000);
+
+    if( rawSocket >= 0 ) close(rawSocket);
+
+}
+
+void PreviewStreamer::setup(string ip, int port){
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    rawSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if( rawSocket < 0 || inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1 || connect(rawSocket, (sockaddr*)&addr, sizeof(addr)) != 0 ){
+        cout << "[PreviewStreamer] Couldn't open socket to " << ip << ":" << port << endl;
+        if( rawSocket >= 0 ) close(rawSocket);
+        rawSocket = -1;
+        return;
+    }
+
+    cout << "[PreviewStreamer] Streaming preview to " << ip << ":" << port << endl;
+
+    startThread();
+
+}
+
+PreviewStreamer::Stats PreviewStreamer::getStats() const{
+
+    Stats s;
+
+    s.framesSent = framesSent;
+    s.framesDropped = framesDropped;
+    s.bytesSent = bytesSent;
+    s.lastFrameBytes = lastFrameBytes;
+    s.lastRatio = lastRatio;
+    s.meanEncodeTime = meanEncodeTime;
+    s.lastSubmitTime = lastSubmitTime;
+    s.fps = fps;
+
+    return s;
+
+}
+
+bool PreviewStreamer::submit(const PipelineResult & r, int scale, float maxFps, float budget){
+
+    uint64_t now = ofGetElapsedTimeMicros();
+
+    if( rawSocket < 0 || now < nextSubmitTime || !r.masterPix.isAllocated() ) return false;
+
+    scale = max(1, scale);
+
+    Frame &f = pending;
+
+    f.frameNum = r.frameNum;
+    f.scale = scale;
+    f.width = r.masterPix.getWidth() / scale;
+    f.height = r.masterPix.getHeight() / scale;
+
+    f.composite.resize(f.width * f.height);
+    f.threshold.resize(f.width * f.height);
+
+    //every scale-th pixel of every scale-th row, so only those
+    //rows are ever touched
+    const unsigned char *master = r.masterPix.getData();
+    int masterW = r.masterPix.getWidth();
+    int channels = r.masterPix.getNumChannels();
+
+    bool bThreshold = r.threshPix.getWidth() == r.masterPix.getWidth() && r.threshPix.getHeight() == r.masterPix.getHeight() && r.threshPix.getNumChannels() == 1;
+    const unsigned char *thresh = bThreshold ? r.threshPix.getData() : NULL;
+
+    for(int y = 0; y < f.height; y++){
+
+        const unsigned char *src = master + (y * scale * masterW) * channels;
+        unsigned char *dst = &f.composite[y * f.width];
+
+        for(int x = 0; x < f.width; x++){
+            dst[x] = src[x * scale * channels];
+        }
+
+        if( thresh != NULL ){
+            const unsigned char *t = thresh + y * scale * masterW;
+            unsigned char *tdst = &f.threshold[y * f.width];
+
+            for(int x = 0; x < f.width; x++){
+                tdst[x] = t[x * scale];
+            }
+        } else {
+            memset(&f.threshold[y * f.width], 0, f.width);
+        }
+    }
+
+    //blob boxes in preview pixels, with whichever track has them
+    f.blobs.resize(r.blobs.size());
+
+    for(int i = 0; i < r.blobs.size(); i++){
+
+        const ::Blob &b = r.blobs[i];
+        Blob &pb = f.blobs[i];
+
+        pb.x = b.bbox.x / scale;
+        pb.y = b.bbox.y / scale;
+        pb.width = ceilf(b.bbox.width / scale);
+        pb.height = ceilf(b.bbox.height / scale);
+        pb.trackId = -1;
+        pb.zone = b.zone;
+        pb.camera = b.camera;
+    }
+
+    for(int i = 0; i < r.tracks.size(); i++){
+        if( r.tracks[i].blobIndex >= 0 && r.tracks[i].blobIndex < f.blobs.size() ){
+            f.blobs[ r.tracks[i].blobIndex ].trackId = r.tracks[i].id;
+        }
+    }
+
+    //a full queue means the encoder is still on an older frame
+    if( queue.push(pending) ){
+        wake();
+    } else {
+        framesDropped++;
+    }
+
+    //as often as asked for, unless encoding takes more than
+    //the budget at that rate
+    float interval = 1.0f / max(0.1f, maxFps);
+    float budgetInterval = meanEncodeTime / 1000.0f / max(0.001f, budget);
+
+    interval = max(interval, budgetInterval);
+
+    fps = 1.0f / interval;
+    nextSubmitTime = now + interval * 1000000;
+
+    lastSubmitTime = (ofGetElapsedTimeMicros() - now) / 1000.0f;
+
+    return true;
+
+}
+
+void PreviewStreamer::threadedFunction(){
+
+    Frame frame;
+
+    while(isThreadRunning()){
+
+        if( !queue.pop(frame) ){
+
+            //wait for submit(), the timeout is only a backstop
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(100), [this]{ return bWake; });
+            bWake = false;
+
+            continue;
+        }
+
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        encode(frame);
+
+        //smoothed so one slow frame doesn't stall the stream
+        float took = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+        meanEncodeTime = meanEncodeTime == 0 ? took : meanEncodeTime * 0.9f + took * 0.1f;
+
+    }
+
+}
+
+void PreviewStreamer::wake(){
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        bWake = true;
+    }
+
+    wakeCondition.notify_one();
+
+}
+
+void PreviewStreamer::encodeRuns(const unsigned char * src, int n, vector<unsigned char> & out){
+
+    int i = 0;
+
+    while( i < n ){
+
+        //runs of 3 or more are worth a control byte
+        int run = 1;
+        while( i + run < n && run < 130 && src[i + run] == src[i] ) run++;
+
+        if( run >= 3 ){
+            out.push_back( run + 125 );
+            out.push_back( src[i] );
+            i += run;
+            continue;
+        }
+
+        //literals up to the next run of 3
+        int start = i;
+
+        while( i < n && i - start < 128 ){
+            if( i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2] ) break;
+            i++;
+        }
+
+        out.push_back( i - start - 1 );
+        out.insert( out.end(), src + start, src + i );
+
+    }
+
+}
+
+bool PreviewStreamer::decodeRuns(const unsigned char * src, int size, unsigned char * dst, int n){
+
+    int i = 0, o = 0;
+
+    while( i < size && o < n ){
+
+        int c = src[i++];
+
+        if( c < 128 ){
+            int count = c + 1;
+            if( i + count > size || o + count > n ) return false;
+            memcpy(dst + o, src + i, count);
+            i += count;
+            o += count;
+        } else {
+            int count = c - 125;
+            if( i >= size || o + count > n ) return false;
+            memset(dst + o, src[i++], count);
+            o += count;
+        }
+
+    }
+
+    return o == n && i == size;
+
+}
+
+int PreviewStreamer::encodeImage(const vector<unsigned char> & src, vector<unsigned char> & ref, bool bKeyframe, int shift){
+
+    residual.resize(src.size());
+    ref.resize(src.size());
+
+    //differences wrap around, the decoder adds them back the
+    //same way. Unchanged areas become long runs of 0
+    for(int i = 0; i < src.size(); i++){
+        unsigned char q = src[i] >> shift;
+        residual[i] = bKeyframe ? q : (unsigned char)(q - ref[i]);
+        ref[i] = q;
+    }
+
+    size_t before = payload.size();
+
+    encodeRuns(residual.data(), residual.size(), payload);
+
+    return payload.size() - before;
+
+}
+
+void PreviewStreamer::encode(Frame & f){
+
+    bool bKeyframe = frameId % KEYFRAME_INTERVAL == 0 || refComposite.size() != f.composite.size();
+
+    payload.resize(FRAME_HEADER_SIZE);
+
+    int compositeSize = encodeImage(f.composite, refComposite, bKeyframe, QUANT_SHIFT);
+    int thresholdSize = encodeImage(f.threshold, refThreshold, bKeyframe, 0);
+
+    put32(payload, 0, f.frameNum);
+    put16(payload, 4, f.width);
+    put16(payload, 6, f.height);
+    payload[8] = f.scale;
+    payload[9] = bKeyframe ? KEYFRAME : 0;
+    payload[10] = QUANT_SHIFT;
+    payload[11] = 0;
+    put16(payload, 12, f.blobs.size());
+    put16(payload, 14, 0);
+    put32(payload, 16, compositeSize);
+    put32(payload, 20, thresholdSize);
+
+    //the boxes are only useful with the frame they came
+    //with, 65535 is plenty for a preview
+    int numBlobs = min( (int)f.blobs.size(), 65535 );
+    size_t pos = payload.size();
+
+    payload.resize(pos + numBlobs * BLOB_SIZE);
+
+    for(int i = 0; i < numBlobs; i++, pos += BLOB_SIZE){
+        const Blob &b = f.blobs[i];
+        put16(payload, pos, b.x);
+        put16(payload, pos + 2, b.y);
+        put16(payload, pos + 4, b.width);
+        put16(payload, pos + 6, b.height);
+        put32(payload, pos + 8, b.trackId);
+        payload[pos + 12] = b.zone;
+        payload[pos + 13] = b.camera;
+        put16(payload, pos + 14, 0);
+    }
+
+    //----------PACKETS----------
+    int chunkSize = MAX_PACKET_SIZE - HEADER_SIZE;
+    int numChunks = (payload.size() + chunkSize - 1) / chunkSize;
+
+    packet.resize(MAX_PACKET_SIZE);
+
+    for(int c = 0; c < numChunks; c++){
+
+        int offset = c * chunkSize;
+        int size = min( chunkSize, (int)payload.size() - offset );
+
+        put32(packet, 0, MAGIC);
+        put32(packet, 4, frameId);
+        put16(packet, 8, c);
+        put16(packet, 10, numChunks);
+        put32(packet, 12, payload.size());
+
+        memcpy(&packet[HEADER_SIZE], &payload[offset], size);
+
+        ::send(rawSocket, packet.data(), HEADER_SIZE + size, 0);
+    }
+
+    frameId++;
+
+    framesSent++;
+    bytesSent += payload.size();
+    lastFrameBytes = payload.size();
+    lastRatio = (f.composite.size() + f.threshold.size()) / (float)max((size_t)1, payload.size());
+
+}
+
+
+
+//-----------------------------DECODER-----------------------------
+PreviewDecoder::PreviewDecoder(){
+
+    framesDecoded = 0;
+    framesLost = 0;
+
+    frameId = 0;
+    numChunks = 0;
+    chunksIn = 0;
+
+    bHaveFrame = false;
+    lastFrameId = 0;
+
+    frameNum = 0;
+    scale = 1;
+
+}
+
+bool PreviewDecoder::addPacket(const char * data, size_t size){
+
+    const unsigned char *p = (const unsigned char*)data;
+
+    if( size < PreviewStreamer::HEADER_SIZE || get32(p) != PreviewStreamer::MAGIC ) return false;
+
+    uint32_t id = get32(p + 4);
+    int chunk = get16(p + 8);
+    int chunks = get16(p + 10);
+    uint32_t frameSize = get32(p + 12);
+
+    int chunkSize = PreviewStreamer::MAX_PACKET_SIZE - PreviewStreamer::HEADER_SIZE;
+
+    //a new frame drops whatever was left of the last one
+    if( id != frameId || numChunks != chunks || buffer.size() != frameSize ){
+        frameId = id;
+        numChunks = chunks;
+        chunksIn = 0;
+        bChunkIn.assign(chunks, false);
+        buffer.resize(frameSize);
+    }
+
+    if( chunk >= numChunks || bChunkIn[chunk] ) return false;
+
+    size_t offset = (size_t)chunk * chunkSize;
+    size_t bytes = size - PreviewStreamer::HEADER_SIZE;
+
+    if( offset + bytes > buffer.size() ) return false;
+
+    memcpy(&buffer[offset], p + PreviewStreamer::HEADER_SIZE, bytes);
+
+    bChunkIn[chunk] = true;
+    chunksIn++;
+
+    if( chunksIn < numChunks ) return false;
+
+    return decodeFrame();
+
+}
+
+bool PreviewDecoder::decodeFrame(){
+
+    if( buffer.size() < PreviewStreamer::FRAME_HEADER_SIZE ) return false;
+
+    const unsigned char *p = buffer.data();
+
+    uint32_t num = get32(p);
+    int w = get16(p + 4);
+    int h = get16(p + 6);
+    int frameScale = p[8];
+    bool bKeyframe = p[9] & PreviewStreamer::KEYFRAME;
+    int shift = p[10];
+    int numBlobs = get16(p + 12);
+    uint32_t compositeSize = get32(p + 16);
+    uint32_t thresholdSize = get32(p + 20);
+
+    //a delta only makes sense on top of the frame before it
+    bool bFollows = bHaveFrame && frameId == lastFrameId + 1 && composite.getWidth() == w && composite.getHeight() == h;
+
+    if( !bKeyframe && !bFollows ){
+        framesLost++;
+        bHaveFrame = false;
+        return false;
+    }
+
+    size_t expected = PreviewStreamer::FRAME_HEADER_SIZE + compositeSize + thresholdSize + numBlobs * PreviewStreamer::BLOB_SIZE;
+
+    if( buffer.size() != expected ) return false;
+
+    if( bKeyframe ){
+        composite.allocate(w, h, OF_IMAGE_GRAYSCALE);
+        threshold.allocate(w, h, OF_IMAGE_GRAYSCALE);
+        quantized.assign(w * h, 0);
+    }
+
+    //residuals, added onto the last frame (nothing for keyframes)
+    residual.resize(w * h);
+    const unsigned char *src = p + PreviewStreamer::FRAME_HEADER_SIZE;
+
+    if( !PreviewStreamer::decodeRuns(src, compositeSize, residual.data(), w * h) ) return false;
+
+    unsigned char *c = composite.getData();
+
+    for(int i = 0; i < w * h; i++){
+        quantized[i] = bKeyframe ? residual[i] : quantized[i] + residual[i];
+        c[i] = quantized[i] << shift;
+    }
+
+    src += compositeSize;
+
+    if( !PreviewStreamer::decodeRuns(src, thresholdSize, residual.data(), w * h) ) return false;
+
+    unsigned char *t = threshold.getData();
+
+    for(int i = 0; i < w * h; i++){
+        t[i] = bKeyframe ? residual[i] : t[i] + residual[i];
+    }
+
+    src += thresholdSize;
+
+    blobs.resize(numBlobs);
+
+    for(int i = 0; i < numBlobs; i++, src += PreviewStreamer::BLOB_SIZE){
+        PreviewStreamer::Blob &b = blobs[i];
+        b.x = get16(src);
+        b.y = get16(src + 2);
+        b.width = get16(src + 4);
+        b.height = get16(src + 6);
+        b.trackId = get32(src + 8);
+        b.zone = src[12];
+        b.camera = src[13];
+    }
+
+    frameNum = num;
+    scale = frameScale;
+    lastFrameId = frameId;
+    bHaveFrame = true;
+    framesDecoded++;
+
+    return true;
+
+}
+
+const ofPixels & PreviewDecoder::getComposite() const{
+    return composite;
+}
+
+const ofPixels & PreviewDecoder::getThreshold() const{
+    return threshold;
+}
+
+const vector<PreviewStreamer::Blob> & PreviewDecoder::getBlobs() const{
+    return blobs;
+}
+
+uint32_t PreviewDecoder::getFrameNum() const{
+    return frameNum;
+}
+
+int PreviewDecoder::getScale() const{
+    return scale;
+}
@@ -0,0 +1,194 @@
+//
+//  PreviewStreamer.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef PreviewStreamer_hpp
+#define PreviewStreamer_hpp
+
+#include <stdio.h>
+
+#endif /* PreviewStreamer_hpp */
+
+#include "ofMain.h"
+#include "PipelineData.hpp"
+#include "LockFreeQueue.hpp"
+#include <condition_variable>
+
+#pragma once
+
+
+/*
+ * PreviewStreamer:
+ *  Streams a small, low rate copy of the composite and the
+ *  threshold image plus blob boxes over UDP so a headless
+ *  install can be watched from another machine (see
+ *  PreviewDecoder for the other end).
+ *
+ *      -submit() runs on the Aggregator thread. It only
+ *       samples every scale-th pixel into a frame and hands it
+ *       over without waiting, dropped if the encoder is behind
+ *      -the encoder thread quantizes the composite to
+ *       8 - QUANT_SHIFT bits, takes the difference from the
+ *       last frame (whole frame every KEYFRAME_INTERVAL) and
+ *       run-length codes it, then splits it into datagrams
+ *      -encode time is measured and the frame rate is lowered
+ *       so the encoder stays inside `budget` of one core
+ *
+ *  Packet: magic, frameId (u32), chunk, numChunks (u16),
+ *  frameSize (u32), then that chunk of the frame. Frame:
+ *  frameNum (u32), width, height (u16), scale, flags, shift,
+ *  0 (u8), numBlobs, 0 (u16), compositeSize, thresholdSize
+ *  (u32), the two coded images, then numBlobs Blobs. All
+ *  little endian.
+ */
+
+class PreviewStreamer: public ofThread{
+
+public:
+
+    PreviewStreamer();
+    ~PreviewStreamer();
+
+    //preview pixels, 16 bytes on the wire
+    struct Blob{
+        int16_t x, y, width, height;
+        int32_t trackId;
+        int8_t zone;
+        int8_t camera;
+    };
+
+    struct Stats{
+        uint64_t framesSent;
+        uint64_t framesDropped;     //encoder still busy
+        uint64_t bytesSent;
+        int lastFrameBytes;
+        float lastRatio;            //raw preview bytes / sent bytes
+        float meanEncodeTime;       //ms, encoder thread
+        float lastSubmitTime;       //ms, Aggregator thread
+        float fps;                  //what the budget allows
+    };
+
+    void setup(string ip, int port);
+
+    //false if this frame wasn't taken (too soon or dropped).
+    //budget is the fraction of a core the encoder may use
+    bool submit(const PipelineResult & r, int scale, float fps, float budget);
+
+    Stats getStats() const;
+
+    static const uint32_t MAGIC = 0x50434D54;   //"TMCP"
+    static const int KEYFRAME_INTERVAL = 30;
+    static const int QUANT_SHIFT = 3;
+    static const int HEADER_SIZE = 16;
+    static const int FRAME_HEADER_SIZE = 24;
+    static const int BLOB_SIZE = 16;
+    static const int MAX_PACKET_SIZE = 8192;
+
+    enum{ KEYFRAME = 1 };
+
+    //run-length code: control byte c < 128 is c + 1 literal
+    //bytes, c >= 128 is the next byte repeated c - 125 times
+    static void encodeRuns(const unsigned char * src, int n, vector<unsigned char> & out);
+    static bool decodeRuns(const unsigned char * src, int size, unsigned char * dst, int n);
+
+
+private:
+
+    struct Frame{
+        uint32_t frameNum;
+        int width, height, scale;
+        vector<unsigned char> composite;
+        vector<unsigned char> threshold;
+        vector<Blob> blobs;
+    };
+
+    void threadedFunction();
+    void encode(Frame & frame);
+
+    //wakes the encoder after a push, and on shutdown
+    void wake();
+
+    //quantize, difference against ref (and update it), code
+    int encodeImage(const vector<unsigned char> & src, vector<unsigned char> & ref, bool bKeyframe, int shift);
+
+    LockFreeQueue<Frame> queue;
+    Frame pending;
+
+    //the encoder blocks on this while the queue is empty
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool bWake;
+
+    int rawSocket;
+
+    //encoder thread only
+    uint32_t frameId;
+    vector<unsigned char> refComposite;
+    vector<unsigned char> refThreshold;
+    vector<unsigned char> residual;
+    vector<unsigned char> payload;
+    vector<unsigned char> packet;
+
+    //Aggregator thread only
+    uint64_t nextSubmitTime;
+
+    std::atomic<uint64_t> framesSent;
+    std::atomic<uint64_t> framesDropped;
+    std::atomic<uint64_t> bytesSent;
+    std::atomic<int> lastFrameBytes;
+    std::atomic<float> lastRatio;
+    std::atomic<float> meanEncodeTime;
+    std::atomic<float> lastSubmitTime;
+    std::atomic<float> fps;
+
+};
+
+
+/*
+ * PreviewDecoder:
+ *  Puts frames back together from PreviewStreamer packets.
+ *  Delta frames are only applied on top of the frame right
+ *  before them, after a loss it waits for the next keyframe.
+ */
+
+class PreviewDecoder{
+
+public:
+
+    PreviewDecoder();
+
+    //true when this packet completed a frame
+    bool addPacket(const char * data, size_t size);
+
+    const ofPixels & getComposite() const;
+    const ofPixels & getThreshold() const;
+    const vector<PreviewStreamer::Blob> & getBlobs() const;
+    uint32_t getFrameNum() const;
+    int getScale() const;
+
+    uint64_t framesDecoded;
+    uint64_t framesLost;
+
+
+private:
+
+    bool decodeFrame();
+
+    //frame being put together
+    uint32_t frameId;
+    int numChunks, chunksIn;
+    vector<bool> bChunkIn;
+    vector<unsigned char> buffer;
+
+    bool bHaveFrame;
+    uint32_t lastFrameId;
+
+    ofPixels composite, threshold;
+    vector<unsigned char> quantized;
+    vector<unsigned char> residual;
+    vector<PreviewStreamer::Blob> blobs;
+    uint32_t frameNum;
+    int scale;
+
+};
@@ -0,0 +1,224 @@
+//
+//  Profiler.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "Profiler.hpp"
+
+#if PROFILER_ENABLED
+
+
+const int Profiler::MAX_CAMERAS;
+const int Profiler::WINDOW;
+
+Profiler::Samples Profiler::samples[Profiler::NUM_SECTIONS];
+
+
+int Profiler::getStageSection(const string & stageName){
+
+    if( stageName == "composite" ) return COMPOSITE;
+    if( stageName == "mask" ) return MASK;
+    if( stageName == "background" ) return BACKGROUND;
+    if( stageName == "erode" || stageName == "dilate" ) return MORPHOLOGY;
+    if( stageName == "blobs" ) return LABELING;
+    if( stageName == "track" || stageName == "predict" ) return TRACKING;
+    if( stageName == "contours" ) return CONTOURS;
+    if( stageName == "zones" || stageName == "occupancy" ) return ZONES;
+    if( stageName == "osc" || stageName == "publish" || stageName == "preview" ) return OUTPUT;
+
+    return -1;
+
+}
+
+string Profiler::getName(int section){
+
+    switch(section){
+        case INGEST: return "ingest";
+        case COMPOSITE: return "composite";
+        case MASK: return "mask";
+        case BACKGROUND: return "background";
+        case THRESHOLD: return "threshold";
+        case MORPHOLOGY: return "morphology";
+        case LABELING: return "labeling";
+        case TRACKING: return "tracking";
+        case CONTOURS: return "contours";
+        case ZONES: return "zones";
+        case OUTPUT: return "output";
+        case PIPELINE: return "pipeline";
+    }
+
+    return "preprocess" + ofToString(section - PREPROCESS);
+
+}
+
+
+Profiler::Profiler(){
+
+    reportInterval = 1.0f;
+    exportInterval = 10.0f;
+
+    lastReportTime = 0;
+    lastExportTime = 0;
+
+    for(int i = 0; i < NUM_SECTIONS; i++) lastCounts[i] = 0;
+
+    sorted.reserve(WINDOW);
+
+}
+
+void Profiler::setup(float _reportInterval, float _exportInterval, string _csvPath, string _jsonPath){
+
+    reportInterval = _reportInterval;
+    exportInterval = _exportInterval;
+    csvPath = _csvPath;
+    jsonPath = _jsonPath;
+
+    lastReportTime = ofGetElapsedTimef();
+    lastExportTime = lastReportTime;
+
+    for(int i = 0; i < NUM_SECTIONS; i++) lastCounts[i] = samples[i].count.load(std::memory_order_relaxed);
+
+    //one header per run, rows from earlier runs stay above it
+    if( csvPath != "" ){
+        ofFile csv(csvPath, ofFile::Append);
+        csv << "time,section,calls,rate,mean_ms,p50_ms,p90_ms,p99_ms,max_ms\n";
+    }
+
+    cout << "[Profiler] Reporting every " << reportInterval << "s, exporting every " << exportInterval << "s" << endl;
+
+}
+
+bool Profiler::update(){
+
+    double now = ofGetElapsedTimef();
+
+    if( now - lastReportTime < reportInterval ) return false;
+
+    float elapsed = now - lastReportTime;
+    lastReportTime = now;
+
+    report.clear();
+
+    for(int i = 0; i < NUM_SECTIONS; i++){
+
+        uint64_t count = samples[i].count.load(std::memory_order_relaxed);
+        if( count == 0 ) continue;
+
+        //writers may be filling the ring while we copy it,
+        //a sample or two from the next frame doesn't matter
+        int n = (int)std::min(count, (uint64_t)WINDOW);
+
+        sorted.clear();
+        for(int j = 0; j < n; j++) sorted.push_back( samples[i].times[j].load(std::memory_order_relaxed) );
+
+        std::sort(sorted.begin(), sorted.end());
+
+        uint64_t total = 0;
+        for(int j = 0; j < n; j++) total += sorted[j];
+
+        Stats s;
+        s.section = i;
+        s.calls = count;
+        s.rate = (count - lastCounts[i]) / elapsed;
+        s.mean = total / (float)n / 1000.0f;
+        s.p50 = sorted[ (n - 1) * 50 / 100 ] / 1000.0f;
+        s.p90 = sorted[ (n - 1) * 90 / 100 ] / 1000.0f;
+        s.p99 = sorted[ (n - 1) * 99 / 100 ] / 1000.0f;
+        s.max = sorted[n - 1] / 1000.0f;
+
+        report.push_back(s);
+
+        lastCounts[i] = count;
+
+    }
+
+    if( now - lastExportTime >= exportInterval ){
+
+        lastExportTime = now;
+
+        if( csvPath != "" ) exportCsv();
+        if( jsonPath != "" ) exportJson();
+
+    }
+
+    return true;
+
+}
+
+const vector<Profiler::Stats> & Profiler::getReport() const{
+    return report;
+}
+
+string Profiler::getReportString() const{
+
+    string s = "Section        Hz      Mean     p50     p90     p99     Max (ms)\n";
+
+    for(int i = 0; i < report.size(); i++){
+
+        const Stats &st = report[i];
+
+        string name = getName(st.section);
+        s += name + string( std::max(1, 13 - (int)name.size()), ' ' );
+        s += ofToString(st.rate, 1, 6, ' ') + " ";
+        s += ofToString(st.mean, 2, 8, ' ');
+        s += ofToString(st.p50, 2, 8, ' ');
+        s += ofToString(st.p90, 2, 8, ' ');
+        s += ofToString(st.p99, 2, 8, ' ');
+        s += ofToString(st.max, 2, 8, ' ') + "\n";
+
+    }
+
+    return s;
+
+}
+
+void Profiler::exportCsv(){
+
+    string time = ofGetTimestampString("%Y-%m-%d %H:%M:%S");
+    string rows;
+
+    for(int i = 0; i < report.size(); i++){
+
+        const Stats &st = report[i];
+
+        rows += time + "," + getName(st.section) + "," + ofToString(st.calls) + "," + ofToString(st.rate, 2) + ",";
+        rows += ofToString(st.mean, 3) + "," + ofToString(st.p50, 3) + "," + ofToString(st.p90, 3) + ",";
+        rows += ofToString(st.p99, 3) + "," + ofToString(st.max, 3) + "\n";
+
+    }
+
+    ofFile csv(csvPath, ofFile::Append);
+    csv << rows;
+
+}
+
+void Profiler::exportJson(){
+
+    string json = "{\n  \"time\": \"" + ofGetTimestampString("%Y-%m-%d %H:%M:%S") + "\",\n";
+    json += "  \"window\": " + ofToString(WINDOW) + ",\n";
+    json += "  \"sections\": {";
+
+    for(int i = 0; i < report.size(); i++){
+
+        const Stats &st = report[i];
+
+        json += string(i == 0 ? "" : ",") + "\n    \"" + getName(st.section) + "\": {";
+        json += "\"calls\": " + ofToString(st.calls) + ", \"rate\": " + ofToString(st.rate, 2);
+        json += ", \"mean_ms\": " + ofToString(st.mean, 3) + ", \"p50_ms\": " + ofToString(st.p50, 3);
+        json += ", \"p90_ms\": " + ofToString(st.p90, 3) + ", \"p99_ms\": " + ofToString(st.p99, 3);
+        json += ", \"max_ms\": " + ofToString(st.max, 3) + "}";
+
+    }
+
+    json += "\n  }\n}\n";
+
+    //written beside it and moved over so readers
+    //never see half a file
+    ofBuffer buffer;
+    buffer.set(json.c_str(), json.size());
+    ofBufferToFile(jsonPath + ".tmp", buffer);
+    ofFile::moveFromTo(jsonPath + ".tmp", jsonPath, true, true);
+
+}
+
+#endif
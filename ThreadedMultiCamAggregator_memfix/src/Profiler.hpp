@@ -0,0 +1,168 @@
+//
+//  Profiler.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include <stdio.h>
+
+#endif /* Profiler_hpp */
+
+#include "ofMain.h"
+#include <atomic>
+
+#pragma once
+
+
+//build with PROFILER_ENABLED=0 and every PROFILE_ macro is
+//empty, Profiler itself doesn't exist
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+
+#if PROFILER_ENABLED
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+//times the rest of the enclosing block
+#define PROFILE_SCOPE(section) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(section)
+
+//a time that was already measured, micros
+#define PROFILE_RECORD(section, micros) Profiler::record(section, micros)
+
+#else
+
+#define PROFILE_SCOPE(section)
+#define PROFILE_RECORD(section, micros)
+
+#endif
+
+
+#if PROFILER_ENABLED
+
+/*
+ * Profiler:
+ *  Rolling timings for the parts of the app we care about.
+ *
+ *      -record() and Scope can be used from any thread. Each
+ *       section keeps its last WINDOW samples in a ring, a
+ *       sample is one atomic add and one store
+ *      -samples are per call, so per frame for most sections,
+ *       per camera frame for preprocess and per band for the
+ *       threshold/morphology work done inside the bands
+ *      -update() (one thread only, ofApp or HeadlessApp) turns
+ *       the rings into percentiles every reportInterval and
+ *       writes them to a csv (appended) and a json (latest
+ *       only) every exportInterval
+ */
+
+class Profiler{
+
+public:
+
+    static const int MAX_CAMERAS = 8;
+
+    enum Section{
+        INGEST,         //camera frames -> feeds -> aggregator, app thread
+        COMPOSITE,
+        MASK,
+        BACKGROUND,     //the stage, including whatever is fused into its bands
+        THRESHOLD,      //plain threshold passes, per band
+        MORPHOLOGY,     //erode/dilate stages, or per band when fused
+        LABELING,
+        TRACKING,       //track + predict
+        CONTOURS,
+        ZONES,          //zone test + occupancy
+        OUTPUT,         //osc, shared memory, preview
+        PIPELINE,       //everything on the Aggregator thread
+        PREPROCESS,     //+ camera number, each camera's thread
+        NUM_SECTIONS = PREPROCESS + MAX_CAMERAS
+    };
+
+    static const int WINDOW = 256;
+
+    //negative sections are ignored
+    static inline void record(int section, uint64_t micros){
+
+        if( section < 0 ) return;
+
+        Samples &s = samples[section];
+
+        uint64_t i = s.count.fetch_add(1, std::memory_order_relaxed);
+        s.times[i % WINDOW].store( (uint32_t)std::min(micros, (uint64_t)UINT32_MAX), std::memory_order_relaxed );
+
+    }
+
+    class Scope{
+    public:
+        Scope(int _section){
+            section = _section;
+            start = ofGetElapsedTimeMicros();
+        }
+        ~Scope(){
+            record(section, ofGetElapsedTimeMicros() - start);
+        }
+    private:
+        int section;
+        uint64_t start;
+    };
+
+    //section a pipeline stage's time goes to, -1 for none
+    static int getStageSection(const string & stageName);
+
+    static string getName(int section);
+
+
+    struct Stats{
+        int section;
+        uint64_t calls;     //since startup
+        float rate;         //calls per second
+        float mean;         //ms, over the window
+        float p50, p90, p99, max;
+    };
+
+    Profiler();
+
+    //empty paths don't export
+    void setup(float reportInterval, float exportInterval, string csvPath, string jsonPath);
+
+    //true when there's a new report
+    bool update();
+
+    //sections that have been called, in Section order
+    const vector<Stats> & getReport() const;
+
+    //fixed width table for the INFO view
+    string getReportString() const;
+
+
+private:
+
+    void exportCsv();
+    void exportJson();
+
+    //own cache lines so threads timing different
+    //sections don't fight over them
+    struct alignas(64) Samples{
+        std::atomic<uint64_t> count;
+        std::atomic<uint32_t> times[WINDOW];
+    };
+
+    static Samples samples[NUM_SECTIONS];
+
+    float reportInterval, exportInterval;
+    string csvPath, jsonPath;
+
+    double lastReportTime, lastExportTime;
+    uint64_t lastCounts[NUM_SECTIONS];
+
+    vector<Stats> report;
+    vector<uint32_t> sorted;
+
+};
+
+#endif
@@ -0,0 +1,353 @@
+//
+//  SharedFrameRing.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "SharedFrameRing.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+//macOS limits shm names to 31 characters
+const char * SharedFrameRing::DEFAULT_NAME = "/ThreadedMultiCamAggregator";
+
+const uint32_t SharedFrameRing::MAGIC;
+const uint32_t SharedFrameRing::VERSION;
+const uint64_t SharedFrameRing::RETRY_INTERVAL;
+
+//keeps every slot and image on its own cache lines
+static uint64_t alignUp(uint64_t n){
+    return (n + 63) & ~(uint64_t)63;
+}
+
+SharedFrameRing::SharedFrameRing(){
+
+    numSlots = 0;
+    maxBlobs = 0;
+
+    fd = -1;
+    size = 0;
+    data = NULL;
+    header = NULL;
+
+    nextRetryTime = 0;
+    bFailureReported = false;
+
+}
+
+SharedFrameRing::~SharedFrameRing(){
+
+    close();
+
+}
+
+bool SharedFrameRing::setup(string _name, int _numSlots, int maxWidth, int maxHeight, int _maxBlobs){
+
+    close();
+
+    //this gets called every tick until it works, don't
+    //hammer shm_open (or the console) at pipeline rate
+    if( _name == name && ofGetElapsedTimeMicros() < nextRetryTime ) return false;
+
+    name = _name;
+    numSlots = max(2, _numSlots);
+    maxBlobs = _maxBlobs;
+
+    uint64_t imageSize = alignUp( (uint64_t)maxWidth * maxHeight );
+    uint64_t slotSize = alignUp( sizeof(SlotHeader) ) + imageSize * NUM_IMAGES + alignUp( sizeof(SharedBlob) * maxBlobs );
+    uint64_t firstSlot = alignUp( sizeof(Header) );
+
+    size = firstSlot + slotSize * numSlots;
+
+    //a segment left over from a crash would have the wrong size
+    shm_unlink(name.c_str());
+
+    fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+
+    void *p = MAP_FAILED;
+
+    if( fd >= 0 && ftruncate(fd, size) == 0 ){
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    if( p == MAP_FAILED ){
+
+        if( !bFailureReported ){
+            cout << "[SharedFrameRing] Couldn't make shared memory " << name << ", retrying every " << RETRY_INTERVAL / 1000000 << "s" << endl;
+            bFailureReported = true;
+        }
+
+        if( fd >= 0 ) shm_unlink(name.c_str());
+
+        close();
+        nextRetryTime = ofGetElapsedTimeMicros() + RETRY_INTERVAL;
+
+        return false;
+    }
+
+    nextRetryTime = 0;
+    bFailureReported = false;
+
+    data = (char*)p;
+    header = (Header*)data;
+
+    //new segments are zeroed, which is sequence 0 for every slot
+    header -> version = VERSION;
+    header -> bClosed = 0;
+    header -> numSlots = numSlots;
+    header -> slotSize = slotSize;
+    header -> firstSlot = firstSlot;
+    header -> maxWidth = maxWidth;
+    header -> maxHeight = maxHeight;
+    header -> maxBlobs = maxBlobs;
+    header -> published = 0;
+
+    for(int i = 0; i < numSlots; i++){
+
+        SlotHeader *slot = getSlot(i);
+
+        uint64_t offset = alignUp( sizeof(SlotHeader) );
+
+        for(int j = 0; j < NUM_IMAGES; j++){
+            slot -> images[j].offset = offset;
+            offset += imageSize;
+        }
+
+        slot -> blobOffset = offset;
+    }
+
+    //readers check this last
+    std::atomic_thread_fence(std::memory_order_release);
+    header -> magic = MAGIC;
+
+    cout << "[SharedFrameRing] Publishing " << numSlots << " x " << slotSize/1024 << " KB to " << name << endl;
+
+    return true;
+
+}
+
+void SharedFrameRing::close(){
+
+    if( header != NULL ){
+        //tells readers to let go and open again
+        header -> bClosed.store(1, std::memory_order_release);
+    }
+
+    if( data != NULL ){
+        munmap(data, size);
+        shm_unlink(name.c_str());
+    }
+
+    if( fd >= 0 ) ::close(fd);
+
+    fd = -1;
+    size = 0;
+    data = NULL;
+    header = NULL;
+
+}
+
+bool SharedFrameRing::isSetup() const{
+    return header != NULL;
+}
+
+uint64_t SharedFrameRing::getPublished() const{
+    return header != NULL ? header -> published.load() : 0;
+}
+
+SharedFrameRing::SlotHeader * SharedFrameRing::getSlot(uint64_t index){
+    return (SlotHeader*)(data + header -> firstSlot + header -> slotSize * (index % numSlots));
+}
+
+void SharedFrameRing::publish(const PipelineResult & r, uint64_t captureTime){
+
+    const ofPixels * images[NUM_IMAGES] = { &r.masterPix, &r.foregroundPix, &r.threshPix };
+
+    //everything has to fit in a slot
+    bool bFits = header != NULL && (int)r.blobs.size() <= maxBlobs;
+
+    for(int i = 0; i < NUM_IMAGES && bFits; i++){
+        if( images[i] -> getWidth() * images[i] -> getHeight() * images[i] -> getNumChannels() > (uint64_t)header -> maxWidth * header -> maxHeight ){
+            bFits = false;
+        }
+    }
+
+    if( !bFits ){
+        int w = max( (int)r.masterPix.getWidth(), header != NULL ? (int)header -> maxWidth : 0 );
+        int h = max( (int)r.masterPix.getHeight(), header != NULL ? (int)header -> maxHeight : 0 );
+        int blobs = max( (int)r.blobs.size() * 2, maxBlobs );
+
+        if( !setup(name.empty() ? DEFAULT_NAME : name, numSlots, w, h, blobs) ) return;
+    }
+
+    uint64_t index = header -> published.load(std::memory_order_relaxed);
+    SlotHeader *slot = getSlot(index);
+
+    //odd while writing, readers that started before this
+    //see the sequence change and throw away what they read
+    uint64_t sequence = slot -> sequence.load(std::memory_order_relaxed);
+
+    slot -> sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot -> frameNum = r.frameNum;
+    slot -> captureTime = captureTime;
+
+    for(int i = 0; i < NUM_IMAGES; i++){
+
+        Image &img = slot -> images[i];
+
+        img.width = images[i] -> getWidth();
+        img.height = images[i] -> getHeight();
+        img.channels = images[i] -> isAllocated() ? images[i] -> getNumChannels() : 0;
+
+        if( images[i] -> isAllocated() ){
+            memcpy( (char*)slot + img.offset, images[i] -> getData(), img.width * img.height * img.channels );
+        }
+    }
+
+    //track IDs come from whichever track has the blob
+    SharedBlob *blobs = (SharedBlob*)( (char*)slot + slot -> blobOffset );
+
+    for(int i = 0; i < r.blobs.size(); i++){
+
+        const Blob &b = r.blobs[i];
+        SharedBlob &sb = blobs[i];
+
+        sb.trackId = -1;
+        sb.area = b.area;
+        sb.x = b.centroid.x;
+        sb.y = b.centroid.y;
+        sb.left = b.bbox.x;
+        sb.top = b.bbox.y;
+        sb.width = b.bbox.width;
+        sb.height = b.bbox.height;
+        sb.zone = b.zone;
+        sb.camera = b.camera;
+    }
+
+    for(int i = 0; i < r.tracks.size(); i++){
+        if( r.tracks[i].blobIndex >= 0 && r.tracks[i].blobIndex < r.blobs.size() ){
+            blobs[ r.tracks[i].blobIndex ].trackId = r.tracks[i].id;
+        }
+    }
+
+    slot -> numBlobs = r.blobs.size();
+
+    slot -> sequence.store(sequence + 2, std::memory_order_release);
+    header -> published.store(index + 1, std::memory_order_release);
+
+}
+
+
+
+//-----------------------------READER-----------------------------
+SharedFrameReader::SharedFrameReader(){
+
+    fd = -1;
+    size = 0;
+    data = NULL;
+    header = NULL;
+
+}
+
+SharedFrameReader::~SharedFrameReader(){
+
+    close();
+
+}
+
+bool SharedFrameReader::open(string name){
+
+    close();
+
+    fd = shm_open(name.c_str(), O_RDONLY, 0);
+
+    if( fd < 0 ) return false;
+
+    struct stat st;
+
+    if( fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SharedFrameRing::Header) ){
+        close();
+        return false;
+    }
+
+    size = st.st_size;
+
+    void *p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if( p == MAP_FAILED ){
+        close();
+        return false;
+    }
+
+    data = (char*)p;
+    header = (const SharedFrameRing::Header*)data;
+
+    //still being set up, or not ours
+    if( header -> magic != SharedFrameRing::MAGIC || header -> version != SharedFrameRing::VERSION ){
+        close();
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return true;
+
+}
+
+void SharedFrameReader::close(){
+
+    if( data != NULL ) munmap(data, size);
+    if( fd >= 0 ) ::close(fd);
+
+    fd = -1;
+    size = 0;
+    data = NULL;
+    header = NULL;
+
+}
+
+bool SharedFrameReader::isStale() const{
+    return header == NULL || header -> bClosed.load(std::memory_order_acquire) != 0;
+}
+
+bool SharedFrameReader::latest(View & view) const{
+
+    if( isStale() ) return false;
+
+    uint64_t published = header -> published.load(std::memory_order_acquire);
+
+    //the newest slot, or the one before if the writer has
+    //already lapped around to it
+    for(uint64_t back = 1; back <= 2 && back <= published; back++){
+
+        view.slot = (const SharedFrameRing::SlotHeader*)(data + header -> firstSlot + header -> slotSize * ((published - back) % header -> numSlots));
+        view.sequence = view.slot -> sequence.load(std::memory_order_acquire);
+
+        if( view.sequence % 2 == 0 ) return true;
+    }
+
+    return false;
+
+}
+
+bool SharedFrameReader::isValid(const View & view) const{
+
+    //everything read before this stays before the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return view.slot -> sequence.load(std::memory_order_relaxed) == view.sequence;
+
+}
+
+const unsigned char * SharedFrameReader::View::getImage(int i) const{
+    return (const unsigned char*)slot + slot -> images[i].offset;
+}
+
+const SharedBlob * SharedFrameReader::View::getBlobs() const{
+    return (const SharedBlob*)( (const char*)slot + slot -> blobOffset );
+}
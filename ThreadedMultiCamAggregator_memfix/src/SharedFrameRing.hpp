@@ -0,0 +1,182 @@
+//
+//  SharedFrameRing.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef SharedFrameRing_hpp
+#define SharedFrameRing_hpp
+
+#include <stdio.h>
+
+#endif /* SharedFrameRing_hpp */
+
+#include "ofMain.h"
+#include "PipelineData.hpp"
+#include <atomic>
+
+#pragma once
+
+
+/*
+ * SharedFrameRing:
+ *  Publishes every tick's composite, foreground and threshold
+ *  images and the blob table into a POSIX shared memory ring
+ *  so other local processes can read them at full rate.
+ *
+ *      -numSlots slots, frame n goes into slot n % numSlots
+ *      -every slot has a seqlock: its sequence is odd while
+ *       it's being written. Readers look at the data in place
+ *       and check the sequence didn't change afterwards, so
+ *       they never copy unless they want to and never hold
+ *       up the writer
+ *      -slots are sized for the composite it was set up with.
+ *       If the composite gets bigger the segment is marked
+ *       closed, unlinked and made again, readers reopen
+ *      -if the segment can't be made (permissions, name in
+ *       use) publishing is skipped and retried once a second
+ *
+ *  Layout (all offsets from the start of the segment):
+ *      Header | Slot 0 | Slot 1 | ...
+ *      Slot = SlotHeader | images[0..2] | SharedBlob[maxBlobs]
+ */
+
+//one row of the blob table, plain types only so readers
+//don't need anything from this app
+struct SharedBlob{
+    int32_t trackId;        //-1 if no track has it
+    int32_t area;
+    float x, y;             //centroid, composite pixels
+    float left, top, width, height;
+    int32_t zone;
+    int32_t camera;
+};
+
+class SharedFrameRing{
+
+public:
+
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    enum{ COMPOSITE, FOREGROUND, THRESHOLD, NUM_IMAGES };
+
+    static const uint32_t MAGIC = 0x544D4341;    //"TMCA"
+    static const uint32_t VERSION = 1;
+
+    struct Image{
+        uint32_t width, height, channels;
+        uint64_t offset;        //from the start of the slot
+    };
+
+    struct SlotHeader{
+        std::atomic<uint64_t> sequence;
+        uint64_t frameNum;
+        uint64_t captureTime;   //ofGetElapsedTimeMicros() of the writer
+        Image images[NUM_IMAGES];
+        uint32_t numBlobs;
+        uint64_t blobOffset;
+    };
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> bClosed;
+        uint32_t numSlots;
+        uint64_t slotSize;
+        uint64_t firstSlot;
+        uint32_t maxWidth, maxHeight, maxBlobs;
+
+        //frames published so far, the newest is in
+        //slot (published - 1) % numSlots
+        std::atomic<uint64_t> published;
+    };
+
+    //false if the segment couldn't be made. After a failure
+    //it isn't tried again for RETRY_INTERVAL, and the failure
+    //is only reported once until it works
+    bool setup(string name, int numSlots, int maxWidth, int maxHeight, int maxBlobs);
+    void close();
+
+    bool isSetup() const;
+
+    //copies r's images and blobs into the next slot. Remakes
+    //the segment first if the composite doesn't fit
+    void publish(const PipelineResult & r, uint64_t captureTime);
+
+    uint64_t getPublished() const;
+
+    static const char * DEFAULT_NAME;
+
+    //micros
+    static const uint64_t RETRY_INTERVAL = 1000000;
+
+
+private:
+
+    SlotHeader * getSlot(uint64_t index);
+
+    string name;
+    int numSlots;
+    int maxBlobs;
+
+    int fd;
+    size_t size;
+    char * data;
+    Header * header;
+
+    //after a failed setup()
+    uint64_t nextRetryTime;
+    bool bFailureReported;
+
+};
+
+
+/*
+ * SharedFrameReader:
+ *  The other end, for consumers (and for checking the ring).
+ *
+ *      SharedFrameReader::View v;
+ *      if( reader.latest(v) ){
+ *          ...read v.getImage(), v.getBlobs() in place...
+ *          if( reader.isValid(v) ) //use what was read
+ *      }
+ */
+
+class SharedFrameReader{
+
+public:
+
+    SharedFrameReader();
+    ~SharedFrameReader();
+
+    struct View{
+        const SharedFrameRing::SlotHeader * slot;
+        uint64_t sequence;
+
+        const unsigned char * getImage(int i) const;
+        const SharedBlob * getBlobs() const;
+    };
+
+    bool open(string name = SharedFrameRing::DEFAULT_NAME);
+    void close();
+
+    //the writer remade or dropped the segment, open() again
+    bool isStale() const;
+
+    //newest frame that isn't being written right now, false
+    //if there's none
+    bool latest(View & view) const;
+
+    //true if nothing read from view since latest() can have
+    //been overwritten
+    bool isValid(const View & view) const;
+
+
+private:
+
+    int fd;
+    size_t size;
+    char * data;
+    const SharedFrameRing::Header * header;
+
+};
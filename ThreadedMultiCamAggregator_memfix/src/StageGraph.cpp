@@ -0,0 +1,270 @@
+//
+//  StageGraph.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "StageGraph.hpp"
+#include "Profiler.hpp"
+#include "CpuMeter.hpp"
+
+
+StageGraph::StageGraph(){
+
+}
+
+void StageGraph::setup(shared_ptr<OscSender> oscSender, shared_ptr<PreviewStreamer> previewStreamer){
+
+    registerStage("composite", [](){ return make_shared<CompositeStage>(); });
+    registerStage("mask", [](){ return make_shared<MaskStage>(); });
+    registerStage("background", [](){ return make_shared<BackgroundStage>(); });
+    registerStage("erode", [](){ return make_shared<ErodeStage>(); });
+    registerStage("dilate", [](){ return make_shared<DilateStage>(); });
+    registerStage("blobs", [](){ return make_shared<BlobStage>(); });
+    registerStage("track", [](){ return make_shared<TrackStage>(); });
+    registerStage("predict", [](){ return make_shared<PredictStage>(); });
+    registerStage("contours", [](){ return make_shared<ContoursStage>(); });
+    registerStage("zones", [](){ return make_shared<ZoneStage>(); });
+    registerStage("occupancy", [](){ return make_shared<OccupancyStage>(); });
+    registerStage("publish", [](){ return make_shared<PublishStage>(); });
+
+    registerStage("osc", [=](){
+        shared_ptr<OscStage> stage = make_shared<OscStage>();
+        stage -> setup(oscSender);
+        return stage;
+    });
+
+    registerStage("preview", [=](){
+        shared_ptr<PreviewStage> stage = make_shared<PreviewStage>();
+        stage -> setup(previewStreamer);
+        return stage;
+    });
+
+    build( getDefaultOrder() );
+
+}
+
+void StageGraph::registerStage(string name, StageFactory factory){
+
+    factories[name] = factory;
+
+}
+
+vector<string> StageGraph::getDefaultOrder(){
+
+    vector<string> o;
+    o.push_back("composite");
+    o.push_back("mask");
+    o.push_back("background");
+    o.push_back("erode");
+    o.push_back("dilate");
+    o.push_back("blobs");
+    o.push_back("track");
+    o.push_back("predict");
+    o.push_back("contours");
+    o.push_back("zones");
+    o.push_back("occupancy");
+    o.push_back("osc");
+    o.push_back("publish");
+    o.push_back("preview");
+
+    return o;
+
+}
+
+const vector<string> & StageGraph::getOrder() const{
+    return order;
+}
+
+void StageGraph::build(const vector<string> & newOrder){
+
+    order = newOrder;
+    stages.clear();
+    profileSections.clear();
+
+    cout << "Building pipeline:";
+
+    for(int i = 0; i < order.size(); i++){
+
+        string name = ofTrim(order[i]);
+        bool enabled = true;
+
+        if( name.empty() ) continue;
+
+        if( name[0] == '-' ){
+            enabled = false;
+            name = ofTrim( name.substr(1) );
+        }
+
+        if( factories.find(name) == factories.end() ){
+            cout << endl << "Unknown pipeline stage \"" << name << "\", skipping";
+            continue;
+        }
+
+        //reuse the old instance so the background
+        //and contour tracking survive a reorder
+        if( instances.find(name) == instances.end() ){
+            instances[name] = factories[name]();
+        }
+
+        shared_ptr<PipelineStage> stage = instances[name];
+        stage -> bEnabled = enabled;
+        stages.push_back(stage);
+
+#if PROFILER_ENABLED
+        profileSections.push_back( Profiler::getStageSection(name) );
+#endif
+
+        cout << " " << (enabled ? "" : "-") << name;
+
+    }
+
+    cout << endl;
+
+}
+
+void StageGraph::updateFusion(const PipelineSettings & s){
+
+    //the mask can be applied while pasting the tiles if
+    //it's the next thing to run after compositing
+    shared_ptr<CompositeStage> composite;
+    bool fuseMask = false;
+
+    for(int i = 0; i < stages.size(); i++){
+
+        if( !stages[i] -> bEnabled ) continue;
+
+        if( composite ){
+            fuseMask = stages[i] -> name == "mask";
+            break;
+        }
+
+        composite = dynamic_pointer_cast<CompositeStage>(stages[i]);
+    }
+
+    for(int i = 0; i < stages.size(); i++){
+
+        if( shared_ptr<CompositeStage> c = dynamic_pointer_cast<CompositeStage>(stages[i]) ){
+            c -> bFuseMask = fuseMask;
+        }
+
+        if( shared_ptr<MaskStage> m = dynamic_pointer_cast<MaskStage>(stages[i]) ){
+            m -> bFused = fuseMask;
+        }
+
+    }
+
+
+    //erode/dilate can only ride along in the bands if
+    //nothing else runs between them and the background
+    bool afterBackground = false;
+    bool fuseErode = false;
+    bool fuseDilate = false;
+
+    shared_ptr<BackgroundStage> background;
+
+    for(int i = 0; i < stages.size(); i++){
+
+        if( !stages[i] -> bEnabled ) continue;
+
+        if( shared_ptr<BackgroundStage> b = dynamic_pointer_cast<BackgroundStage>(stages[i]) ){
+            background = b;
+            afterBackground = s.useParallelBands;
+            continue;
+        }
+
+        if( !afterBackground ) continue;
+
+        //erode always comes first inside the bands
+        if( stages[i] -> name == "erode" && !fuseDilate ){
+            fuseErode = true;
+        } else if( stages[i] -> name == "dilate" ){
+            fuseDilate = true;
+        } else {
+            afterBackground = false;
+        }
+
+    }
+
+    if( background ){
+        background -> bFuseErode = fuseErode;
+        background -> bFuseDilate = fuseDilate;
+
+        //occupancy's table comes out of the bands too
+        background -> bBuildIntegral = false;
+
+        for(int i = 0; i < stages.size(); i++){
+            if( stages[i] -> bEnabled && stages[i] -> name == "occupancy" ){
+                background -> bBuildIntegral = true;
+            }
+        }
+    }
+
+    for(int i = 0; i < stages.size(); i++){
+
+        if( shared_ptr<ErodeStage> e = dynamic_pointer_cast<ErodeStage>(stages[i]) ){
+            e -> bFused = fuseErode;
+        }
+
+        if( shared_ptr<DilateStage> d = dynamic_pointer_cast<DilateStage>(stages[i]) ){
+            d -> bFused = fuseDilate;
+        }
+
+    }
+
+}
+
+void StageGraph::process(PipelineFrame & frame, PipelineResult & r){
+
+    updateFusion(frame.settings);
+
+    r.activeZone = -1;
+    r.predictedZone = -1;
+    r.captureLatency = 0;
+    r.stageTimings.resize(stages.size());
+
+    float megapixels = frame.layout.masterWidth * frame.layout.masterHeight / 1000000.0f;
+
+    for(int i = 0; i < stages.size(); i++){
+
+        StageTiming &t = r.stageTimings[i];
+        t.name = stages[i] -> name;
+        t.bEnabled = stages[i] -> bEnabled;
+        t.wallTime = 0;
+        t.cpuTime = 0;
+        t.throughput = 0;
+
+        if( !stages[i] -> bEnabled ) continue;
+
+        uint64_t wallStart = ofGetElapsedTimeMicros();
+        //this thread plus whatever band workers did for it,
+        //they've all reported back by the time process() returns
+        uint64_t cpuStart = CpuMeter::getThreadCpuTime();
+        uint64_t workerStart = CpuMeter::getWorkerCpuTime();
+
+        stages[i] -> process(frame, r);
+
+        uint64_t wall = ofGetElapsedTimeMicros() - wallStart;
+
+        PROFILE_RECORD(profileSections[i], wall);
+
+        t.wallTime = wall/1000.0f;
+        uint64_t cpu = CpuMeter::getThreadCpuTime() - cpuStart;
+        cpu += CpuMeter::getWorkerCpuTime() - workerStart;
+
+        t.cpuTime = cpu/1000.0f;
+
+        if( wall > 0 ){
+            t.throughput = megapixels / (wall/1000000.0f);
+        }
+
+    }
+
+}
+
+void StageGraph::reset(){
+
+    for(map<string, shared_ptr<PipelineStage> >::iterator it = instances.begin(); it != instances.end(); ++it){
+        it -> second -> reset();
+    }
+
+}
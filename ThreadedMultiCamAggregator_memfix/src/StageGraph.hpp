@@ -0,0 +1,79 @@
+//
+//  StageGraph.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef StageGraph_hpp
+#define StageGraph_hpp
+
+#include <stdio.h>
+
+#endif /* StageGraph_hpp */
+
+#include "ofMain.h"
+#include "PipelineData.hpp"
+#include "PipelineStage.hpp"
+#include <functional>
+
+#pragma once
+
+
+/*
+ * StageGraph:
+ *  Ordered list of pipeline stages built from a list of names
+ *  (settings.stageOrder, loaded from pipeline.txt). Stages can
+ *  be reordered, switched off with a leading '-' or left out.
+ *
+ *  Every stage is timed each tick: wall time, CPU time of the
+ *  Aggregator thread and pixel throughput over the composite.
+ *
+ *  If parallel bands are on and erode/dilate directly follow
+ *  the background stage, they run inside the bands instead.
+ *
+ *  Only used from the Aggregator thread.
+ */
+
+class StageGraph{
+
+public:
+
+    typedef std::function< shared_ptr<PipelineStage>() > StageFactory;
+
+    StageGraph();
+
+    //registers the built-in stages
+    void setup(shared_ptr<OscSender> oscSender, shared_ptr<PreviewStreamer> previewStreamer);
+
+    //custom stages can be added by name and then used in the order
+    void registerStage(string name, StageFactory factory);
+
+    //unknown names are skipped with a warning
+    void build(const vector<string> & order);
+
+    //runs every enabled stage in order and fills r.stageTimings
+    void process(PipelineFrame & frame, PipelineResult & r);
+
+    //drop the learned state of every stage
+    void reset();
+
+    const vector<string> & getOrder() const;
+
+    static vector<string> getDefaultOrder();
+
+
+private:
+
+    void updateFusion(const PipelineSettings & s);
+
+    map<string, StageFactory> factories;
+    vector< shared_ptr<PipelineStage> > stages;
+
+    vector<string> order;
+
+    //Profiler section of each stage, -1 for custom ones
+    vector<int> profileSections;
+
+    //stages keep their state across rebuilds
+    map<string, shared_ptr<PipelineStage> > instances;
+
+};
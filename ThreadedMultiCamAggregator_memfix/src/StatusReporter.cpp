@@ -0,0 +1,70 @@
+//
+//  StatusReporter.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "StatusReporter.hpp"
+
+
+StatusReporter::StatusReporter(){
+
+    status = WARMING_UP;
+    lastSentStatus = -1;
+    lastSendTime = 0;
+    lastHeartbeatTime = 0;
+
+}
+
+void StatusReporter::setup(shared_ptr<OscSender> _oscSender){
+
+    oscSender = _oscSender;
+
+}
+
+void StatusReporter::update(const vector<Feed> & feeds, const vector<int> & addresses, const AppSettings & settings){
+
+    if( ofGetElapsedTimef() - lastSendTime <= settings.statusSendRate ) return;
+
+    if( ofGetElapsedTimef() < settings.waitBeforeOSC ){
+        status = WARMING_UP;
+    } else {
+
+        //active cameras are the ones with a non-zero address
+        float longestTimeSinceUpdate = 0;
+
+        for(int i = 0; i < addresses.size() && i < feeds.size(); i++){
+            if( addresses[i] > 0 ){
+                longestTimeSinceUpdate = max( longestTimeSinceUpdate, feeds[i].timeSinceLastFrame );
+            }
+        }
+
+        status = longestTimeSinceUpdate > settings.sysNotOKTime ? NOT_OK : OK;
+    }
+
+    bool bSend = !settings.deltaOSC || status != lastSentStatus || ofGetElapsedTimef() - lastHeartbeatTime > settings.heartbeatInterval;
+
+    if( bSend && oscSender ){
+
+        ofxOscMessage statusMessage;
+        statusMessage.setAddress("/status");
+        statusMessage.addInt32Arg(status);
+
+        //never waits on the network, worst case it's dropped and counted
+        statusBatch.messages.push_back(statusMessage);
+        oscSender -> send(statusBatch);
+
+        lastSentStatus = status;
+        lastHeartbeatTime = ofGetElapsedTimef();
+    }
+
+    lastSendTime = ofGetElapsedTimef();
+
+}
+
+int StatusReporter::getStatus() const{
+    return status;
+}
+
+double StatusReporter::getLastSendTime() const{
+    return lastSendTime;
+}
@@ -0,0 +1,67 @@
+//
+//  StatusReporter.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef StatusReporter_hpp
+#define StatusReporter_hpp
+
+#include <stdio.h>
+
+#endif /* StatusReporter_hpp */
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "Feed.hpp"
+#include "OscSender.hpp"
+#include "AppSettings.hpp"
+
+#pragma once
+
+
+/*
+ * StatusReporter:
+ *  The app's health and the /status message, the same rules
+ *  for ofApp and HeadlessApp. Every statusSendRate seconds:
+ *
+ *      0 = warming up, before waitBeforeOSC
+ *      1 = OK
+ *      2 = NOT OK, a camera with an address hasn't sent a
+ *          frame in sysNotOKTime seconds
+ *
+ *  In change-only mode (deltaOSC) /status only goes out when
+ *  it changes and otherwise as often as the heartbeat.
+ */
+
+class StatusReporter{
+
+public:
+
+    enum Status{
+        WARMING_UP = 0,
+        OK = 1,
+        NOT_OK = 2
+    };
+
+    StatusReporter();
+
+    void setup(shared_ptr<OscSender> _oscSender);
+    void update(const vector<Feed> & feeds, const vector<int> & addresses, const AppSettings & settings);
+
+    int getStatus() const;
+
+    //ofGetElapsedTimef() of the last check, sent or not
+    double getLastSendTime() const;
+
+
+private:
+
+    shared_ptr<OscSender> oscSender;
+    OscSender::Batch statusBatch;
+
+    int status;
+    int lastSentStatus;
+    double lastSendTime;
+    double lastHeartbeatTime;
+
+};
@@ -0,0 +1,82 @@
+//
+//  SyntheticSource.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "SyntheticSource.hpp"
+
+
+SyntheticSource::SyntheticSource(){
+
+    width = 0;
+    height = 0;
+    frameNum = 0;
+
+}
+
+void SyntheticSource::setup(int w, int h, int numBlobs){
+
+    width = w;
+    height = h;
+    frameNum = 0;
+
+    pix.allocate(width, height, OF_IMAGE_GRAYSCALE);
+
+    noise.resize(width * height + 4096);
+    for(int i = 0; i < noise.size(); i++){
+        noise[i] = 20 + (int)ofRandom(25);
+    }
+
+    blobs.resize(numBlobs);
+    for(int i = 0; i < blobs.size(); i++){
+        blobs[i].pos.set( ofRandom(width), ofRandom(height) );
+        blobs[i].vel.set( ofRandom(-2, 2), ofRandom(-2, 2) );
+        blobs[i].radius = ofRandom(6, 14);
+        blobs[i].warmth = 150 + (int)ofRandom(100);
+    }
+
+}
+
+void SyntheticSource::update(){
+
+    //shift the noise a little every frame
+    int offset = (frameNum * 997) % 4096;
+    memcpy(pix.getData(), &noise[offset], width * height);
+
+    for(int i = 0; i < blobs.size(); i++){
+
+        Blob &b = blobs[i];
+
+        b.pos += b.vel;
+
+        if( b.pos.x < 0 || b.pos.x >= width ) b.vel.x *= -1;
+        if( b.pos.y < 0 || b.pos.y >= height ) b.vel.y *= -1;
+
+        b.pos.set( ofClamp(b.pos.x, 0, width - 1), ofClamp(b.pos.y, 0, height - 1) );
+
+        int r = b.radius;
+        int x0 = std::max(0, (int)b.pos.x - r);
+        int x1 = std::min(width - 1, (int)b.pos.x + r);
+        int y0 = std::max(0, (int)b.pos.y - r);
+        int y1 = std::min(height - 1, (int)b.pos.y + r);
+
+        for(int y = y0; y <= y1; y++){
+            for(int x = x0; x <= x1; x++){
+
+                float dx = x - b.pos.x;
+                float dy = y - b.pos.y;
+
+                if( dx*dx + dy*dy <= b.radius * b.radius ){
+                    pix[y * width + x] = b.warmth;
+                }
+            }
+        }
+    }
+
+    frameNum++;
+
+}
+
+const ofPixels & SyntheticSource::getPixels() const{
+    return pix;
+}
@@ -0,0 +1,56 @@
+//
+//  SyntheticSource.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef SyntheticSource_hpp
+#define SyntheticSource_hpp
+
+#include <stdio.h>
+
+#endif /* SyntheticSource_hpp */
+
+#include "ofMain.h"
+#pragma once
+
+
+/*
+ * SyntheticSource:
+ *  Fake composite for benchmarking without cameras.
+ *  Noisy dark background with warm round blobs walking
+ *  around and bouncing off the edges.
+ */
+
+class SyntheticSource{
+
+public:
+
+    SyntheticSource();
+
+    void setup(int w, int h, int numBlobs);
+    void update();
+
+    const ofPixels & getPixels() const;
+
+    struct Blob{
+        ofVec2f pos;
+        ofVec2f vel;
+        float radius;
+        int warmth;
+    };
+
+    vector<Blob> blobs;
+
+
+private:
+
+    int width, height;
+    unsigned long long frameNum;
+
+    ofPixels pix;
+
+    //a few frames worth of noise to cycle through
+    //so we don't pay for random numbers every frame
+    vector<unsigned char> noise;
+
+};
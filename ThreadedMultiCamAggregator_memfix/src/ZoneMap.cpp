@@ -0,0 +1,262 @@
+//
+//  ZoneMap.cpp
+//  ThreadedMultiCamAggregator
+//
+
+#include "ZoneMap.hpp"
+
+
+const int ZoneMap::MAX_ZONES;
+const uint8_t ZoneMap::NONE;
+
+ZoneMap::ZoneMap(){
+
+    width = 0;
+    height = 0;
+
+}
+
+void ZoneMap::build(const vector< vector<ofVec2f> > & polygons, int w, int h){
+
+    width = w;
+    height = h;
+
+    int numZones = std::min((int)polygons.size(), MAX_ZONES);
+
+    ids.assign(width * height, NONE);
+
+    zoneSpans.resize(numZones);
+    zoneRowStart.resize(numZones);
+    zoneArea.assign(numZones, 0);
+    zoneRect.resize(numZones);
+
+
+    //----------SCAN CONVERT----------
+    for(int z = 0; z < numZones; z++){
+
+        scanConvert(polygons[z], zoneSpans[z], zoneRowStart[z], z);
+
+        for(int i = 0; i < zoneSpans[z].size(); i++){
+            zoneArea[z] += zoneSpans[z][i].end - zoneSpans[z][i].start;
+        }
+
+        findRectangle(z);
+
+    }
+
+    //outermost first so the inner zones end up on top
+    for(int z = numZones - 1; z >= 0; z--){
+
+        for(int y = 0; y < height; y++){
+
+            for(int i = zoneRowStart[z][y]; i < zoneRowStart[z][y + 1]; i++){
+                const Span &s = zoneSpans[z][i];
+                memset(&ids[y * width + s.start], z, s.end - s.start);
+            }
+
+        }
+
+    }
+
+
+    //----------SEGMENTS----------
+    segments.clear();
+    rowSegStart.assign(height + 1, 0);
+
+    for(int y = 0; y < height; y++){
+
+        rowSegStart[y] = segments.size();
+
+        const uint8_t *row = &ids[y * width];
+        int x = 0;
+
+        while( x < width ){
+
+            int start = x;
+            uint8_t id = row[x];
+
+            while( x < width && row[x] == id ) x++;
+
+            if( id != NONE ){
+                Span s = { start, x, id };
+                segments.push_back(s);
+            }
+
+        }
+
+    }
+
+    rowSegStart[height] = segments.size();
+
+}
+
+void ZoneMap::scanConvert(const vector<ofVec2f> & polygon, vector<Span> & out, vector<int> & rowStart, int zone){
+
+    out.clear();
+    rowStart.assign(height + 1, 0);
+
+    int n = polygon.size();
+
+    for(int y = 0; y < height; y++){
+
+        rowStart[y] = out.size();
+
+        if( n < 3 ) continue;
+
+        //same even-odd rule as ofPolyline::inside, at the pixel center
+        float cy = y + 0.5f;
+
+        crossings.clear();
+
+        for(int i = 0, j = n - 1; i < n; j = i++){
+
+            const ofVec2f &a = polygon[i];
+            const ofVec2f &b = polygon[j];
+
+            if( (a.y > cy) != (b.y > cy) ){
+                crossings.push_back( a.x + (cy - a.y) * (b.x - a.x) / (b.y - a.y) );
+            }
+
+        }
+
+        std::sort(crossings.begin(), crossings.end());
+
+        for(int i = 0; i + 1 < crossings.size(); i += 2){
+
+            //pixels whose centers are between the two crossings
+            int start = std::max(0, (int)ceilf(crossings[i] - 0.5f));
+            int end = std::min(width, (int)ceilf(crossings[i + 1] - 0.5f));
+
+            if( end > start ){
+                Span s = { start, end, zone };
+                out.push_back(s);
+            }
+
+        }
+
+    }
+
+    rowStart[height] = out.size();
+
+}
+
+void ZoneMap::findRectangle(int zone){
+
+    const vector<Span> &spans = zoneSpans[zone];
+    const vector<int> &rowStart = zoneRowStart[zone];
+
+    Rect &r = zoneRect[zone];
+    r.bValid = false;
+
+    if( spans.empty() ) return;
+
+    //one span per row, all the same, on consecutive rows
+    r.x0 = spans[0].start;
+    r.x1 = spans[0].end;
+    r.y0 = -1;
+    r.y1 = -1;
+
+    for(int y = 0; y < height; y++){
+
+        int n = rowStart[y + 1] - rowStart[y];
+
+        if( n == 0 ){
+            if( r.y0 != -1 && r.y1 == -1 ) r.y1 = y;
+            continue;
+        }
+
+        const Span &s = spans[ rowStart[y] ];
+
+        if( n > 1 || s.start != r.x0 || s.end != r.x1 || r.y1 != -1 ) return;
+
+        if( r.y0 == -1 ) r.y0 = y;
+
+    }
+
+    if( r.y1 == -1 ) r.y1 = height;
+
+    r.bValid = true;
+
+}
+
+bool ZoneMap::isAllocated() const{
+    return width > 0 && height > 0;
+}
+
+int ZoneMap::getWidth() const{
+    return width;
+}
+
+int ZoneMap::getHeight() const{
+    return height;
+}
+
+int ZoneMap::getNumZones() const{
+    return zoneSpans.size();
+}
+
+int ZoneMap::getZone(int x, int y) const{
+
+    if( x < 0 || y < 0 || x >= width || y >= height ) return -1;
+
+    uint8_t id = ids[y * width + x];
+
+    return id == NONE ? -1 : id;
+
+}
+
+int ZoneMap::getZone(int y, int x0, int x1) const{
+
+    if( y < 0 || y >= height ) return -1;
+
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, width);
+
+    int best = -1;
+
+    //segments are sorted by x, a row only has a handful
+    for(int i = rowSegStart[y]; i < rowSegStart[y + 1]; i++){
+
+        const Span &s = segments[i];
+
+        if( s.start >= x1 ) break;
+        if( s.end <= x0 ) continue;
+
+        if( best == -1 || s.zone < best ) best = s.zone;
+
+    }
+
+    return best;
+
+}
+
+int ZoneMap::getZoneArea(int zone) const{
+    return zoneArea[zone];
+}
+
+bool ZoneMap::getRectangle(int zone, int & x0, int & y0, int & x1, int & y1) const{
+
+    const Rect &r = zoneRect[zone];
+
+    if( !r.bValid ) return false;
+
+    x0 = r.x0;
+    y0 = r.y0;
+    x1 = r.x1;
+    y1 = r.y1;
+
+    return true;
+
+}
+
+const vector<uint8_t> & ZoneMap::getIds() const{
+    return ids;
+}
+
+const vector<ZoneMap::Span> & ZoneMap::getSpans(int zone) const{
+    return zoneSpans[zone];
+}
+
+const vector<int> & ZoneMap::getRowStarts(int zone) const{
+    return zoneRowStart[zone];
+}
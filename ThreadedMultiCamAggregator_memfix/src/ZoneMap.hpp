@@ -0,0 +1,106 @@
+//
+//  ZoneMap.hpp
+//  ThreadedMultiCamAggregator
+//
+
+#ifndef ZoneMap_hpp
+#define ZoneMap_hpp
+
+#include <stdio.h>
+
+#endif /* ZoneMap_hpp */
+
+#include "ofMain.h"
+
+#pragma once
+
+
+/*
+ * ZoneMap:
+ *  The zone polygons rasterized once, whenever they change,
+ *  instead of point-in-polygon tests every frame.
+ *
+ *      -every zone is scan converted (even-odd, pixel centers)
+ *       into [start, end) spans per row
+ *      -the zone-ID map holds the lowest (innermost) zone
+ *       covering each pixel, NONE if there isn't one
+ *      -the map is also kept as per row segments of the same
+ *       ID, so the innermost zone under a run of pixels costs
+ *       the few segments it overlaps, not one test per pixel
+ *      -zones that come out as a plain pixel rectangle are
+ *       noted so they can be summed in one go
+ *
+ *  Works for any polygon shape. The cost of a lookup doesn't
+ *  depend on how many vertices or zones there are. Never
+ *  modified after being sent, ofApp makes a new one on edits.
+ */
+
+class ZoneMap{
+
+public:
+
+    ZoneMap();
+
+    //lower index wins where zones overlap. Up to MAX_ZONES
+    void build(const vector< vector<ofVec2f> > & polygons, int w, int h);
+
+    bool isAllocated() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getNumZones() const;
+
+    //innermost zone at a pixel, -1 if none or off the map
+    int getZone(int x, int y) const;
+
+    //innermost zone under pixels [x0, x1) of row y, -1 if none
+    int getZone(int y, int x0, int x1) const;
+
+    //pixels in the zone, counting overlapped ones too
+    int getZoneArea(int zone) const;
+
+    //true if the zone's pixels are exactly [x0, x1) x [y0, y1)
+    bool getRectangle(int zone, int & x0, int & y0, int & x1, int & y1) const;
+
+    const vector<uint8_t> & getIds() const;
+
+    static const int MAX_ZONES = 255;
+    static const uint8_t NONE = 255;
+
+    //one row's worth of a zone, or of the map
+    struct Span{
+        int start, end;
+        int zone;
+    };
+
+    //every zone's own spans, rowStart[z][y] indexes into spans[z]
+    const vector<Span> & getSpans(int zone) const;
+    const vector<int> & getRowStarts(int zone) const;
+
+
+private:
+
+    void scanConvert(const vector<ofVec2f> & polygon, vector<Span> & out, vector<int> & rowStart, int zone);
+    void findRectangle(int zone);
+
+    int width, height;
+
+    vector<uint8_t> ids;
+
+    vector< vector<Span> > zoneSpans;
+    vector< vector<int> > zoneRowStart;
+    vector<int> zoneArea;
+
+    struct Rect{
+        bool bValid;
+        int x0, y0, x1, y1;
+    };
+    vector<Rect> zoneRect;
+
+    //the id map run length encoded, rowSegStart[y] indexes segments
+    vector<Span> segments;
+    vector<int> rowSegStart;
+
+    //scratch for the edge crossings of one row
+    vector<float> crossings;
+
+};
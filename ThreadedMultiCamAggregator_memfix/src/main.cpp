@@ -1,12 +1,37 @@
 #include "ofMain.h"
+#include "ofAppNoWindow.h"
 #include "ofApp.h"
+#include "HeadlessApp.hpp"
 
 //========================================================================
-int main( ){
+int main( int argc, char *argv[] ){
+
+    //--headless (or building with HEADLESS_RUNTIME defined) runs
+    //the same pipeline with no window and no GL context at all,
+    //settings come from the xml files the gui saved
+    bool bHeadless = false;
+
+#ifdef HEADLESS_RUNTIME
+    bHeadless = true;
+#endif
+
+    for(int i = 1; i < argc; i++){
+        if( string(argv[i]) == "--headless" ) bHeadless = true;
+    }
+
+    if( bHeadless ){
+
+        ofAppNoWindow window;
+        ofSetupOpenGL(&window, 1600,800, OF_WINDOW);
+        ofRunApp(new HeadlessApp());
+
+        return 0;
+    }
+
     ofAppGlutWindow window; // create a window
     // set width, height, mode (OF_WINDOW or OF_FULLSCREEN)
     ofSetupOpenGL(&window, 1600,800, OF_WINDOW);
-    
+
 	// this kicks off the running of my app
 	// can be OF_WINDOW or OF_FULLSCREEN
 	// pass in width and height too:
@@ -13,12 +13,7 @@ void ofApp::setup(){
     bDrawGui = true;
     
     //setup pixel objects
-
-    
-    processedPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    threshPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    backgroundPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
-    foregroundPix.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
+    //(the pipeline's pixel objects live in the Aggregator)
     
     blackFrame.allocate(camWidth, camHeight, OF_IMAGE_GRAYSCALE);
     blackFrame.setColor(0);
@@ -27,16 +22,6 @@ void ofApp::setup(){
     blackFrameRot90.allocate(camHeight, camWidth, OF_IMAGE_GRAYSCALE);
     blackFrameRot90.setColor(0);
     
-    //masterPix object will get immediately re-allocated when things are repositioned,
-    //but allocate it much larger to start just to be safe
-    masterPix.allocate(camWidth*3, camWidth*3, OF_IMAGE_GRAYSCALE);
-    
-    masterImgPlaceHolder.allocate(camWidth*3, camWidth*3, OF_IMAGE_GRAYSCALE);
-    
-    //keep track of the dimensions of the running background
-    backgroundWidth = 0;
-    backgroundHeight = 0;
-    
 
     
     
@@ -85,9 +70,50 @@ void ofApp::setup(){
     }
     
     
-    osc.setup(oscIP, oscPort);
-    lastStatusSendTime = 0;
-    lastStatusSendTime = 0;
+    //all OSC goes out on the sender's own thread
+    oscSender = make_shared<OscSender>();
+    oscSender -> setup(oscIP, oscPort);
+    
+    
+    //----------Preview stream setup----------
+    
+    //same format as osc.txt, IP then port
+    ofBuffer previewBuffer = ofBufferFromFile("preview.txt");
+    
+    previewIP = "127.0.0.1";
+    previewPort = 12346;
+    
+    int previewLine = 0;
+    
+    for (ofBuffer::Line it = previewBuffer.getLines().begin(), end = previewBuffer.getLines().end(); it != end; ++it) {
+        
+        string line = *it;
+        
+        if(previewLine == 0 && !line.empty()){
+            previewIP = line;
+        } else if(previewLine == 1 && !line.empty()){
+            previewPort = ofToInt(line);
+        }
+        
+        previewLine++;
+    }
+    
+    //only gets frames while "Stream preview" is on
+    previewStreamer = make_shared<PreviewStreamer>();
+    previewStreamer -> setup(previewIP, previewPort);
+    
+    //same /status rules as HeadlessApp
+    statusReporter.setup(oscSender);
+    
+    
+    //----------Detection pipeline----------
+    
+    //the aggregator thread hands /detected to the sender on
+    //its own, we only send /status from here
+    aggregator.setup(camWidth, camHeight, oscSender, previewStreamer);
+    detection = aggregator.getResult();
+    
+    frameAssembler.setup(camWidth, camHeight);
     
     
     
@@ -181,7 +207,12 @@ void ofApp::setup(){
     maskScreenPos.set(leftMargin, topMargin + 10);
     
     
-    //load up the gui settings
+    //load up the gui settings (also loads the mask).
+    //The mask image only goes to and from disk
+    maskImg.setUseTexture(false);
+    bMaskChanged = true;
+    bPaintingMask = false;
+    maskGeneration = nextImageGeneration();
     loadSettings();
     
     
@@ -217,14 +248,27 @@ void ofApp::setup(){
         
         //cam number, USB ID, width and height
         feeds[i].setup( i, addresses[i], camWidth, camHeight );
+    }
+    
+    
+    //warm start the per-camera backgrounds from the last saved
+    //one. Each camera gets its own region back, wherever it was
+    BackgroundStore backgroundLoader;
+    ofPixels savedBackground;
+    Aggregator::Layout savedLayout;
+    
+    if( backgroundLoader.load(savedBackground, savedLayout) && savedLayout.tileWidth == camWidth && savedLayout.tileHeight == camHeight ){
+        
+        for(int i = 0; i < feeds.size(); i++){
+            
+            ofPixels tile;
+            
+            if( BackgroundStore::extractTile(savedBackground, savedLayout, i, tile) ){
+                feeds[i].seedBackground(tile);
+            }
+            
+        }
         
-        //set refs to GUI vals
-        feeds[i].blurAmt = &blurAmountSlider;
-        feeds[i].contrastExp = &contrastExpSlider;
-        feeds[i].contrastPhase = &contrastPhaseSlider;
-        feeds[i].stdDevThresh = &stdDevThreshSliders[i];
-        feeds[i].avgPixThresh = &avgPixelThreshSlider;
-        feeds[i].stdDevToggle = &stdDevBlackOutToggle;
     }
     
     
@@ -236,6 +280,11 @@ void ofApp::setup(){
     maxNumConsoleStrings = 10;
     consoleString.assign(maxNumConsoleStrings, "- ");
     
+    cpuMeter.setup(10.0f);
+    
+#if PROFILER_ENABLED
+    profiler.setup(1.0f, 10.0f, "profile.csv", "profile.json");
+#endif
     
 }
 
@@ -326,6 +375,8 @@ void ofApp::update(){
     //--------------------MASK MANAGEMENT--------------------
     if(clearMask){
         maskPix.setColor(0);
+        bMaskChanged = true;
+        maskGeneration = nextImageGeneration();
     }
     
     if(saveMask){
@@ -336,9 +387,17 @@ void ofApp::update(){
     if(loadMask){
         maskImg.load(maskFileName);
         maskPix = maskImg.getPixels();
+        bMaskChanged = true;
+        maskGeneration = nextImageGeneration();
     }
     
     
+    //first stroke since the layout changed, bring maskPix
+    //to the composite size so all of it can be painted
+    if( currentView == MASKING && ofGetMousePressed() && !bPaintingMask ){
+        fitMaskToComposite();
+    }
+    
     //drawing inside the mask
     //if we're inside the mask and we're in masking view
     if( currentView == MASKING && maskMousePos.x > 0 && maskMousePos.x < maskPix.getWidth() && maskMousePos.y > 0 && maskMousePos.y < maskPix.getHeight() ){
@@ -374,16 +433,23 @@ void ofApp::update(){
                 }
                 
             }
+            
+            bMaskChanged = true;
+            bPaintingMask = true;
+            maskGeneration = nextImageGeneration();
 
             
             
             
+        } else {
+            bPaintingMask = false;
         }
         
         
     } else {
         
         bMouseInsideMask = false;
+        bPaintingMask = false;
     }
 
     
@@ -457,6 +523,8 @@ void ofApp::update(){
     //new thermal cam frame?
     if( frameQueue.size() > 0 ){
         
+        PROFILE_SCOPE(Profiler::INGEST);
+        
 //        cout << "New Frames: " << frameQueue.size() << endl;
         
         //--------------------NEW FRAME -> FEED ASSIGNMENT--------------------
@@ -527,55 +595,9 @@ void ofApp::update(){
             
             
             
-            //get pix from cam
-            ofxCvColorImage rawImg;
-            rawImg.allocate(camWidth, camHeight);
-            rawImg.setFromPixels( (*frameQueue.begin()).pix.getData() , camWidth, camHeight);
-            
-            //convert RGBA camera data to single grayscale ofPixels
-//            ofxCvGrayscaleImage grayImg;
-//            grayImg.allocate(camWidth, camHeight);
-//            grayImg = rawImg;
-            
-            
-            ofPixels raw;
-            raw.setFromPixels(rawImg.getPixels().getData(), camWidth, camHeight, OF_IMAGE_COLOR_ALPHA);
-            
-            //blur it
-//            grayImg.blurGaussian(blurAmountSlider);
-            
-            //create a pixel object
-//            ofPixels gray;
-//            gray.setFromPixels(grayImg.getPixels().getData(), camWidth, camHeight, 1);
-            
-            //put the camera frame into the appropriate feed object
-            //Also do any flipping and adjust contrast since it's new data
-            int whichCam = -1;
-            
-            //find which cam it belongs to and
-            for(int i = 0; i < feeds.size(); i++){
-                
-                //Check current frame ID against feed ID
-                if( feeds[i].camID == thisCamId ){
-
-                    if( camMirrorToggles[i] ){
-                        raw.mirror(false, true);
-//                        gray.mirror(false, true);
-                    }
-
-                    whichCam = i;
-                    
-                    //send the raw and gray frames into the feed object
-                    feeds[i].newFrame( raw );
-                    
-                    break;
-                }
-            }
-            
-            //debug
-            if( whichCam == -1 ){
-//                cout << "ID not recognized: " << thisCamId <<endl;
-            }
+            //put the camera frame into the feed with its address,
+            //mirrored if the stitching gui says so
+            frameAssembler.ingest( feeds, (*frameQueue.begin()).pix, thisCamId, (*frameQueue.begin()).captureTime, appSettings, resetBGButton );
 
         
             //Now that we've retrieved the data from the queue, get rid of the oldest one.
@@ -595,361 +617,74 @@ void ofApp::update(){
         
 
         
-        //get the furthest Right and down parts of the aggregated image
-        //so the masterPix object can be resized appropriately
-        int furthestRight = 0;
-        int furthestDown = 0;
-        int furthestLeft = 10000;
-        int furthestUp = 10000;
-        
-
-        for(int i = 0; i < TOTAL_NUM_CAMS; i++){
-            
-            //dimensions will changed if camera is pasted into
-            //master pix straight or rotated 90
-            int xDim = camRotations[i] % 2 == 1 ? camHeight : camWidth;
-            int yDim = camRotations[i] % 2 == 1 ? camWidth : camHeight;
-
-            
-            int thisMaxRight = camPositions[i] -> x + xDim;
-            if(thisMaxRight > furthestRight){
-                furthestRight = thisMaxRight;
-            }
-            
-            int thisMaxBottom = camPositions[i] -> y + yDim;
-            if(thisMaxBottom > furthestDown){
-                furthestDown = thisMaxBottom;
-            }
-            
-            if(camPositions[i] -> x < furthestLeft) furthestLeft = camPositions[i] -> x;
-            if(camPositions[i] -> y < furthestUp) furthestUp = camPositions[i] -> y;
-            
-        }
-        
-        
+        //the space above and to the left of the cameras
+        ofRectangle bounds = FrameAssembler::getBounds(appSettings.getCamPositions(), appSettings.getCamRotations(), camWidth, camHeight);
         
         //trim out the space above and to the left in masterPix
-        if( (furthestLeft > 0 || furthestUp > 0) && trimMasterPixButton ){
+        if( (bounds.x > 0 || bounds.y > 0) && trimMasterPixButton ){
             
-            //subtract from all the camera position gui values
+            //subtract from all the camera position gui values,
+            //the composite below is sized from the trimmed ones
             for( int i = 0; i < TOTAL_NUM_CAMS; i++){
                 ofVec2f oldGuiVal = camPositions[i];
-                camPositions[i] = oldGuiVal - ofVec2f( furthestLeft, furthestUp );
-            }
-            
-            //subtract the trim amount from the master dimensions too
-            //so that the masterPix object doesnt have to wait for the next
-            //frame to update the trim
-            masterWidth -= furthestLeft;
-            masterHeight -= furthestUp;
-            
-        }
-        
-        
-        masterWidth = furthestRight;
-        masterHeight = furthestDown;
-        
-
-        
-        //if any of the dimensions are different, we need to reallocate
-        if( oldMasterWidth != masterWidth || oldMasterHeight != masterHeight ){
-
-            //Prepare the masterPix object to receive the camera's pixels
-            masterPix.clear();
-            
-            //Set the masterPix object to the new min and max bounds
-            masterPix.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-            masterPix.setColor(ofColor(0));
-            
-            
-            //reallocate all the other pixel objects while we're at it
-            processedPix.clear();
-            processedPix.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-            
-            threshPix.clear();
-            threshPix.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-            
-            backgroundPix.clear();
-            backgroundPix.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-            
-            foregroundPix.clear();
-            foregroundPix.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-
-            
-            //now store the new dims as old ones
-            oldMasterHeight = masterHeight;
-            oldMasterWidth = masterWidth;
-            
-            masterImgPlaceHolder.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
-            
-            cout << "Re-allocating pixel objects" << endl;
-        
-        }
-
-        
-        //all feeds are blended into masterPix object so we need to
-        //clear it every frame to avoid pixel build up
-        masterPix.setColor(ofColor(0));
-        
-        
-        //Now paste the new frame into the masterPix object
-        //with any rotations specified
-        for (int i = 0; i < TOTAL_NUM_CAMS; i++){
-            
-            
-            if( camRotations[i] != 0 ){
-                ofPixels feedOutput = feeds[i].getOutputPix();
-                feedOutput.rotate90( camRotations[i] );
-                
-                feedOutput.blendInto(masterPix, camPositions[i] -> x, camPositions[i] -> y);
-            } else {
-                feeds[i].getOutputPix().blendInto(masterPix, camPositions[i] -> x, camPositions[i] -> y);
-            }
-            
-            
-        }
-        
-        
-        //masterPix will hold the raw composite pixels
-        //We'll subtract the mask from it and store it in processedPix
-        if(useMask){
-            
-            
-            //check the dimensions of the maskPix vs the
-            //processedPix object before we do the subtraction
-            if( maskPix.getWidth() != processedPix.getWidth() || maskPix.getHeight() != maskPix.getHeight() ){
-                
-                cout << "Re-allocating mask to match processedPix dimensions" << endl;
-                cout << "Old mask dims: " << maskPix.getWidth() << ", " << maskPix.getHeight() << endl;
-                
-                //if there's a difference, make a copy with the proper dims,
-                //paste the mask into it then save it into the mask
-                ofPixels newMask;
-                newMask.allocate(processedPix.getWidth(), processedPix.getHeight(), OF_IMAGE_GRAYSCALE);
-
-                cout << "New mask dims: " << newMask.getWidth() << ", " << newMask.getHeight() << endl;
-                
-                
-                newMask.setColor(0);
-                
-                //pasteInto() will not work if destination is smaller than pix being pasted
-                //Method should crop on its own, but it doesn't so we'll do it manually
-                if ( maskPix.pasteInto(newMask, 0, 0) ){
-                    
-                    cout << "Paste successful" << endl;
-                    
-                } else {
-                    
-                    cout << "Paste not successful, using cropTo() instead." << endl;
-                    maskPix.cropTo(newMask, 0, 0, newMask.getWidth(), newMask.getHeight());
-                    
-                    
-                }
-                
-                maskPix = newMask;
-                
-                
-                //save the mask
-                maskImg.setFromPixels(maskPix);
-                maskImg.save(maskFileName);
-                
-                
-            }
-            
-            // master - mask = processed
-            ofxCv::subtract(masterPix, maskPix, processedPix);
-
-        
-        } else {
-            
-            //if we're not using the mask, just put masterPix directly into processedPix
-            processedPix = masterPix;
-            
-            
-        }
-        
-        
-        
-        //threshold if we're not using the running background
-        //otherwise, ofxCv::RunningBackground already returns a thresholded image
-        if( !useBgDiff ){
-            //set flag to true in case we switch back to using BG diff again
-            bNeedBGReset = true;
-            
-            //fill the back/foreground objects with something
-            //to clear buffer garbage being drawn to screen
-            backgroundPix.setColor(70);
-            
-            //without BG subtraction, foreground is essentially just the processed pix
-            foregroundPix = processedPix;
-            
-            ofxCv::threshold(processedPix, threshPix, thresholdSlider);
-            
-            
-        } else {
-            
-            //if the dimensions of the incoming master width and height
-            //the background will need to be reset or it will crash
-            if( backgroundWidth != masterWidth || backgroundHeight != masterHeight ){
-                bNeedBGReset = true;
-                backgroundWidth = masterWidth;
-                backgroundHeight = masterHeight;
-            }
-            
-            if(bNeedBGReset || resetBGButton){
-                
-                background.reset();
-                bNeedBGReset = false;
-                
+                camPositions[i] = oldGuiVal - ofVec2f( bounds.x, bounds.y );
             }
             
-            background.setDifferenceMode(ofxCv::RunningBackground::BRIGHTER);
-            background.setLearningTime(learningTime);
-            background.setThresholdValue(thresholdSlider);
-            
-            background.update(processedPix, threshPix);
-            
-            //get the foreground/background to draw to screen
-            ofxCv::toOf( background.getBackground(), backgroundPix );
-            ofxCv::toOf( background.getForeground(), foregroundPix );
         }
         
         
-        //ERODE it
-        for(int i = 0; i < numErosionsSlider; i++){
-            ofxCv::erode(threshPix);
+        //re-pack the mask only when it has been edited, and only once
+        //a stroke is finished. The aggregator thread may still be
+        //using the old one so always make a new one
+        if( bMaskChanged && !bPaintingMask ){
+            shared_ptr<BinaryMask> m = make_shared<BinaryMask>();
+            m -> setFromPixels(maskPix);
+            binaryMask = m;
+            bMaskChanged = false;
         }
         
-        //DILATE it
-        for(int i = 0; i < numDilationsSlider; i++){
-            ofxCv::dilate(threshPix);
-        }
-        
-        
-        //Define contour finder
-        contours.setMinArea(minBlobAreaSlider);
-        contours.setMaxArea(maxBlobAreaSlider);
-        contours.setThreshold(254);  //only detect white
         
-        // wait before forgetting something
-        contours.getTracker().setPersistence(persistenceSlider);
+        //--------------------HAND OFF TO AGGREGATOR THREAD--------------------
+        //Compositing and everything after it happens on the aggregator thread
+        Aggregator::Frame frame;
         
-        // an object can move up to X pixels per frame
-        contours.getTracker().setMaximumDistance(maxDistanceSlider);
+        frame.settings = appSettings.getPipelineSettings();
+        frame.settings.resetBackground = resetBGButton;
+        frame.settings.traceContours = currentView == MASKING || ( drawContoursToggle && (currentView == PIPELINE || currentView == ZONES) );
+        frame.settings.stageOrder = stageOrder;
         
-        //find dem blobs
-        contours.findContours(threshPix);
-        
-        
-        //Go through contours and see if any of the points lie within the detection zones
-        //start from inside and work outward. If inner zones are triggered, no need to check outerzone
-        
-        bool foundObject = false;
-        activeZone = -1;
+        //zones can be dragged around, so they come from the zones
+        //themselves rather than straight from the gui
+        vector< vector<ofVec2f> > zonePoints;
         
         for(int i = 0; i < zones.size(); i++){
-            
-            //get the ofPolyline from the zone's internal ofPath so we
-            //can use .inside()
-            ofPolyline p = zones[i].path.getOutline()[0];
-            
-            //for each CONTOUR...
-            for(int j = 0; j < contours.size(); j++){
-                
-                ofPolyline points = contours.getPolyline(j).getVertices();
-                
-                //for each POINT...
-                for(int k = 0; k < points.size(); k++){
-                    
-                    if( p.inside(points[k]) ){
-                        foundObject = true;
-                        activeZone = i;
-                        
-                        //no need to check other points in this contour
-                        break;
-                    }
-                    
-                }
-                
-                //no need to check other contours
-                if( foundObject ){
-                    break;
-                }
-                
-            }
-            
-            //no need to check other zones
-            if( foundObject ){
-                break;
-            }
+            zonePoints.push_back( zones[i].points );
         }
         
+        //sizes the composite, same as HeadlessApp
+        frameAssembler.assemble( frame, feeds, appSettings, zonePoints, binaryMask );
         
+        masterWidth = frame.layout.masterWidth;
+        masterHeight = frame.layout.masterHeight;
         
         
-        //if we found something and OSC is switched on, send the message
-        if( foundObject && sendOSCToggle ){
-            
-            //only send at the desired rate && wait after startup
-            if( ofGetElapsedTimef() - lastZoneSendTime > maxOSCSendRate && ofGetElapsedTimef() > waitBeforeOSCSlider ){
-                
-                ofxOscMessage zone;
-                
-                zone.setAddress("/detected");
-                zone.addIntArg( activeZone );
-                zone.addIntArg( contours.size() );
-                
-                osc.sendMessage(zone);
-                
-                
-                if( activeZone != -1 ){
-                    
-                    //find more or less where the blob is
-                    
-                    ofVec2f avgPos(0);
-                    
-                    for(int i = 0; i < contours.size(); i++){
-                        avgPos += ofxCv::toOf(contours.getCenter(i));
-                    }
-                    
-                    avgPos /= contours.size();
-                    
-                    int camNum = -1;
-                    
-                    //check where the blob is
-                    for(int i = 0; i < TOTAL_NUM_CAMS; i++){
-                        //first 6 cams are oriented horizontally so cam 7 has different bounds
-                        if( i < 6 ){
-                            if( avgPos.x > camPositions[i] -> x && avgPos.x < camPositions[i] -> x + camWidth && avgPos.y > camPositions[i] -> y && avgPos.y < camPositions[i] -> y + camHeight){
-                                camNum = i;
-                                break;
-                            }
-                        } else {
-                            if( avgPos.x > camPositions[i] -> x && avgPos.x < camPositions[i] -> x + camHeight && avgPos.y > camPositions[i] -> y && avgPos.y < camPositions[i] -> y + camWidth){
-                                camNum = i;
-                                break;
-                            }
-                        }
-                        
-                        
-                    }
-                    
-                    
-                    consoleString.pop_back();
-                    
-                    string log = "- Time: " + ofToString(ofGetElapsedTimef(), 2) + ", Cam Num (estimate): " + ofToString(camNum);
-                    consoleString.push_front(log);
-                    
-                }
-                
-                lastZoneSendTime = ofGetElapsedTimef();
-            
-            }
+        //if any of the dimensions are different, we need to reallocate
+        if( oldMasterWidth != masterWidth || oldMasterHeight != masterHeight ){
+
+            //now store the new dims as old ones
+            oldMasterHeight = masterHeight;
+            oldMasterWidth = masterWidth;
             
+            cout << "Re-allocating pixel objects" << endl;
+        
         }
         
         
+        //a layout change doesn't touch the mask here, the
+        //aggregator thread crops/pads the packed bits to the new
+        //composite. maskPix only catches up when it's painted
         
+        aggregator.analyze(frame);
         
         
     } else {
@@ -958,57 +693,40 @@ void ofApp::update(){
         
     }  //frame queue check
     
-
-    //if it's been long enough after start and long enough since last send time
-    if( ofGetElapsedTimef() - lastStatusSendTime > statusSendRate ){
-
-        //if there are ANY cameras that havent sent a
-        //frame in over 5 seconds status is NOT OK
-
-        //0 = warming up, 1 = OK, 2 = NOT OK
-        if( ofGetElapsedTimef() < waitBeforeOSCSlider ){
-            //warming up
-            appStatus = 0;
-        } else {
-            
-            //check all the cameras and the last time we got a frame from them.
-            //active cameras are listed in the address vector as non zero, so
-            //just check the cameras with a non-zero address for the last time they
-            //were updated
-            float longestTimeSinceUpdate = 0;
-            
-            for( int i = 0; i < addresses.size(); i++){
-                
-                if( addresses[i] > 0 ){
-                    if( feeds[i].timeSinceLastFrame > longestTimeSinceUpdate ){
-                        longestTimeSinceUpdate = feeds[i].timeSinceLastFrame;
-                    }
-                }
-                
-            }
-            
-            if( longestTimeSinceUpdate > sysNotOKSlider ){
-                //NOT OK (been more than 3 seconds since frame from camera
-                appStatus = 2;
-            } else {
-                //everything OK
-                appStatus = 1;
-            }
-            
-        }
-            
-            
+    
+    //pick up whatever the aggregator thread has finished
+    aggregator.update();
+    
+    if( aggregator.isFrameNew() ){
         
-        ofxOscMessage statusMessage;
-        statusMessage.setAddress("/status");
-        statusMessage.addInt32Arg(appStatus);
+        detection = aggregator.getResult();
+        activeZone = detection -> activeZone;
+        
+        for(int i = 0; i < aggregator.newConsoleLines.size(); i++){
+            consoleString.pop_back();
+            consoleString.push_front( aggregator.newConsoleLines[i] );
+        }
         
-        osc.sendMessage(statusMessage);
+    }
+    
+
+    //0 = warming up, 1 = OK, 2 = NOT OK, same rules as HeadlessApp
+    statusReporter.update( feeds, addresses, appSettings );
+    appStatus = statusReporter.getStatus();
+    
+    
+    if( cpuMeter.update() ){
         
-        lastStatusSendTime = ofGetElapsedTimef();
+        CachedTexture::Stats textureStats = CachedTexture::getStats();
         
+        cout << "[ofApp] " << cpuMeter.getReport() << endl;
+        cout << "[ofApp] Textures uploaded: " << textureStats.bytesUploaded/(1024*1024) << " MB, saved by skipping: " << textureStats.bytesSaved/(1024*1024) << " MB" << endl;
     }
     
+#if PROFILER_ENABLED
+    profiler.update();
+#endif
+    
     
     //set to headless mode if we havent moved the mouse in a while
     float timeSinceLastMovement = ofGetElapsedTimef() - lastInputTime;
@@ -1083,13 +801,61 @@ void ofApp::draw(){
         oscData += "        1 = OK\n";
         oscData += "        2 = NOT OK\n";
         oscData += "        (NOT OK = more than 3 seconds since a camera has updated)\n";
+        oscData += "\n";
+        oscData += "Change-only mode:\n";
+        oscData += "    int32 sequence # first on every event\n";
+        oscData += "    /track/new, /track/update: id, x, y, zone\n";
+        oscData += "    /track/lost: id\n";
+        oscData += "    /zone/enter, /zone/exit: zone, id\n";
+        oscData += "    /delta/detected, /delta/predicted,\n";
+        oscData += "        /delta/occupancy: as without it\n";
+        oscData += "    /heartbeat: last sequence #, frame,\n";
+        oscData += "        tracks, active zone\n";
+        oscData += "\n";
+        oscData += "Time tags:\n";
+        oscData += "    bundle time = newest capture (NTP)\n";
+        oscData += "    /frameAges: float ms per camera\n";
+        oscData += "        older than the newest, -1 = unknown\n";
+        oscData += "\n";
+        
+        OscSender::Stats oscStats = oscSender -> getStats();
+        
+        oscData += "Sender\n";
+        oscData += "------------------\n";
+        oscData += "Bundles sent: " + ofToString(oscStats.bundlesSent) + " (" + ofToString(oscStats.messagesSent) + " messages)\n";
+        oscData += "Dropped (queue of " + ofToString(oscStats.queueCapacity) + " full): " + ofToString(oscStats.dropped) + "\n";
+        oscData += "Latency ms, last/mean/max: " + ofToString(oscStats.lastLatency, 2) + " / " + ofToString(oscStats.meanLatency, 2) + " / " + ofToString(oscStats.maxLatency, 2) + "\n";
+        oscData += "\n";
+        
+        PreviewStreamer::Stats previewStats = previewStreamer -> getStats();
+        
+        oscData += "Preview Stream (" + previewIP + ":" + ofToString(previewPort) + ")\n";
+        oscData += "------------------\n";
+        oscData += "Frames sent: " + ofToString(previewStats.framesSent) + ", dropped: " + ofToString(previewStats.framesDropped) + "\n";
+        oscData += "Last frame: " + ofToString(previewStats.lastFrameBytes/1024.0f, 1) + " KB (" + ofToString(previewStats.lastRatio, 1) + ":1)\n";
+        oscData += "Encode ms: " + ofToString(previewStats.meanEncodeTime, 2) + ", hand over ms: " + ofToString(previewStats.lastSubmitTime, 2) + "\n";
+        oscData += "Budget allows: " + ofToString(previewStats.fps, 1) + " fps\n";
+        oscData += "\n";
+        
+        oscData += "Process\n";
+        oscData += "------------------\n";
+        oscData += "CPU: " + ofToString(cpuMeter.getCpu(), 1) + "% of one core\n";
+        oscData += "Loop: " + ofToString(cpuMeter.getLoopRate(), 1) + " fps\n";
+        oscData += "\n";
+        
+        CachedTexture::Stats textureStats = CachedTexture::getStats();
+        
+        oscData += "Texture uploads\n";
+        oscData += "------------------\n";
+        oscData += "Uploaded: " + ofToString(textureStats.uploads) + " (" + ofToString(textureStats.bytesUploaded/(1024.0f*1024.0f), 1) + " MB)\n";
+        oscData += "Skipped, unchanged: " + ofToString(textureStats.skipped) + " (" + ofToString(textureStats.bytesSaved/(1024.0f*1024.0f), 1) + " MB saved)\n";
         
         ofSetColor(255);
         ofDrawBitmapString(oscData, leftMargin, topMargin + 100);
         
         
         string sentString;
-        float t = ofMap(ofGetElapsedTimef() - lastStatusSendTime, 0, 0.1, 255, 100, true);
+        float t = ofMap(ofGetElapsedTimef() - statusReporter.getLastSendTime(), 0, 0.1, 255, 100, true);
         
         if( sendOSCToggle ){
             ofSetColor(0, 255, 0, t);
@@ -1134,6 +900,20 @@ void ofApp::draw(){
         ofDrawRectangle(statusPos.x - 5, statusPos.y - 15, 160, 20);
         ofDrawBitmapString(statusString, statusPos);
         ofPopStyle();
+        
+#if PROFILER_ENABLED
+        //rolling window of the last few hundred calls per section
+        string profileData = "Profiler (last " + ofToString(Profiler::WINDOW) + " calls)\n";
+        profileData += "------------------\n";
+        profileData += profiler.getReportString();
+        profileData += "\nPer call: frame, camera frame (preprocessN)\n";
+        profileData += "or band (threshold, fused morphology)\n";
+        profileData += "Saved every 10s to profile.csv/json\n";
+        
+        ofSetColor(255);
+        ofDrawBitmapString(profileData, leftMargin + 380, topMargin + 100);
+#endif
+        
     } else if( currentView == ALL_CAMS ){
         
         
@@ -1251,8 +1031,8 @@ void ofApp::draw(){
         
         ofSetColor(255);
         string warning = "";
-        warning += "Learned background subtraction is cleared whenever the\n";
-        warning += "composite image's dimensions are changed.";
+        warning += "With Per-camera BG on, layout changes don't touch the learned\n";
+        warning += "background. Otherwise it is moved along with each camera.";
 //        warning += "\n";
 //        warning += "Also, 7th Cam automatically positions itself to the far\n";
 //        warning += "right corner of the aggregate.\n";
@@ -1271,10 +1051,9 @@ void ofApp::draw(){
         
         
         //draw the stitched raw view, before
-        ofImage img;
-        img.setFromPixels(masterPix.getData(), masterPix.getWidth(), masterPix.getHeight(), OF_IMAGE_GRAYSCALE);
         ofSetColor(255);
-        img.draw(maskScreenPos);
+        compositeTexture.update(detection -> masterPix, detection -> generation);
+        compositeTexture.draw(maskScreenPos);
         
         
         //draw cam boxes
@@ -1299,19 +1078,19 @@ void ofApp::draw(){
         note += "Save/Load to and from png in data folder\n";
         
         ofSetColor(maskCol);
-        ofDrawBitmapString(note, maskScreenPos.x + masterPix.getWidth() + 10, maskScreenPos.y + 10);
+        ofDrawBitmapString(note, maskScreenPos.x + detection -> masterPix.getWidth() + 10, maskScreenPos.y + 10);
         
         
         //draw the mask
         ofSetColor(maskCol, 100);
-        maskImg.setFromPixels(maskPix);
-        maskImg.draw(maskScreenPos);
+        maskTexture.update(maskPix, maskGeneration);
+        maskTexture.draw(maskScreenPos);
         
         //draw the Foreground Pix below the masking for comparison with the mask
         ofSetColor(255);
         ofDrawBitmapString("Foreground", maskScreenPos.x, maskScreenPos.y - 5 + masterHeight + gutter);
-        img.setFromPixels(foregroundPix.getData(), foregroundPix.getWidth(), foregroundPix.getHeight(), OF_IMAGE_GRAYSCALE);
-        img.draw(maskScreenPos.x, maskScreenPos.y + masterHeight + gutter);
+        foregroundTexture.update(detection -> foregroundPix, detection -> generation);
+        foregroundTexture.draw(maskScreenPos.x, maskScreenPos.y + masterHeight + gutter);
 
         
         ofPushStyle();
@@ -1321,7 +1100,7 @@ void ofApp::draw(){
         
         ofSetLineWidth(2.0);
         ofSetColor(255, 0, 0);
-        contours.draw();
+        detection -> contours.draw();
 
         
         ofPopStyle();
@@ -1391,13 +1170,11 @@ void ofApp::draw(){
             ofTranslate(leftMargin, topMargin);
             ofScale(pipelineDisplayScale, pipelineDisplayScale);
 
-            ofImage img;
-            
             //----------slot 1----------
             ofSetColor(255);
             ofDrawBitmapString("Stitched & Processed", slot1.x, slot1.y - 5);
-            img.setFromPixels(masterPix.getData(), masterPix.getWidth(), masterPix.getHeight(), OF_IMAGE_GRAYSCALE);
-            img.draw(slot1);
+            compositeTexture.update(detection -> masterPix, detection -> generation);
+            compositeTexture.draw(slot1);
             
             ofNoFill();
             ofDrawRectangle(slot1, masterWidth, masterHeight);
@@ -1405,24 +1182,24 @@ void ofApp::draw(){
             //----------slot 2----------
             ofSetColor(255);
             ofDrawBitmapString("Subtracted Background", slot2.x, slot2.y - 5);
-            img.setFromPixels(backgroundPix.getData(), backgroundPix.getWidth(), backgroundPix.getHeight(), OF_IMAGE_GRAYSCALE);
-            img.draw(slot2);
+            backgroundTexture.update(detection -> backgroundPix, detection -> generation);
+            backgroundTexture.draw(slot2);
             
             ofNoFill();
             ofDrawRectangle(slot2, masterWidth, masterHeight);
             
             //----------slot 3----------
             ofDrawBitmapString("Foreground", slot3.x, slot3.y - 5);
-            img.setFromPixels(foregroundPix.getData(), foregroundPix.getWidth(), foregroundPix.getHeight(), OF_IMAGE_GRAYSCALE);
-            img.draw(slot3);
+            foregroundTexture.update(detection -> foregroundPix, detection -> generation);
+            foregroundTexture.draw(slot3);
             
             ofNoFill();
             ofDrawRectangle(slot3, masterWidth, masterHeight);
             
             //----------slot 4----------
             ofDrawBitmapString("Thresholded", slot4.x, slot4.y - 5);
-            img.setFromPixels(threshPix.getData(), threshPix.getWidth(), threshPix.getHeight(), OF_IMAGE_GRAYSCALE);
-            img.draw(slot4);
+            threshTexture.update(detection -> threshPix, detection -> generation);
+            threshTexture.draw(slot4);
             
             ofNoFill();
             ofDrawRectangle(slot4, masterWidth, masterHeight);
@@ -1432,6 +1209,30 @@ void ofApp::draw(){
             
         }ofPopMatrix();
         
+        //per-stage timing of the last processed frame
+        string stageInfo = "Stage          Wall ms   CPU ms    MPix/s\n";
+        
+        for(int i = 0; i < detection -> stageTimings.size(); i++){
+            
+            const StageTiming &t = detection -> stageTimings[i];
+            
+            string label = t.name + (t.bEnabled ? "" : " (off)");
+            label.resize(15, ' ');
+            stageInfo += label;
+            
+            if( t.bEnabled ){
+                stageInfo += ofToString(t.wallTime, 3, 10, ' ') + ofToString(t.cpuTime, 3, 10, ' ') + ofToString(t.throughput, 1, 10, ' ');
+            }
+            
+            stageInfo += "\n";
+        }
+        
+        stageInfo += "Total: " + ofToString(detection -> processingTime, 2) + " ms\n";
+        stageInfo += "Background model: " + detection -> backgroundModelName + ", " + ofToString(detection -> backgroundMemory/1024.0f, 1) + " KB";
+        
+        ofSetColor(255);
+        ofDrawBitmapString(stageInfo, leftMargin, topMargin + (slot3.y + masterHeight)*pipelineDisplayScale + 30);
+        
         //draw contours over thresholded image in slot 4
         if(drawContoursToggle){
             
@@ -1442,22 +1243,25 @@ void ofApp::draw(){
             //draw contours
             ofSetLineWidth(2.0);
             ofSetColor(255, 0, 0);
-            contours.draw();
+            detection -> contours.draw();
             
             
-            //go through and draw blob data too
-            for(int i = 0; i < contours.size(); i++) {
+            //go through and draw track data too
+            for(int i = 0; i < detection -> tracks.size(); i++) {
                 
-                int label = contours.getLabel(i);
-                ofPoint c = ofxCv::toOf(contours.getCenter(i));
+                const Track &t = detection -> tracks[i];
                 
+                //coasting tracks are drawn dimmer
                 ofFill();
-                ofSetColor(0, 180, 0);
-                ofDrawCircle(c.x, c.y, 5, 5);
+                ofSetColor(0, 180, 0, t.blobIndex == -1 ? 90 : 255);
+                ofDrawCircle(t.pos.x, t.pos.y, 5, 5);
+                
+                //where it'll be in a quarter second
+                ofDrawLine(t.pos, t.pos + t.vel * 0.25);
                 
                 if(showInfoToggle){
-                    string msg = ofToString(label) + " : " + ofToString(c.x) + ", " + ofToString(c.y);
-                    ofDrawBitmapStringHighlight(msg, c.x + 5, c.y + 10);
+                    string msg = ofToString(t.id) + " : " + ofToString(t.pos.x, 0) + ", " + ofToString(t.pos.y, 0);
+                    ofDrawBitmapStringHighlight(msg, t.pos.x + 5, t.pos.y + 10);
                 }
             }
             
@@ -1479,7 +1283,7 @@ void ofApp::draw(){
         
         
         //----------Primary Slot----------
-        ofDrawBitmapString("Contours and Detection zones (aggregate refresh rate: " + ofToString(aggregateFrameRate) + ")", detectionDisplayPos.x, detectionDisplayPos.y - 5);
+        ofDrawBitmapString("Contours and Detection zones (aggregate refresh rate: " + ofToString(aggregateFrameRate) + ", detection: " + ofToString(detection -> processingTime, 2) + " ms)", detectionDisplayPos.x, detectionDisplayPos.y - 5);
         
         ofPushMatrix();{
             
@@ -1496,22 +1300,25 @@ void ofApp::draw(){
                 //draw contours
                 ofSetLineWidth(2.0);
                 ofSetColor(255, 0, 0);
-                contours.draw();
+                detection -> contours.draw();
                 
                 
-                //go through and draw blob data too
-                for(int i = 0; i < contours.size(); i++) {
+                //go through and draw track data too
+                for(int i = 0; i < detection -> tracks.size(); i++) {
                     
-                    int label = contours.getLabel(i);
-                    ofPoint c = ofxCv::toOf(contours.getCenter(i));
+                    const Track &t = detection -> tracks[i];
                     
+                    //coasting tracks are drawn dimmer
                     ofFill();
-                    ofSetColor(0, 180, 0);
-                    ofDrawCircle(c.x, c.y, 5, 5);
+                    ofSetColor(0, 180, 0, t.blobIndex == -1 ? 90 : 255);
+                    ofDrawCircle(t.pos.x, t.pos.y, 5, 5);
+                    
+                    //where it'll be in a quarter second
+                    ofDrawLine(t.pos, t.pos + t.vel * 0.25);
                     
                     if(showInfoToggle){
-                        string msg = ofToString(label) + " : " + ofToString(c.x) + ", " + ofToString(c.y);
-                        ofDrawBitmapStringHighlight(msg, c.x + 5, c.y + 10);
+                        string msg = ofToString(t.id) + " : " + ofToString(t.pos.x, 0) + ", " + ofToString(t.pos.y, 0);
+                        ofDrawBitmapStringHighlight(msg, t.pos.x + 5, t.pos.y + 10);
                     }
                 }
                 
@@ -1580,17 +1387,28 @@ void ofApp::draw(){
         string blobInfo = "";
         blobInfo += "Blob Data:\n";
         blobInfo += "----------\n";
-        blobInfo += "Num Blobs: " + ofToString(contours.size()) + "\n";
+        blobInfo += "Num Blobs: " + ofToString(detection -> blobs.size()) + "\n";
         blobInfo += "Active Zone: " + ofToString(activeZone) + "\n";
         
-        for(int i = 0; i < contours.size(); i++){
-            blobInfo += "Blob[" + ofToString(i) + "] ID: " + ofToString(contours.getLabel(i)) + ", X: " + ofToString(contours.getCenter(i).x) + ", Y: " + ofToString(contours.getCenter(i).y) + "\n";
+        for(int i = 0; i < detection -> zoneOccupancy.size(); i++){
+            const ZoneOccupancy &o = detection -> zoneOccupancy[i];
+            blobInfo += "Zone " + ofToString(i) + " Occupied: " + ofToString(o.fraction * 100, 1) + "% (" + ofToString(o.occupied) + " px), Mean Intensity: " + ofToString(o.meanIntensity, 0) + "\n";
+        }
+        
+        if( usePredictionToggle ){
+            blobInfo += "Predicted Zone: " + ofToString(detection -> predictedZone) + ", Latency: " + ofToString(detection -> captureLatency, 0) + "ms\n";
+        }
+        
+        for(int i = 0; i < detection -> tracks.size(); i++){
+            const Track &t = detection -> tracks[i];
+            int cam = t.blobIndex >= 0 && t.blobIndex < detection -> blobs.size() ? detection -> blobs[t.blobIndex].camera : -1;
+            blobInfo += "Track ID: " + ofToString(t.id) + ", Cam: " + ofToString(cam) + ", X: " + ofToString(t.pos.x, 1) + ", Y: " + ofToString(t.pos.y, 1) + ", Speed: " + ofToString(t.vel.length(), 0) + ", Age: " + ofToString(t.age) + (t.bDwelling ? ", Dwell: " + ofToString(t.dwellTime, 1) + "s" : "") + "\n";
         }
         
         ofDrawBitmapString(blobInfo, detectionDisplayPos.x + 400, detectionDisplayPos.y + ( masterHeight * compositeDisplayScale) + 30);
         
         string sentString;
-        float t = ofMap(ofGetElapsedTimef() - lastStatusSendTime, 0, 0.1, 255, 100, true);
+        float t = ofMap(ofGetElapsedTimef() - statusReporter.getLastSendTime(), 0, 0.1, 255, 100, true);
         
         if( sendOSCToggle ){
             ofSetColor(0, 255, 0, t);
@@ -1677,6 +1495,7 @@ void ofApp::draw(){
         keyInfo += "Key Bindings\n";
         keyInfo += "------------\n";
         keyInfo += "'S' to Save 'L' to Load\n";
+        keyInfo += "'B' to run benchmarks\n";
         keyInfo += "Left/Right or [#] to\n";
         keyInfo += "switch between views:\n";
         keyInfo += "0 - \"Headless\" View\n";
@@ -1689,7 +1508,7 @@ void ofApp::draw(){
         keyInfo += "7 - Detection Zones\n";
         keyInfo += "8 - Camera Addressing\n";
         
-        ofDrawBitmapString(keyInfo, 10, ofGetHeight() - 195);
+        ofDrawBitmapString(keyInfo, 10, ofGetHeight() - 210);
     
         drawGui(10, 20);
     
@@ -1709,30 +1528,22 @@ void ofApp::drawMasterComposite(int x, int y, bool bDrawIDs, bool bUseColors, bo
     ofPushMatrix();{
     ofTranslate(x, y);
     
-//        ofImage img;
-        
         ofSetColor(255);
         ofSetLineWidth(1);
         
         //if we're drawing the raw image, use masterPix, if not, use the foregroundPix
         if( bDrawRaw ){
-            masterImgPlaceHolder.getPixels() = masterPix;
-            
-//            img.setFromPixels(masterPix.getData(), masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
+            compositeTexture.update(detection -> masterPix, detection -> generation);
+            compositeTexture.draw(0, 0);
         } else {
-
-            masterImgPlaceHolder.getPixels() = foregroundPix;
-//            img.setFromPixels(foregroundPix.getData(), masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
+            foregroundTexture.update(detection -> foregroundPix, detection -> generation);
+            foregroundTexture.draw(0, 0);
         }
         
-        masterImgPlaceHolder.update();
-        masterImgPlaceHolder.draw(0, 0);
-        
         
         if( drawThresholdToggle ){
-            masterImgPlaceHolder.getPixels() = threshPix;
-            masterImgPlaceHolder.update();
-            masterImgPlaceHolder.draw(0, 0);
+            threshTexture.update(detection -> threshPix, detection -> generation);
+            threshTexture.draw(0, 0);
         }
         
         
@@ -1838,6 +1649,11 @@ void ofApp::keyPressed(int key){
         bDrawGui = !bDrawGui;
     }
     
+    //blocks the app for a while, don't do this during a show
+    if( key == 'b' ){
+        Benchmark::runAll(masterWidth, masterHeight);
+    }
+    
     lastInputTime = ofGetElapsedTimef();
     
 }
@@ -1925,26 +1741,41 @@ void ofApp::dragEvent(ofDragInfo dragInfo){
 
 void ofApp::setupGui(){
     
+    //names, defaults and ranges of everything the pipeline
+    //uses, shared with HeadlessApp. The sliders below only
+    //show them
+    appSettings.setup(camWidth, camHeight);
+    
     guiName = "settings";
     
     gui.setup(guiName, guiName + ".xml", 0, 0);
     
     gui.add(imageAdjustLabel.setup("   IMAGE ADJUSTMENT", ""));
-    gui.add(blurAmountSlider.setup("Blur", 1, 0, 40));
-    gui.add(contrastExpSlider.setup("Contrast Exponent", 1.0, 1.0, 12.0));
-    gui.add(contrastPhaseSlider.setup("Contrast Phase", 0.0, 0.0, 0.8));
-    gui.add(thresholdSlider.setup("Threshold", 0, 0, 255));
-    gui.add(numErosionsSlider.setup("Number of erosions", 0, 0, 10));
-    gui.add(numDilationsSlider.setup("Number of dilations", 0, 0, 10));
+    gui.add(blurAmountSlider.setup(appSettings.blurAmt));
+    gui.add(contrastExpSlider.setup(appSettings.contrastExp));
+    gui.add(contrastPhaseSlider.setup(appSettings.contrastPhase));
+    gui.add(thresholdSlider.setup(appSettings.threshold));
+    gui.add(numErosionsSlider.setup(appSettings.numErosions));
+    gui.add(numDilationsSlider.setup(appSettings.numDilations));
     
     gui.add(bgDiffLabel.setup("   BG SUBTRACTION", ""));
-    gui.add(useBgDiff.setup("Use BG Diff", false));
-    gui.add(learningTime.setup("Frames to learn BG", 100, 0, 80));
+    gui.add(useBgDiff.setup(appSettings.useBgDiff));
+    gui.add(useMultiModalBg.setup(appSettings.useMultiModalBg));
+    gui.add(usePerCameraBg.setup(appSettings.usePerCameraBg));
+    gui.add(learningTime.setup(appSettings.learningTime));
+    gui.add(selectiveLearning.setup(appSettings.selectiveLearning));
     gui.add(resetBGButton.setup("Reset Background"));
+    gui.add(bgSaveInterval.setup(appSettings.bgSaveInterval));
+    
+    gui.add(parallelLabel.setup("   PARALLEL PROCESSING", ""));
+    gui.add(useParallelBands.setup(appSettings.useParallelBands));
+    gui.add(numBandsSlider.setup(appSettings.numBands));
     
     gui.add(contoursLabel.setup("   CONTOUR FINDING", ""));
-    gui.add(minBlobAreaSlider.setup("Min Blob Area", 0, 0, 1000));
-    gui.add(maxBlobAreaSlider.setup("Max Blob Area", 1000, 0, 20000));
+    gui.add(minBlobAreaSlider.setup(appSettings.minBlobArea));
+    gui.add(maxBlobAreaSlider.setup(appSettings.maxBlobArea));
+    gui.add(persistenceSlider.setup(appSettings.persistence));
+    gui.add(maxDistanceSlider.setup(appSettings.maxDistance));
     gui.add(drawContoursToggle.setup("Draw Contours", true));
     gui.add(drawThresholdToggle.setup("Draw Threshold", true));
     gui.add(drawZonesToggle.setup("Draw Zones", true));
@@ -1952,17 +1783,26 @@ void ofApp::setupGui(){
     
     
     
-    //make much bigger to accomodate
-    //for different stitching layouts
-    ofVec2f start(0, 0);
-    ofVec2f end(camWidth*4, camHeight*4);
-    
     gui.add(OSCLabel.setup("   OSC SETTINGS", ""));
-    gui.add(sendOSCToggle.setup("Send OSC Data", false));
-    gui.add(waitBeforeOSCSlider.setup("Wait after startup", 7.0, 5.0, 30));
-    gui.add(sysNotOKSlider.setup("Time for NOT OK Flag", 4.0, 1.0, 20));
-    gui.add(maxOSCSendRate.setup("Zones interval (s)", 0.5f, 0.0f, 2.0f));
-    gui.add(statusSendRate.setup("Status interval (s)", 0.5f, 0.0f, 2.0f));
+    gui.add(sendOSCToggle.setup(appSettings.sendOSC));
+    gui.add(waitBeforeOSCSlider.setup(appSettings.waitBeforeOSC));
+    gui.add(sysNotOKSlider.setup(appSettings.sysNotOKTime));
+    gui.add(maxOSCSendRate.setup(appSettings.maxOSCSendRate));
+    gui.add(statusSendRate.setup(appSettings.statusSendRate));
+    gui.add(usePredictionToggle.setup(appSettings.usePrediction));
+    gui.add(predictionHorizonSlider.setup(appSettings.predictionHorizon));
+    gui.add(deltaOSCToggle.setup(appSettings.deltaOSC));
+    gui.add(heartbeatIntervalSlider.setup(appSettings.heartbeatInterval));
+    gui.add(updateDistanceSlider.setup(appSettings.updateDistance));
+    gui.add(occupancyStepSlider.setup(appSettings.occupancyStep));
+    gui.add(useTimeTagsToggle.setup(appSettings.useTimeTags));
+    gui.add(sendBlobsToggle.setup(appSettings.sendBlobs));
+    gui.add(publishSharedToggle.setup(appSettings.publishShared));
+    gui.add(streamPreviewToggle.setup(appSettings.streamPreview));
+    gui.add(previewScaleSlider.setup(appSettings.previewScale));
+    gui.add(previewFpsSlider.setup(appSettings.previewFps));
+    gui.add(previewBudgetSlider.setup(appSettings.previewBudget));
+    gui.add(floorScaleSlider.setup(appSettings.floorScale));
     
     gui.add(addressingLabel.setup("   CAM ADDRESSING", ""));
     gui.add(resetCamAddresses.setup("Reset Address", false));
@@ -1979,18 +1819,18 @@ void ofApp::setupGui(){
     
     
     zoneGui.add(zonePointsLabel.setup("   DETECTION ZONE POINTS", ""));
-    zoneGui.add( dangerPt0.setup("Danger Z. Pt 0", start, start, end));
-    zoneGui.add( dangerPt1.setup("Danger Z. Pt 1", start, start, end));
-    zoneGui.add( dangerPt2.setup("Danger Z. Pt 2", start, start, end));
-    zoneGui.add( dangerPt3.setup("Danger Z. Pt 3", start, start, end));
-    zoneGui.add(active1Pt0.setup("Active Z-1 Pt 0", start, start, end));
-    zoneGui.add(active1Pt1.setup("Active Z-1 Pt 1", start, start, end));
-    zoneGui.add(active1Pt2.setup("Active Z-1 Pt 2", start, start, end));
-    zoneGui.add(active1Pt3.setup("Active Z-1 Pt 3", start, start, end));
-    zoneGui.add(active2Pt0.setup("Active Z-2 Pt 0", start, start, end));
-    zoneGui.add(active2Pt1.setup("Active Z-2 Pt 1", start, start, end));
-    zoneGui.add(active2Pt2.setup("Active Z-2 Pt 2", start, start, end));
-    zoneGui.add(active2Pt3.setup("Active Z-2 Pt 3", start, start, end));
+    zoneGui.add( dangerPt0.setup(appSettings.zonePoints[0][0]));
+    zoneGui.add( dangerPt1.setup(appSettings.zonePoints[0][1]));
+    zoneGui.add( dangerPt2.setup(appSettings.zonePoints[0][2]));
+    zoneGui.add( dangerPt3.setup(appSettings.zonePoints[0][3]));
+    zoneGui.add(active1Pt0.setup(appSettings.zonePoints[1][0]));
+    zoneGui.add(active1Pt1.setup(appSettings.zonePoints[1][1]));
+    zoneGui.add(active1Pt2.setup(appSettings.zonePoints[1][2]));
+    zoneGui.add(active1Pt3.setup(appSettings.zonePoints[1][3]));
+    zoneGui.add(active2Pt0.setup(appSettings.zonePoints[2][0]));
+    zoneGui.add(active2Pt1.setup(appSettings.zonePoints[2][1]));
+    zoneGui.add(active2Pt2.setup(appSettings.zonePoints[2][2]));
+    zoneGui.add(active2Pt3.setup(appSettings.zonePoints[2][3]));
 //    zoneGui.add(active3Pt0.setup("Active Z-3 Pt 0", start, start, end));
 //    zoneGui.add(active3Pt1.setup("Active Z-3 Pt 1", start, start, end));
 //    zoneGui.add(active3Pt2.setup("Active Z-3 Pt 2", start, start, end));
@@ -2010,13 +1850,10 @@ void ofApp::setupGui(){
     stitchingGui.add(stitchingLabel.setup("   CAMERA STITCHING", ""));
     
     
-    start.set(0, 0);
-    end.set(camWidth*3, camHeight * 1.5);
-
     for(int i = 0; i < TOTAL_NUM_CAMS; i++){
-        stitchingGui.add(camPositions[i].setup("Cam " +ofToString(i)+ " Position", ofVec2f(0, 0), start, end));
-        stitchingGui.add(camRotations[i].setup("Cam " +ofToString(i)+ " Rotation", 0, 0, 3));
-        stitchingGui.add(camMirrorToggles[i].setup("Cam " +ofToString(i)+ " Mirror", false));
+        stitchingGui.add(camPositions[i].setup(appSettings.camPositions[i]));
+        stitchingGui.add(camRotations[i].setup(appSettings.camRotations[i]));
+        stitchingGui.add(camMirrorToggles[i].setup(appSettings.camMirrors[i]));
     }
 
     stitchingGui.minimizeAll();
@@ -2027,7 +1864,7 @@ void ofApp::setupGui(){
     maskingGui.setup(maskGuiName, maskGuiName + ".xml", 0, 0);
     maskingGui.add( maskGuiPos.setup("Gui Pos", ofVec2f(200, 50), ofVec2f(0, 0), ofVec2f(ofGetWidth(), ofGetHeight())));
 
-    maskingGui.add(useMask.setup("Use Mask", true));
+    maskingGui.add(useMask.setup(appSettings.useMask));
     maskingGui.add(drawOrErase.setup("Draw or Erase", true));
     maskingGui.add(clearMask.setup("Clear Mask"));
     maskingGui.add(saveMask.setup("Save Mask"));
@@ -2044,11 +1881,11 @@ void ofApp::setupGui(){
     //pixel stats gi
     pixelStatsGuiName = "pixelStatsGui";
     pixelStatsGui.setup(pixelStatsGuiName, pixelStatsGuiName + ".xml", 0, 0);
-    pixelStatsGui.add(stdDevBlackOutToggle.setup("Use Std Dev Blackout", false));
-    pixelStatsGui.add(avgPixelThreshSlider.setup("Avg Pixel Thresh", 100, 0, 255));
+    pixelStatsGui.add(stdDevBlackOutToggle.setup(appSettings.stdDevToggle));
+    pixelStatsGui.add(avgPixelThreshSlider.setup(appSettings.avgPixThresh));
     
     for(int i = 0; i < TOTAL_NUM_CAMS; i++){
-        pixelStatsGui.add(stdDevThreshSliders[i].setup("Cam " + ofToString(i) + " Thresh", 300, 0, 1000));
+        pixelStatsGui.add(stdDevThreshSliders[i].setup(appSettings.stdDevThresh[i]));
     }
     
 
@@ -2072,6 +1909,7 @@ void ofApp::setupGui(){
     
     imageAdjustLabel.setBackgroundColor(ofColor(255));
     bgDiffLabel.setBackgroundColor(ofColor(255));
+    parallelLabel.setBackgroundColor(ofColor(255));
     contoursLabel.setBackgroundColor(ofColor(255));
     OSCLabel.setBackgroundColor(ofColor(255));
     addressingLabel.setBackgroundColor(ofColor(255));
@@ -2121,6 +1959,7 @@ void ofApp::loadSettings(){
         
         cout << "Mask loaded" << endl;
         maskPix = maskImg.getPixels();
+        maskPix.setImageType(OF_IMAGE_GRAYSCALE);
         
     } else {
         
@@ -2134,6 +1973,9 @@ void ofApp::loadSettings(){
         maskImg.save(maskFileName);
         
     }
+    
+    bMaskChanged = true;
+    maskGeneration = nextImageGeneration();
 
     
     addressFilename = "camAddresses.txt";
@@ -2161,6 +2003,64 @@ void ofApp::loadSettings(){
     }
     
     
+    //order of the detection pipeline stages. Write
+    //out the default if there isn't one yet
+    ofBuffer pipelineBuffer = ofBufferFromFile("pipeline.txt");
+    
+    stageOrder.clear();
+    
+    if(pipelineBuffer.size()) {
+        
+        for (ofBuffer::Line it = pipelineBuffer.getLines().begin(), end = pipelineBuffer.getLines().end(); it != end; ++it) {
+            
+            string line = ofTrim(*it);
+            
+            if( !line.empty() ){
+                stageOrder.push_back(line);
+            }
+            
+        }
+        
+    }
+    
+    if( stageOrder.empty() ){
+        
+        stageOrder = StageGraph::getDefaultOrder();
+        
+        ofBuffer defaultBuffer;
+        for(int i = 0; i < stageOrder.size(); i++){
+            defaultBuffer.append(stageOrder[i] + "\n");
+        }
+        ofBufferToFile("pipeline.txt", defaultBuffer);
+        
+    }
+    
+    
+}
+
+void ofApp::fitMaskToComposite(){
+    
+    if( maskPix.getWidth() == masterWidth && maskPix.getHeight() == masterHeight ) return;
+    
+    cout << "Re-allocating mask to match composite dimensions" << endl;
+    cout << "Old mask dims: " << maskPix.getWidth() << ", " << maskPix.getHeight() << endl;
+    
+    //if there's a difference, make a copy with the proper dims,
+    //paste the mask into it then save it into the mask
+    ofPixels newMask;
+    newMask.allocate(masterWidth, masterHeight, OF_IMAGE_GRAYSCALE);
+    newMask.setColor(0);
+    
+    //pasteInto() will not work if destination is smaller than pix being pasted
+    //Method should crop on its own, but it doesn't so we'll do it manually
+    if( !maskPix.pasteInto(newMask, 0, 0) ){
+        maskPix.cropTo(newMask, 0, 0, newMask.getWidth(), newMask.getHeight());
+    }
+    
+    maskPix = newMask;
+    bMaskChanged = true;
+    maskGeneration = nextImageGeneration();
+    
 }
 
 void ofApp::saveSettings(){
@@ -10,13 +10,19 @@
 #include "PixelStatistics.hpp"
 #include "Feed.hpp"
 #include "Aggregator.hpp"
+#include "OscSender.hpp"
+#include "BinaryMask.hpp"
+#include "AppSettings.hpp"
+#include "FrameAssembler.hpp"
+#include "StatusReporter.hpp"
+#include "Benchmark.hpp"
+#include "CpuMeter.hpp"
+#include "CachedTexture.hpp"
+#include "Profiler.hpp"
 
 #include "Addressing/AddressPanel.hpp"
 
 
-#define TOTAL_NUM_CAMS 7
-
-
 class ofApp : public ofBaseApp{
 
 	public:
@@ -57,6 +63,7 @@ class ofApp : public ofBaseApp{
 
     vector<Feed> feeds;
     Aggregator aggregator;
+    FrameAssembler frameAssembler;
     
     
     
@@ -117,19 +124,25 @@ class ofApp : public ofBaseApp{
     //-----pixel objects-----
     void drawMasterComposite(int x, int y, bool bDrawIDs = true, bool bUseColors = true, bool bDrawRaw = true);
     
-    //raw pix are blended into
-    ofPixels masterPix;
     int masterWidth, masterHeight;
     int oldMasterWidth, oldMasterHeight;
     
-    //then master pix is fed into the
-    //following objects
-    ofPixels processedPix;
-    ofPixels threshPix;
-    ofPixels backgroundPix;
-    ofPixels foregroundPix;
+    //latest snapshot from the aggregator thread
+    //(composite, pipeline images and contours).
+    //Only ever read from here, never modified
+    shared_ptr<const Aggregator::Result> detection;
 
-    ofImage masterImgPlaceHolder;
+    //stage names from pipeline.txt, one per line.
+    //A leading '-' switches the stage off
+    vector<string> stageOrder;
+
+    //one per image of the snapshot, shared by every view
+    //that draws it. Only uploaded when a new snapshot
+    //(generation) has come in since the last draw
+    CachedTexture compositeTexture;
+    CachedTexture backgroundTexture;
+    CachedTexture foregroundTexture;
+    CachedTexture threshTexture;
     
     //a totally black frame for convenience
     ofPixels blackFrame;
@@ -138,11 +151,6 @@ class ofApp : public ofBaseApp{
     void adjustContrast(ofPixels *pix, float exp, float phase);
     
     
-    ofxCv::ContourFinder contours;
-    ofxCv::RunningBackground background;
-    int backgroundWidth, backgroundHeight;
-    bool bNeedBGReset;
-    
     deque<string> consoleString;
     int maxNumConsoleStrings;
     
@@ -155,11 +163,19 @@ class ofApp : public ofBaseApp{
     
     
     //-----OSC SETUP-----
-    ofxOscSender osc;
+    shared_ptr<OscSender> oscSender;
     string oscIP;
     int oscPort;
     
-    double lastZoneSendTime, lastStatusSendTime;
+    //decides appStatus and sends /status
+    StatusReporter statusReporter;
+    
+    
+    //-----Preview stream-----
+    //IP/port from preview.txt
+    shared_ptr<PreviewStreamer> previewStreamer;
+    string previewIP;
+    int previewPort;
     
     
     //-----Detection zones-----
@@ -179,6 +195,15 @@ class ofApp : public ofBaseApp{
     float aggregateFrameRate, lastFrameRate;
     float lastFrameTime;
     
+    //whole process, logged so it can be compared
+    //against the headless runtime (see HeadlessApp)
+    CpuMeter cpuMeter;
+    
+#if PROFILER_ENABLED
+    //per stage percentiles for INFO, profile.csv/json
+    Profiler profiler;
+#endif
+    
     
     //-----GUI SETUP-----
     bool bDrawGui;
@@ -191,6 +216,9 @@ class ofApp : public ofBaseApp{
     
     void applyGuiValsToZones();
     
+    //what the sliders below are set up on
+    AppSettings appSettings;
+    
     ofxPanel gui;
     string guiName;
     
@@ -205,10 +233,18 @@ class ofApp : public ofBaseApp{
     
     ofxLabel bgDiffLabel;
     ofxIntSlider learningTime;
+    ofxToggle selectiveLearning;
+    ofxToggle useMultiModalBg;
+    ofxToggle usePerCameraBg;
     ofxButton resetBGButton;
+    ofxFloatSlider bgSaveInterval;
     ofxToggle useBgDiff;
     ofxToggle useThreshold;
     
+    ofxLabel parallelLabel;
+    ofxToggle useParallelBands;
+    ofxIntSlider numBandsSlider;
+    
     ofxLabel contoursLabel;
     ofxIntSlider minBlobAreaSlider;
     ofxIntSlider maxBlobAreaSlider;
@@ -225,6 +261,20 @@ class ofApp : public ofBaseApp{
     ofxFloatSlider sysNotOKSlider;
     ofxFloatSlider maxOSCSendRate;
     ofxFloatSlider statusSendRate;
+    ofxToggle usePredictionToggle;
+    ofxFloatSlider predictionHorizonSlider;
+    ofxToggle deltaOSCToggle;
+    ofxFloatSlider heartbeatIntervalSlider;
+    ofxFloatSlider updateDistanceSlider;
+    ofxFloatSlider occupancyStepSlider;
+    ofxToggle useTimeTagsToggle;
+    ofxToggle sendBlobsToggle;
+    ofxToggle publishSharedToggle;
+    ofxToggle streamPreviewToggle;
+    ofxIntSlider previewScaleSlider;
+    ofxFloatSlider previewFpsSlider;
+    ofxFloatSlider previewBudgetSlider;
+    ofxFloatSlider floorScaleSlider;
     
     ofxLabel addressingLabel;
     ofxButton resetCamAddresses;
@@ -244,7 +294,24 @@ class ofApp : public ofBaseApp{
     string maskFileName;
     ofColor maskCol;
     ofPixels maskPix;
-    ofImage maskImg;
+    ofImage maskImg;        //file io only, never drawn
+    
+    //bumped on every edit of maskPix
+    uint64_t maskGeneration;
+    CachedTexture maskTexture;
+    
+    //bit-packed copy of maskPix that actually gets
+    //applied to the composite. Re-packed only when edited,
+    //the aggregator fits it to layout changes by itself
+    shared_ptr<const BinaryMask> binaryMask;
+    
+    //crop/pad maskPix to the composite, before painting it
+    void fitMaskToComposite();
+    
+    bool bMaskChanged;
+    
+    //mouse is down in the mask, hold off re-packing until it's up
+    bool bPaintingMask;
     
     ofVec2f maskScreenPos;
     ofVec2f maskMousePos;
@@ -0,0 +1,36 @@
+/*
+ * ofxThermalClient.cpp
+ *
+ * The cameras only have a driver on the Mac (ofxThermalClient.mm).
+ * Everywhere else the client finds no cameras so the rest of
+ * the app still builds, see HeadlessApp for running without them.
+ */
+
+#include "ofxThermalClient.h"
+
+#ifndef TARGET_OSX
+
+ofxThermalClient::ofxThermalClient()
+{
+    camDelegate = NULL;
+}
+
+void ofxThermalClient::setup()
+{
+    cout << "[ofxThermalClient] No thermal camera driver on this platform" << endl;
+}
+
+void ofxThermalClient::checkForNewFrame()
+{
+    
+}
+
+unsigned char* ofxThermalClient::getPixels(){
+    return NULL;
+}
+
+int ofxThermalClient::getDeviceLocation(){
+    return 0;
+}
+
+#endif
@@ -4,6 +4,8 @@
 
 #include "ofMain.h"
 
+#pragma once
+
 class ofxThermalClient {
 	public:
     
@@ -21,6 +23,9 @@ class ofxThermalClient {
     struct NewFrameData{
         ofPixels pix;
         int ID;
+        
+        //when the camera delivered it, ofGetElapsedTimeMicros() clock
+        uint64_t captureTime;
     };
     
     ofEvent<NewFrameData> newFrameEvt;
@@ -30,6 +30,13 @@ void ofxThermalClient::checkForNewFrame()
         nf.ID = getDeviceLocation();
         nf.pix.setFromPixels(getPixels(), 206, 156, OF_PIXELS_RGBA);
         
+        //how long the frame sat in the delegate, moved onto OF's clock
+        double age = [[NSProcessInfo processInfo] systemUptime] - ((ofxThermalDelegate*) camDelegate).frameTime;
+        uint64_t ageMicros = (uint64_t)( std::max(0.0, age) * 1000000 );
+        uint64_t now = ofGetElapsedTimeMicros();
+        
+        nf.captureTime = now > ageMicros ? now - ageMicros : 0;
+        
         ofNotifyEvent(newFrameEvt, nf, this);
         
         ((ofxThermalDelegate*) camDelegate).hasNewFrame = false;
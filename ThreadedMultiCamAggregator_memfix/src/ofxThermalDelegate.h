@@ -14,6 +14,7 @@
     NSBitmapImageRep	*rep;
     BOOL _hasNewFrame;
     int _deviceLocation;
+    double _frameTime;
 }
 
 -(void) setup;
@@ -22,5 +23,8 @@
 @property (readwrite) BOOL hasNewFrame;
 @property (readwrite) int deviceLocation;
 
+//system uptime (seconds) when the latest frame arrived
+@property (readwrite) double frameTime;
+
 
 @end
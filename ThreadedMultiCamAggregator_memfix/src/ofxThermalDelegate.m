@@ -8,6 +8,7 @@
 @synthesize frameData=_frameData;
 @synthesize hasNewFrame=_hasNewFrame;
 @synthesize deviceLocation=_deviceLocation;
+@synthesize frameTime=_frameTime;
 
 -(void) setup {
     device = nil;
@@ -85,6 +86,8 @@
 
 - (void) thermalCamera:(id)deviceWData hasNewFrameAvailable:(SeekThermalFrame *)newFrame	{
     
+    _frameTime = [[NSProcessInfo processInfo] systemUptime];
+    
     _deviceLocation = ((SeekThermalDevice*)deviceWData).deviceLocation;
 //    NSLog(@"frame from camera: %i",_deviceLocation);
     